@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions to count heap allocations and
+// track the bytes currently allocated. Replacements cannot be inline, so
+// include this from exactly one source file of a benchmark.
+
+static std::atomic<size_t> allocations{0};
+static std::atomic<size_t> liveBytes{0};
+
+void* operator new(size_t size)
+{
+    // The size is kept in front of the block so that delete can subtract it
+    void* block = std::malloc(size + sizeof(std::max_align_t));
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    *static_cast<size_t*>(block) = size;
+    allocations++;
+    liveBytes += size;
+    return static_cast<char*>(block) + sizeof(std::max_align_t);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+    {
+        void* block = static_cast<char*>(pointer) - sizeof(std::max_align_t);
+        liveBytes -= *static_cast<size_t*>(block);
+        std::free(block);
+    }
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
@@ -0,0 +1,123 @@
+#include "DeviceIndex.hpp"
+#include "DeviceRegistry.hpp"
+#include "LightController.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const LightBrightness levels[] = {LightBrightness::LOW, LightBrightness::MEDIUM, LightBrightness::HIGH, LightBrightness::FULL};
+
+template <typename Command>
+double commandsPerSecond(const std::vector<int>& ids, Command command)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        command(ids[i], levels[i & 3]);
+    }
+    return ids.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runSize(size_t devices)
+{
+    DeviceTable lights(devices);
+    DeviceIndex index(devices);
+    auto now = std::chrono::steady_clock::now();
+
+    // Sparse, shuffled room IDs as a topology file would produce
+    std::mt19937 gen(42);
+    std::vector<int> roomIds(devices);
+    for (size_t i = 0; i < devices; i++)
+    {
+        roomIds[i] = static_cast<int>(i * 7 + 1000);
+    }
+    std::shuffle(roomIds.begin(), roomIds.end(), gen);
+
+    for (int roomId : roomIds)
+    {
+        index.insert(DeviceType::LIGHT, roomId, lights.add(roomId, 0, now));
+    }
+
+    size_t commands = devices <= 1000 ? 2'000'000 : 200'000;
+    std::uniform_int_distribution<size_t> pick(0, devices - 1);
+    std::vector<int> targets(commands);
+    for (auto& target : targets)
+    {
+        target = roomIds[pick(gen)];
+    }
+
+    // Former command path: scan the rooms comparing IDs
+    double scanned = commandsPerSecond(devices <= 1000 ? targets : std::vector<int>(targets.begin(), targets.begin() + 2000),
+                                       [&](int roomId, LightBrightness level)
+    {
+        std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+        for (DeviceHandle light = 0; light < lights.size(); light++)
+        {
+            if (lights.getDeviceId(light) == roomId)
+            {
+                LightController::setBrightnessLocked(lights, light, level, now);
+                return;
+            }
+        }
+    });
+
+    double indexed = commandsPerSecond(targets, [&](int roomId, LightBrightness level)
+    {
+        std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+        DeviceHandle light = index.find(DeviceType::LIGHT, roomId);
+        if (light != INVALID_DEVICE_HANDLE)
+        {
+            LightController::setBrightnessLocked(lights, light, level, now);
+        }
+    });
+
+    // Lookups stay correct across removal: swap-remove half the rooms
+    for (size_t i = 0; i < devices / 2; i++)
+    {
+        DeviceHandle handle = index.find(DeviceType::LIGHT, roomIds[i]);
+        DeviceHandle last = static_cast<DeviceHandle>(lights.size() - 1);
+        int movedId = lights.getDeviceId(last);
+        lights.removeAt(handle);
+        index.erase(DeviceType::LIGHT, roomIds[i]);
+        if (handle != last)
+        {
+            index.update(DeviceType::LIGHT, movedId, handle);
+        }
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < devices; i++)
+    {
+        DeviceHandle handle = index.find(DeviceType::LIGHT, roomIds[i]);
+        bool removed = i < devices / 2;
+        if (removed ? handle != INVALID_DEVICE_HANDLE
+                    : (handle == INVALID_DEVICE_HANDLE || lights.getDeviceId(handle) != roomIds[i]))
+        {
+            mismatches++;
+        }
+    }
+
+    std::printf("%7zu devices | linear scan %12.0f cmd/s | index %12.0f cmd/s | %8.1fx | lookup errors after removal: %zu\n",
+                devices, scanned, indexed, indexed / scanned, mismatches);
+}
+
+}
+
+int main()
+{
+    Logger::setLevel(LogCategory::LIGHTS, LogLevel::OFF);
+
+    for (size_t devices : {10, 1'000, 100'000})
+    {
+        runSize(devices);
+    }
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "DeviceRegistry.hpp"
+#include "LightController.hpp"
+#include "Logger.hpp"
+#include "AllocationCounter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Replica of the controller layout before the registry: one heap object per
+// device with a name string, a mutex and virtual Sensor dispatch, owned by a
+// vector of unique_ptr plus a global vector of raw pointers.
+class LegacySensor
+{
+protected:
+    std::string name;
+    float currentValue;
+    std::mutex valueMutex;
+
+public:
+    explicit LegacySensor(const std::string& sensorName) : name(sensorName), currentValue(0.0f) {}
+    virtual ~LegacySensor() = default;
+    virtual float readValue() = 0;
+};
+
+class LegacyLight : public LegacySensor
+{
+private:
+    LightState state{LightState::OFF};
+    LightBrightness brightness{LightBrightness::OFF};
+    int roomId;
+
+public:
+    static std::vector<LegacyLight*> allLights;
+
+    LegacyLight(const std::string& controllerName, int id) : LegacySensor(controllerName), roomId(id)
+    {
+        allLights.push_back(this);
+    }
+
+    float readValue() override
+    {
+        std::lock_guard<std::mutex> lock(valueMutex);
+        return static_cast<float>(static_cast<int>(brightness));
+    }
+
+    bool turnOn()
+    {
+        std::lock_guard<std::mutex> lock(valueMutex);
+        if (state == LightState::OFF)
+        {
+            state = LightState::ON;
+            brightness = LightBrightness::MEDIUM;
+            return true;
+        }
+        return false;
+    }
+
+    bool turnOff()
+    {
+        std::lock_guard<std::mutex> lock(valueMutex);
+        if (state == LightState::ON)
+        {
+            state = LightState::OFF;
+            brightness = LightBrightness::OFF;
+            return true;
+        }
+        return false;
+    }
+
+    LightState getState() const { return state; }
+    int getRoomId() const { return roomId; }
+};
+
+std::vector<LegacyLight*> LegacyLight::allLights;
+
+std::string lightName(size_t index)
+{
+    return "Room " + std::to_string(index) + " Ceiling Light";
+}
+
+std::vector<float> makeMotion(size_t devices, uint32_t seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dis(0.0f, 100.0f);
+    std::vector<float> motion(devices);
+    for (auto& value : motion)
+    {
+        value = dis(gen);
+    }
+    return motion;
+}
+
+template <typename Pass>
+double timePasses(int passes, Pass pass)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < passes; i++)
+    {
+        pass(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / passes;
+}
+
+void runSize(size_t devices)
+{
+    const int passes = 50;
+    std::vector<std::vector<float>> motion;
+    for (int i = 0; i < 4; i++)
+    {
+        motion.push_back(makeMotion(devices, static_cast<uint32_t>(i + 1)));
+    }
+
+    size_t before = liveBytes;
+    std::vector<std::unique_ptr<LegacyLight>> legacy;
+    for (size_t i = 0; i < devices; i++)
+    {
+        legacy.push_back(std::make_unique<LegacyLight>(lightName(i), static_cast<int>(i)));
+    }
+    size_t legacyBytes = liveBytes - before;
+
+    // Motion rule from LightControlTask with precomputed motion samples
+    double legacyPass = timePasses(passes, [&](int pass)
+    {
+        const std::vector<float>& sample = motion[pass % motion.size()];
+        for (auto& light : legacy)
+        {
+            float value = sample[static_cast<size_t>(light -> getRoomId())];
+            if (value > 75.0f && light -> getState() == LightState::OFF)
+            {
+                light -> turnOn();
+            }
+            else if (value < 10.0f && light -> getState() == LightState::ON)
+            {
+                light -> turnOff();
+            }
+        }
+    });
+
+    legacy.clear();
+    LegacyLight::allLights.clear();
+    LegacyLight::allLights.shrink_to_fit();
+
+    before = liveBytes;
+    auto table = std::make_unique<DeviceTable>(devices);
+    auto names = std::make_unique<NameTable>();
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < devices; i++)
+    {
+        table -> add(static_cast<int>(i), names -> intern(lightName(i)), now);
+    }
+    size_t registryBytes = liveBytes - before;
+
+    double registryPass = timePasses(passes, [&](int pass)
+    {
+        const std::vector<float>& sample = motion[pass % motion.size()];
+        auto passTime = std::chrono::steady_clock::now();
+        std::shared_lock<std::shared_mutex> lock(table -> getMutex());
+        const int32_t* roomIds = table -> deviceIdData();
+        DeviceHandle count = static_cast<DeviceHandle>(table -> size());
+
+        for (DeviceHandle light = 0; light < count; light++)
+        {
+            float value = sample[static_cast<size_t>(roomIds[light])];
+            if (value > 75.0f && table -> getState(light) == static_cast<uint8_t>(LightState::OFF))
+            {
+                LightController::turnOnLocked(*table, light, passTime);
+            }
+            else if (value < 10.0f && table -> getState(light) == static_cast<uint8_t>(LightState::ON))
+            {
+                LightController::turnOffLocked(*table, light, passTime);
+            }
+        }
+    });
+
+    std::printf("%7zu devices | legacy %6.1f B/device, %10.0f ns/pass | registry %6.1f B/device (%zu B state), %10.0f ns/pass | %.1fx\n",
+                devices, static_cast<double>(legacyBytes) / devices, legacyPass,
+                static_cast<double>(registryBytes) / devices, DeviceTable::bytesPerDevice(), registryPass,
+                legacyPass / registryPass);
+}
+
+}
+
+int main()
+{
+    // Rule transitions log at INFO; keep the logger out of the measurement
+    Logger::setLevel(LogCategory::LIGHTS, LogLevel::OFF);
+
+    for (size_t devices : {10'000, 100'000})
+    {
+        runSize(devices);
+    }
+
+    return 0;
+}
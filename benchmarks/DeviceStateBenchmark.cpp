@@ -0,0 +1,161 @@
+#include "DeviceRegistry.hpp"
+#include "LightController.hpp"
+#include "Logger.hpp"
+#include "RandomService.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t DEVICES = 1024;
+
+// Replica of the former layout: plain state and level columns, every
+// writer and (to stay race-free) every reader behind one mutex
+struct MutexTable
+{
+    std::vector<uint8_t> states = std::vector<uint8_t>(DEVICES);
+    std::vector<uint8_t> levels = std::vector<uint8_t>(DEVICES);
+    std::mutex valueMutex;
+
+    void toggle(size_t light)
+    {
+        std::lock_guard<std::mutex> lock(valueMutex);
+        bool on = states[light] == static_cast<uint8_t>(LightState::ON);
+        states[light] = static_cast<uint8_t>(on ? LightState::OFF : LightState::ON);
+        levels[light] = static_cast<uint8_t>(on ? LightBrightness::OFF : LightBrightness::MEDIUM);
+    }
+
+    bool readConsistent(size_t light)
+    {
+        std::lock_guard<std::mutex> lock(valueMutex);
+        return (states[light] == static_cast<uint8_t>(LightState::ON)) == (levels[light] != 0);
+    }
+};
+
+struct AtomicTable
+{
+    DeviceTable table{DEVICES};
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    AtomicTable()
+    {
+        for (size_t i = 0; i < DEVICES; i++)
+        {
+            table.add(static_cast<int>(i), 0, now);
+        }
+    }
+
+    void toggle(size_t light)
+    {
+        DeviceHandle handle = static_cast<DeviceHandle>(light);
+        if (!LightController::turnOnLocked(table, handle, now))
+        {
+            LightController::turnOffLocked(table, handle, now);
+        }
+    }
+
+    bool readConsistent(size_t light)
+    {
+        DeviceState snapshot = table.load(static_cast<DeviceHandle>(light));
+        return (snapshot.state == static_cast<uint8_t>(LightState::ON)) == (snapshot.level != 0);
+    }
+};
+
+struct StressResult
+{
+    double readsPerSecond;
+    double writesPerSecond;
+    uint64_t inconsistent;
+};
+
+template <typename Table>
+StressResult stress(Table& table, int readers, int writers, std::chrono::milliseconds duration)
+{
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> writes{0};
+    std::atomic<uint64_t> inconsistent{0};
+    std::vector<std::thread> threads;
+
+    for (int r = 0; r < readers; r++)
+    {
+        threads.emplace_back([&]()
+        {
+            uint64_t localReads = 0;
+            uint64_t localInconsistent = 0;
+            // Status-report style: sweep every device, repeatedly
+            while (running.load(std::memory_order_relaxed))
+            {
+                for (size_t light = 0; light < DEVICES; light++)
+                {
+                    localInconsistent += table.readConsistent(light) ? 0 : 1;
+                }
+                localReads += DEVICES;
+            }
+            reads += localReads;
+            inconsistent += localInconsistent;
+        });
+    }
+
+    for (int w = 0; w < writers; w++)
+    {
+        threads.emplace_back([&, w]()
+        {
+            Xoshiro256pp rng(static_cast<uint64_t>(w) + 1);
+            uint64_t localWrites = 0;
+            while (running.load(std::memory_order_relaxed))
+            {
+                table.toggle(rng() % DEVICES);
+                localWrites++;
+            }
+            writes += localWrites;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(duration);
+    running = false;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return {reads / seconds, writes / seconds, inconsistent.load()};
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    std::chrono::milliseconds duration(argc > 1 ? std::atoi(argv[1]) : 500);
+    Logger::setLevel(LogCategory::LIGHTS, LogLevel::OFF);
+
+    std::printf("%u hardware threads, %zu lights, %lld ms per run\n",
+                std::thread::hardware_concurrency(), DEVICES, static_cast<long long>(duration.count()));
+
+    for (int readers : {1, 2, 4})
+    {
+        for (int writers : {0, 1, 4})
+        {
+            MutexTable locked;
+            AtomicTable packed;
+            StressResult before = stress(locked, readers, writers, duration);
+            StressResult after = stress(packed, readers, writers, duration);
+
+            std::printf("%d readers, %d writers | mutex %12.0f reads/s %11.0f writes/s | atomic %12.0f reads/s "
+                        "%11.0f writes/s | %6.1fx reads | torn snapshots: %llu\n",
+                        readers, writers, before.readsPerSecond, before.writesPerSecond,
+                        after.readsPerSecond, after.writesPerSecond, after.readsPerSecond / before.readsPerSecond,
+                        static_cast<unsigned long long>(after.inconsistent));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "EventBus.hpp"
+#include "LatencyHistogram.hpp"
+#include "Logger.hpp"
+#include "TaskManager.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+uint64_t nanosSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+void printResult(const char* label, uint64_t handled, double seconds, uint64_t dropped, const LatencyHistogram& latency)
+{
+    LatencyHistogram::Summary summary = latency.summarize();
+    std::printf("%-34s | %10.0f events/s | publish-to-handle p50 %8.2f us, p99 %9.2f us, max %9.2f us | dropped %llu\n",
+                label, handled / seconds, summary.p50 / 1000.0, summary.p99 / 1000.0, summary.max / 1000.0,
+                static_cast<unsigned long long>(dropped));
+}
+
+// Publishers push as fast as they can; one consumer thread drains its inbox
+void runBusOnly(int publishers, size_t eventsPerPublisher)
+{
+    EventBus* bus = EventBus::getInstance();
+    auto subscription = bus -> subscribe("bench-consumer", {EventTopic::TEMPERATURE_READING}, {}, 1 << 16);
+    LatencyHistogram latency;
+    std::atomic<bool> publishing{true};
+    uint64_t handled = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&]()
+    {
+        Event event;
+        while (true)
+        {
+            if (subscription -> poll(event))
+            {
+                latency.record(nanosSince(event.publishedAt));
+                handled++;
+            }
+            else if (!publishing.load(std::memory_order_acquire))
+            {
+                if (!subscription -> poll(event))
+                {
+                    break;
+                }
+                latency.record(nanosSince(event.publishedAt));
+                handled++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < publishers; p++)
+    {
+        threads.emplace_back([&, p]()
+        {
+            for (size_t i = 0; i < eventsPerPublisher; i++)
+            {
+                bus -> publish(TemperatureReading{static_cast<float>(p)});
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    publishing.store(false, std::memory_order_release);
+    consumer.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::string label = "saturated bus, " + std::to_string(publishers) + " publisher(s)";
+    printResult(label.c_str(), handled, seconds, subscription -> getDroppedCount(), latency);
+    bus -> unsubscribe(subscription);
+}
+
+// Event-driven task: no period, released by wakeTask on each delivery
+class ReactionTask : public Task
+{
+private:
+    std::string name{"Reaction Task"};
+    std::shared_ptr<EventSubscription> subscription;
+
+public:
+    LatencyHistogram latency;
+    std::atomic<uint64_t> handled{0};
+
+    ReactionTask()
+    {
+        subscription = EventBus::getInstance() -> subscribe(name, {EventTopic::MOTION},
+            [this]() { TaskManager::getInstance() -> wakeTask(this); }, 1024);
+    }
+
+    void execute() override
+    {
+        Event event;
+        while (subscription -> poll(event))
+        {
+            latency.record(nanosSince(event.publishedAt));
+            handled.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const std::string& getName() const override { return name; }
+    int getPriority() const override { return 5; }
+    bool isEventDriven() const override { return true; }
+    uint64_t getDroppedCount() const { return subscription -> getDroppedCount(); }
+};
+
+// Publisher -> bus -> wakeTask -> scheduler thread -> task, end to end
+void runThroughScheduler(size_t events)
+{
+    auto owned = std::make_unique<ReactionTask>();
+    ReactionTask* task = owned.get();
+    TaskManager* taskManager = TaskManager::getInstance();
+    taskManager -> addTask(std::move(owned));
+    taskManager -> startScheduler();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < events; i++)
+    {
+        EventBus::getInstance() -> publish(MotionDetected{static_cast<int>(i & 7), 80.0f});
+        // Bursts of 16, as a rule pass would publish
+        if ((i & 15) == 15)
+        {
+            std::this_thread::yield();
+        }
+    }
+    while (task -> handled.load() + task -> getDroppedCount() < events)
+    {
+        std::this_thread::yield();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    taskManager -> stopScheduler();
+    printResult("bus -> wakeTask -> scheduler -> task", task -> handled.load(), seconds, task -> getDroppedCount(),
+                task -> latency);
+    std::printf("%-34s | %llu task executions for %llu events (wakes coalesce)\n", "",
+                static_cast<unsigned long long>(task -> metrics.executions.load()),
+                static_cast<unsigned long long>(task -> handled.load()));
+}
+
+// A subscriber that never drains must not slow its publisher down
+void runSlowSubscriber(size_t events)
+{
+    EventBus* bus = EventBus::getInstance();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < events; i++)
+    {
+        bus -> publish(LightLevelReading{50.0f});
+    }
+    double alone = static_cast<double>(nanosSince(start)) / events;
+
+    auto stalled = bus -> subscribe("stalled", {EventTopic::LIGHT_LEVEL}, {}, 64);
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < events; i++)
+    {
+        bus -> publish(LightLevelReading{50.0f});
+    }
+    double withStalled = static_cast<double>(nanosSince(start)) / events;
+
+    std::printf("publish cost: no subscriber %.1f ns | stalled subscriber %.1f ns (%llu delivered, %llu dropped)\n",
+                alone, withStalled, static_cast<unsigned long long>(stalled -> getDeliveredCount()),
+                static_cast<unsigned long long>(stalled -> getDroppedCount()));
+    bus -> unsubscribe(stalled);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t events = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::SCHEDULER, LogLevel::WARN);
+
+    for (int publishers : {1, 2, 4})
+    {
+        runBusOnly(publishers, events / publishers);
+    }
+    runThroughScheduler(events / 10);
+    runSlowSubscriber(events);
+
+    return 0;
+}
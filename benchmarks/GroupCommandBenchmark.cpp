@@ -0,0 +1,85 @@
+#include "DeviceGroup.hpp"
+#include "DeviceRegistry.hpp"
+#include "LightController.hpp"
+#include "Logger.hpp"
+#include "SimulationClock.hpp"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t MAX_FIXTURES = 10'000;
+
+template <typename Scene>
+double microsPerSwitch(int switches, Scene scene)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < switches; i++)
+    {
+        scene(i % 2 == 0);
+    }
+    Logger::getInstance() -> flush();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / switches;
+}
+
+void runSize(size_t fixtures)
+{
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    DeviceTable& lights = registry -> getLights();
+    std::vector<int> floor(fixtures);
+    for (size_t i = 0; i < fixtures; i++)
+    {
+        floor[i] = static_cast<int>(i);
+    }
+    DeviceGroup group("floor", DeviceType::LIGHT, floor);
+    int switches = fixtures <= 1000 ? 200 : 20;
+
+    // Former path: lock, transition and log each fixture, then a summary
+    double perDevice = microsPerSwitch(switches, [&](bool on)
+    {
+        for (int roomId : floor)
+        {
+            auto now = SimulationClock::getInstance() -> now();
+            std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+            DeviceHandle light = registry -> findDevice(DeviceType::LIGHT, roomId);
+            on ? LightController::turnOnLocked(lights, light, now) : LightController::turnOffLocked(lights, light, now);
+        }
+        LOG_INFO(LIGHTS, "Command: Turning %s all lights", on ? "ON" : "OFF");
+    });
+
+    GroupResult last;
+    double grouped = microsPerSwitch(switches, [&](bool on)
+    {
+        last = on ? LightController::turnOnGroup(group) : LightController::turnOffGroup(group);
+    });
+
+    std::printf("%6zu fixtures | per-device lock+log %10.1f us/switch | group pass %8.1f us/switch | %6.1fx | last switch changed %zu\n",
+                fixtures, perDevice, grouped, perDevice / grouped, last.changed.size());
+}
+
+}
+
+int main()
+{
+    DeviceRegistry::configure(MAX_FIXTURES, 16);
+    for (size_t i = 0; i < MAX_FIXTURES; i++)
+    {
+        DeviceRegistry::getInstance() -> registerDevice(DeviceType::LIGHT, static_cast<int>(i), "Light " + std::to_string(i));
+    }
+
+    // Both paths log to system.log as the application does; keep the
+    // console out of the measurement
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+
+    for (size_t fixtures : {100, 1'000, 10'000})
+    {
+        runSize(fixtures);
+    }
+
+    return 0;
+}
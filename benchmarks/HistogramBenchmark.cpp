@@ -0,0 +1,39 @@
+#include "LatencyHistogram.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+int main()
+{
+    const size_t samples = 50'000'000;
+    LatencyHistogram histogram;
+
+    std::mt19937_64 gen(7);
+    std::lognormal_distribution<double> latency(10.0, 1.5);
+    std::vector<uint64_t> values(1 << 16);
+    for (auto& value : values)
+    {
+        value = static_cast<uint64_t>(latency(gen));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; i++)
+    {
+        histogram.record(values[i & 0xFFFF]);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double nanosPerRecord = std::chrono::duration<double, std::nano>(end - start).count() / samples;
+    auto summary = histogram.summarize();
+
+    std::printf("LatencyHistogram::record: %.2f ns/sample over %zu samples\n", nanosPerRecord, samples);
+    std::printf("p50 %llu ns, p99 %llu ns, p999 %llu ns, max %llu ns, mean %.0f ns\n",
+                static_cast<unsigned long long>(summary.p50), static_cast<unsigned long long>(summary.p99),
+                static_cast<unsigned long long>(summary.p999), static_cast<unsigned long long>(summary.max),
+                summary.mean);
+    std::printf("Footprint: %zu bytes per histogram\n", sizeof(LatencyHistogram));
+
+    return 0;
+}
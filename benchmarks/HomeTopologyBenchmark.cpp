@@ -0,0 +1,123 @@
+#include "DeviceRegistry.hpp"
+#include "HomeTopology.hpp"
+#include "Logger.hpp"
+#include "AllocationCounter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Cold start of homes of 1k, 10k and 100k devices (a light and blinds per
+// room), each in a fresh process: parsing and validating the topology file,
+// then registering the devices, once with the bulk registration the tasks
+// use and once a device at a time, as the tasks did before
+//   home_topology_benchmark [file prefix]
+//   home_topology_benchmark start bulk|single <topology file>
+
+namespace
+{
+
+constexpr const char* PROFILES[] = {"living", "bedroom", "kitchen", "bathroom"};
+
+bool writeTopology(const std::string& path, size_t rooms)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::fprintf(file, "# Generated by home_topology_benchmark\n"
+                       "profile living: 7-9 70, 18-23 70, 9-18 30, default 5\n"
+                       "profile bedroom: 6-8 80, 22-1 80, 1-6 20, default 10\n"
+                       "profile kitchen: 7-9 90, 12-14 90, 18-20 90, default 20\n"
+                       "profile bathroom: default 30\n");
+    for (size_t room = 1; room <= rooms; room++)
+    {
+        const char* profile = PROFILES[room % 4];
+        std::fprintf(file, "room %zu %s light+blinds: %c%s %zu\n", room, profile, profile[0] - 'a' + 'A', profile + 1,
+                     room);
+    }
+    return std::fclose(file) == 0;
+}
+
+double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runStart(const std::string& mode, const std::string& path)
+{
+    HomeTopology* home = HomeTopology::getInstance();
+    std::string error;
+    size_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    if (!home -> loadFile(path, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    double parseMillis = millisSince(start);
+    size_t parseAllocations = allocations - allocationsBefore;
+
+    DeviceRegistry::configure(home -> getLightCount(), home -> getBlindCount());
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+
+    allocationsBefore = allocations;
+    start = std::chrono::steady_clock::now();
+    size_t created = 0;
+    if (mode == "bulk")
+    {
+        created = home -> createLights() + home -> createBlinds();
+    }
+    else
+    {
+        for (size_t room = 1; room <= home -> getRoomCount(); room++)
+        {
+            std::string name = "Room " + std::to_string(room);
+            created += registry -> registerDevice(DeviceType::LIGHT, static_cast<int>(room), name + " Light") !=
+                       INVALID_DEVICE_HANDLE;
+            created += registry -> registerDevice(DeviceType::BLIND, static_cast<int>(room), name + " Blinds") !=
+                       INVALID_DEVICE_HANDLE;
+        }
+    }
+    double buildMillis = millisSince(start);
+    size_t buildAllocations = allocations - allocationsBefore;
+
+    std::printf("%7zu devices | %-6s | parse %7.2f ms (%5zu allocations) | register %7.2f ms (%7zu allocations)\n",
+                created, mode.c_str(), parseMillis, parseAllocations, buildMillis, buildAllocations);
+    return created == home -> getLightCount() + home -> getBlindCount() ? 0 : 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::SYSTEM, LogLevel::WARN);
+
+    std::string phase = argc > 1 ? argv[1] : "";
+    if (phase == "start")
+    {
+        return argc > 3 ? runStart(argv[2], argv[3]) : 1;
+    }
+
+    std::string prefix = argc > 1 ? argv[1] : "home_topology_benchmark";
+    std::string self = std::string("\"") + argv[0] + "\"";
+    int status = 0;
+    for (size_t devices : {1000, 10000, 100000})
+    {
+        std::string path = prefix + "." + std::to_string(devices) + ".conf";
+        if (!writeTopology(path, devices / 2))
+        {
+            std::fprintf(stderr, "cannot write %s\n", path.c_str());
+            return 1;
+        }
+        for (const char* mode : {"bulk", "single"})
+        {
+            std::fflush(stdout);
+            status = status != 0 ? status : std::system((self + " start " + mode + " \"" + path + "\"").c_str());
+        }
+        std::remove(path.c_str());
+    }
+    return status == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include "SegmentedLogWriter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const std::string prefix = "[2026-01-01 12:00:00] ";
+const std::string message = "Motion rule: Detected activity (87.25%) in room 3, turning light on";
+
+template <typename WriteLine>
+void runSink(const char* label, size_t lines, WriteLine writeLine)
+{
+    std::vector<uint32_t> latencies;
+    latencies.reserve(lines);
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < lines; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        writeLine();
+        auto end = std::chrono::steady_clock::now();
+        latencies.push_back(static_cast<uint32_t>(
+            std::min<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(), UINT32_MAX)));
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = static_cast<double>(lines * (prefix.size() + message.size() + 1)) / (1 << 20);
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("  %-26s | %8.1f MiB/s | p50 %6u ns | p99 %7u ns | p999 %8u ns | max %9u ns\n",
+                label, megabytes / seconds, latencies[lines / 2], latencies[lines * 99 / 100],
+                latencies[lines * 999 / 1000], latencies.back());
+}
+
+}
+
+// Writes <lines> log lines (~90 bytes each) through each sink in the working
+// directory and removes the files afterwards.
+int main(int argc, char* argv[])
+{
+    size_t lines = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 2'000'000;
+    std::printf("%zu lines of %zu bytes\n", lines, prefix.size() + message.size() + 1);
+
+    {
+        std::ofstream file("segment_bench_flush.log", std::ios::app);
+        runSink("ofstream, flush per line", lines / 10, [&]()
+        {
+            file << prefix << message << '\n';
+            file.flush();
+        });
+    }
+
+    {
+        std::ofstream file("segment_bench_buffered.log", std::ios::app);
+        runSink("ofstream, buffered", lines, [&]()
+        {
+            file << prefix << message << '\n';
+        });
+    }
+
+    {
+        SegmentedLogWriter writer;
+        SegmentOptions options;
+        options.baseName = "segment_bench";
+        options.retainedSegments = 2;
+        writer.open(options, std::chrono::system_clock::now());
+
+        auto wallNow = std::chrono::system_clock::now();
+        runSink("mmap segments (64 MiB)", lines, [&]()
+        {
+            writer.append(wallNow, {prefix, message, "\n"});
+        });
+        std::printf("  segments written: %llu\n", static_cast<unsigned long long>(writer.getSegmentIndex()));
+    }
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(".", error))
+    {
+        if (entry.path().filename().string().rfind("segment_bench", 0) == 0)
+        {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+
+    return 0;
+}
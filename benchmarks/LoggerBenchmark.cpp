@@ -0,0 +1,150 @@
+#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct RunResult
+{
+    double messagesPerSecond;
+    double p99EnqueueNanos;
+    uint64_t dropped;
+};
+
+RunResult runProducers(int producers, size_t messagesPerProducer)
+{
+    Logger* logger = Logger::getInstance();
+    uint64_t droppedBefore = logger -> getDroppedCount();
+    std::vector<std::vector<uint32_t>> latencies(producers);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p]()
+        {
+            std::string message = "Light in room " + std::to_string(p) + " turned ON at 50% brightness";
+            latencies[p].reserve(messagesPerProducer);
+
+            for (size_t i = 0; i < messagesPerProducer; i++)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                logger -> log(message, false);
+                auto end = std::chrono::steady_clock::now();
+                latencies[p].push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    logger -> flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<uint32_t> all;
+    for (const auto& perThread : latencies)
+    {
+        all.insert(all.end(), perThread.begin(), perThread.end());
+    }
+    std::nth_element(all.begin(), all.begin() + all.size() * 99 / 100, all.end());
+
+    return {producers * messagesPerProducer / seconds,
+            static_cast<double>(all[all.size() * 99 / 100]),
+            logger -> getDroppedCount() - droppedBefore};
+}
+
+void runSuite(const char* label, size_t messagesPerProducer)
+{
+    std::printf("%s\n", label);
+    for (int producers : {1, 2, 4, 8, 16})
+    {
+        RunResult result = runProducers(producers, messagesPerProducer);
+        std::printf("  %2d producers | %12.0f msg/s | p99 enqueue %8.0f ns | dropped %llu\n",
+                    producers, result.messagesPerSecond, result.p99EnqueueNanos,
+                    static_cast<unsigned long long>(result.dropped));
+    }
+}
+
+long long fileSize(const char* path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return file ? static_cast<long long>(file.tellg()) : 0;
+}
+
+// Per-event cost of a typical device log line, formatted eagerly to text or
+// recorded as raw arguments by the binary log.
+void runStructured(const char* label, const char* path, size_t events)
+{
+    Logger* logger = Logger::getInstance();
+    long long sizeBefore = fileSize(path);
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < events; i++)
+    {
+        LOG_INFO(LIGHTS, "Motion rule: Detected activity (%g%%) in room %d, turning light on",
+                 75.0f + static_cast<float>(i % 25), static_cast<int>(i % 4) + 1);
+    }
+    logger -> flush();
+
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("  %-28s | %8.0f ns/event | %6.1f bytes/event\n", label, nanos / events,
+                static_cast<double>(fileSize(path) - sizeBefore) / events);
+}
+
+// Cost of a statement whose level is disabled at runtime. The argument would
+// allocate if it were ever evaluated.
+void runDisabled(size_t statements)
+{
+    Logger::setLevel(LogCategory::SCHEDULER, LogLevel::ERROR);
+    std::string taskName = "Light Control Task";
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < statements; i++)
+    {
+        LOG_WARN(SCHEDULER, "Executing task: %s", taskName + std::to_string(i));
+    }
+
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("  %-28s | %8.2f ns/statement\n", "disabled at runtime", nanos / statements);
+    Logger::setLevel(LogCategory::SCHEDULER, LogLevel::DEBUG);
+}
+
+}
+
+// Writes to system.log and system.log.bin in the working directory.
+int main(int argc, char* argv[])
+{
+    size_t messages = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 100'000;
+    Logger* logger = Logger::getInstance();
+    logger -> setConsoleLevel(LogLevel::OFF);
+
+    runSuite("Synchronous logger (mutex + flush per line)", messages / 10);
+
+    logger -> enableAsync(1 << 16, OverflowPolicy::BLOCK);
+    runSuite("Asynchronous logger, BLOCK policy", messages);
+    logger -> shutdown();
+
+    logger -> enableAsync(1 << 16, OverflowPolicy::COUNT_DROPS);
+    runSuite("Asynchronous logger, COUNT_DROPS policy", messages);
+    logger -> shutdown();
+
+    std::printf("Structured events, 1 producer\n");
+    runStructured("text (sync)", "system.log", messages / 10);
+    logger -> enableBinaryOutput("system.log.bin");
+    runStructured("binary", "system.log.bin", messages);
+    logger -> shutdown();
+    runDisabled(messages * 100);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "DeviceRegistry.hpp"
+#include "LatencyHistogram.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "TaskManager.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cost of counting and of scraping the metrics: one shared atomic against a
+// ShardedCounter from one and four threads, rendering the Prometheus text
+// for a number of tasks, and the latency of device changes while another
+// thread scrapes as fast as it can, which would show any lock the scrape
+// shares with the device tables.
+//   metrics_benchmark [adds per thread] [tasks]
+
+namespace
+{
+
+class BenchTask : public Task
+{
+private:
+    std::string name;
+
+public:
+    explicit BenchTask(int id) : name("Task " + std::to_string(id)) {}
+    void execute() override {}
+    const std::string& getName() const override { return name; }
+    int getPriority() const override { return 1; }
+};
+
+template <typename Add>
+double nanosPerAdd(size_t threads, size_t adds, Add add)
+{
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([adds, &add]()
+        {
+            for (size_t i = 0; i < adds; i++)
+            {
+                add();
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           (threads * adds);
+}
+
+// Changes lights for the given time and reports the latency of each change
+void changeDevices(const char* label, double seconds)
+{
+    DeviceTable& lights = DeviceRegistry::getInstance() -> getLights();
+    LatencyHistogram latency;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    uint8_t level = 0;
+
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (DeviceHandle handle = 0; handle < lights.size(); handle++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            lights.transition(handle, [level](DeviceState& state)
+            {
+                state.level = level;
+                return true;
+            });
+            latency.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                    .count()));
+        }
+        level = static_cast<uint8_t>((level + 25) % 125);
+    }
+
+    LatencyHistogram::Summary summary = latency.summarize();
+    std::printf("%-17s | %.1f M changes/s, p50 %llu ns, p99 %llu ns, p999 %llu ns\n", label,
+                latency.getCount() / seconds / 1e6, static_cast<unsigned long long>(summary.p50),
+                static_cast<unsigned long long>(summary.p99), static_cast<unsigned long long>(summary.p999));
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::SYSTEM, LogLevel::WARN);
+
+    size_t adds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    int taskCount = argc > 2 ? std::atoi(argv[2]) : 4;
+
+    for (size_t threads : {1, 4})
+    {
+        std::atomic<uint64_t> shared{0};
+        ShardedCounter sharded;
+        double sharedNanos = nanosPerAdd(threads, adds / threads,
+                                         [&shared]() { shared.fetch_add(1, std::memory_order_relaxed); });
+        double shardedNanos = nanosPerAdd(threads, adds / threads, [&sharded]() { sharded.add(); });
+        std::printf("%zu thread(s)       | shared atomic %5.2f ns per add | sharded %5.2f ns per add (%u cores)\n",
+                    threads, sharedNanos, shardedNanos, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::unique_ptr<BenchTask>> tasks;
+    for (int i = 0; i < taskCount; i++)
+    {
+        tasks.push_back(std::make_unique<BenchTask>(i + 1));
+        for (int execution = 0; execution < 1000; execution++)
+        {
+            tasks.back() -> metrics.dispatchLatency.record(static_cast<uint64_t>(1000 + execution * 7));
+            tasks.back() -> metrics.executionTime.record(static_cast<uint64_t>(5000 + execution * 13));
+        }
+        Metrics::getInstance() -> registerTask(tasks.back().get());
+    }
+
+    DeviceRegistry::configure(1024, 1024);
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    for (int id = 1; id <= 1024; id++)
+    {
+        registry -> registerDevice(DeviceType::LIGHT, id, "Light " + std::to_string(id));
+    }
+
+    std::string text;
+    const int renders = 1000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < renders; i++)
+    {
+        Metrics::getInstance() -> render(text);
+    }
+    double renderMicros =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / renders;
+    std::printf("render            | %.1f us for %d tasks, %zu bytes\n", renderMicros, taskCount, text.size());
+
+    changeDevices("changes", 0.5);
+    std::atomic<bool> scraping{true};
+    size_t scrapes = 0;
+    std::thread scraper([&]()
+    {
+        std::string body;
+        while (scraping.load(std::memory_order_relaxed))
+        {
+            Metrics::getInstance() -> render(body);
+            scrapes++;
+        }
+    });
+    changeDevices("changes + scrapes", 0.5);
+    scraping = false;
+    scraper.join();
+    std::printf("scrapes           | %zu during the changes\n", scrapes);
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "RandomService.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+template <typename Body>
+double nanosPerSample(size_t samples, Body body)
+{
+    auto start = std::chrono::steady_clock::now();
+    body();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / samples;
+}
+
+// Keeps the compiler from discarding the generated values
+volatile float sink;
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000;
+    // The former pattern opens the entropy source on every call, so it gets fewer samples
+    size_t legacySamples = samples / 100;
+    std::vector<float> batch(1024);
+
+    double legacy = nanosPerSample(legacySamples, [&]()
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < legacySamples; i++)
+        {
+            std::random_device rd;
+            std::mt19937 gen(rd());
+            std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+            sum += dist(gen);
+        }
+        sink = sum;
+    });
+
+    std::mt19937 mt(42);
+    double mersenne = nanosPerSample(samples, [&]()
+    {
+        std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+        float sum = 0.0f;
+        for (size_t i = 0; i < samples; i++)
+        {
+            sum += dist(mt);
+        }
+        sink = sum;
+    });
+
+    Xoshiro256pp rng = RandomService::getInstance() -> createStream("benchmark");
+    double single = nanosPerSample(samples, [&]()
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < samples; i++)
+        {
+            sum += rng.uniform(0.0f, 1.0f);
+        }
+        sink = sum;
+    });
+
+    double batched = nanosPerSample(samples, [&]()
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < samples; i += batch.size())
+        {
+            rng.fillUniform(batch.data(), batch.size(), 0.0f, 1.0f);
+            sum += batch[0];
+        }
+        sink = sum;
+    });
+
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    double mersenneNormal = nanosPerSample(samples, [&]()
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < samples; i++)
+        {
+            sum += gauss(mt);
+        }
+        sink = sum;
+    });
+
+    double batchedNormal = nanosPerSample(samples, [&]()
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < samples; i += batch.size())
+        {
+            rng.fillNormal(batch.data(), batch.size(), 0.0f, 1.0f);
+            sum += batch[0];
+        }
+        sink = sum;
+    });
+
+    std::printf("uniform: random_device + mt19937 per call %8.1f ns | mt19937 %5.2f ns | xoshiro %5.2f ns | xoshiro batched %5.2f ns\n",
+                legacy, mersenne, single, batched);
+    std::printf("normal:  mt19937 normal_distribution %5.2f ns | xoshiro batched %5.2f ns\n", mersenneNormal, batchedNormal);
+    std::printf("speedup of batched xoshiro over the former per-call pattern: %.0fx\n", legacy / batched);
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "TaskManager.hpp"
+#include "ReadyQueue.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+class BenchTask : public Task
+{
+private:
+    std::string name;
+    int priority;
+
+public:
+    BenchTask(int id, int taskPriority) : name("task-" + std::to_string(id)), priority(taskPriority) {}
+    void execute() override {}
+    const std::string& getName() const override { return name; }
+    int getPriority() const override { return priority; }
+};
+
+std::vector<std::unique_ptr<Task>> makeTasks(size_t count, std::mt19937& gen)
+{
+    std::uniform_int_distribution<int> priorityDist(0, ReadyQueue::PRIORITY_LEVELS - 1);
+    std::vector<std::unique_ptr<Task>> tasks;
+    tasks.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        tasks.push_back(std::make_unique<BenchTask>(static_cast<int>(i), priorityDist(gen)));
+        tasks.back() -> schedulingPriority = ReadyQueue::clampPriority(tasks.back() -> getPriority());
+        tasks.back() -> isReady = (i % 2 == 0);
+    }
+
+    return tasks;
+}
+
+// The selection the scheduler used before the ready queue: a linear
+// max_element over all tasks with a virtual call in the comparator.
+Task* legacySelect(std::vector<std::unique_ptr<Task>>& tasks)
+{
+    auto highest = std::max_element(tasks.begin(), tasks.end(),
+    [](const auto& a, const auto& b)
+    {
+        if (!a -> isReady) return true;
+        if (!b -> isReady) return false;
+        return a -> getPriority() < b -> getPriority();
+    });
+
+    return (highest != tasks.end() && (*highest) -> isReady) ? highest -> get() : nullptr;
+}
+
+template <typename Fn>
+double nanosPerDispatch(size_t dispatches, Fn&& dispatch)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < dispatches; i++)
+    {
+        dispatch(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / dispatches;
+}
+
+// Each dispatch takes the highest ready task out of the ready set and makes
+// another (random) task ready, so the ready population stays constant.
+void runCase(size_t taskCount)
+{
+    std::mt19937 gen(42);
+    auto tasks = makeTasks(taskCount, gen);
+    std::vector<size_t> wakeOrder(1 << 16);
+    std::uniform_int_distribution<size_t> pick(0, taskCount - 1);
+    for (auto& index : wakeOrder)
+    {
+        index = pick(gen);
+    }
+
+    size_t dispatches = std::max<size_t>(1000, 20'000'000 / taskCount);
+    dispatches = std::min<size_t>(dispatches, 1'000'000);
+
+    double legacy = nanosPerDispatch(dispatches, [&](size_t i)
+    {
+        Task* task = legacySelect(tasks);
+        if (task != nullptr)
+        {
+            task -> isReady = false;
+        }
+        tasks[wakeOrder[i & 0xFFFF]] -> isReady = true;
+    });
+
+    ReadyQueue readyQueue;
+    for (auto& task : tasks)
+    {
+        task -> isReady = false;
+    }
+    for (size_t i = 0; i < taskCount; i += 2)
+    {
+        readyQueue.push(tasks[i].get());
+    }
+
+    double bitmap = nanosPerDispatch(dispatches, [&](size_t i)
+    {
+        readyQueue.popHighest();
+        readyQueue.push(tasks[wakeOrder[i & 0xFFFF]].get());
+    });
+
+    std::printf("%8zu tasks | max_element %12.1f ns/dispatch | bitmap %8.1f ns/dispatch | speedup %8.1fx\n",
+                taskCount, legacy, bitmap, legacy / bitmap);
+}
+
+}
+
+int main()
+{
+    std::printf("Ready queue dispatch cost\n");
+
+    for (size_t taskCount : {size_t{10}, size_t{1'000}, size_t{100'000}})
+    {
+        runCase(taskCount);
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "DeviceRegistry.hpp"
+#include "LatencyHistogram.hpp"
+#include "Logger.hpp"
+#include "RandomService.hpp"
+#include "RuleEngine.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr int LIGHTS = 1000;
+
+// Each rule reads one motion input; every 100th also reads "hour", so an
+// hour change touches 1% of the rules
+std::string generateRules(int rules, int inputs)
+{
+    std::string text;
+    for (int i = 0; i < rules; i++)
+    {
+        text += "rule r" + std::to_string(i) + ": motion." + std::to_string(i % inputs) +
+                (i % 2 == 0 ? " > " : " < ") + std::to_string(i % 2 == 0 ? 90 : 10);
+        if (i % 100 == 0)
+        {
+            text += " and hour >= " + std::to_string(i / 100 % 24);
+        }
+        text += " -> lights " + std::to_string(i % LIGHTS + 1) + (i % 2 == 0 ? " on\n" : " off\n");
+    }
+    return text;
+}
+
+struct ChangeResult
+{
+    double evaluationsPerChange;
+    double nanosPerChange;
+};
+
+// setInput + evaluate on random inputs; fullScan re-evaluates every rule
+// after each change, as the hard-coded rule passes did
+ChangeResult runChanges(const std::vector<RuleInputId>& inputs, int changes, bool fullScan)
+{
+    RuleEngine* engine = RuleEngine::getInstance();
+    Xoshiro256pp rng = RandomService::getInstance() -> createStream("bench.rule-inputs");
+    uint64_t evaluated = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < changes; i++)
+    {
+        engine -> setInput(inputs[static_cast<size_t>(rng.uniformInt(0, static_cast<int>(inputs.size()) - 1))],
+                           rng.uniform(0.0f, 100.0f));
+        if (fullScan)
+        {
+            engine -> invalidateAll();
+        }
+        evaluated += engine -> evaluate();
+    }
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return {static_cast<double>(evaluated) / changes, nanos / changes};
+}
+
+// Reloads the rule set while another thread keeps feeding inputs
+void runHotReload(const std::string& text, const std::vector<RuleInputId>& inputs, int reloads)
+{
+    RuleEngine* engine = RuleEngine::getInstance();
+    std::atomic<bool> feeding{true};
+    std::atomic<uint64_t> changes{0};
+    LatencyHistogram changeLatency;
+
+    std::thread feeder([&]()
+    {
+        Xoshiro256pp rng = RandomService::getInstance() -> createStream("bench.rule-feeder");
+        while (feeding.load(std::memory_order_relaxed))
+        {
+            auto start = std::chrono::steady_clock::now();
+            engine -> setInput(inputs[static_cast<size_t>(rng.uniformInt(0, static_cast<int>(inputs.size()) - 1))],
+                               rng.uniform(0.0f, 100.0f));
+            engine -> evaluate();
+            changeLatency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+            changes.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    LatencyHistogram reloadTime;
+    std::string error;
+    for (int i = 0; i < reloads; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        engine -> loadText(text, "generated", error);
+        reloadTime.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+        std::this_thread::yield();
+    }
+    feeding.store(false);
+    feeder.join();
+
+    LatencyHistogram::Summary reload = reloadTime.summarize();
+    LatencyHistogram::Summary change = changeLatency.summarize();
+    std::printf("hot reload x%d: %.2f ms p50 per reload | %llu input changes handled meanwhile, "
+                "p50 %.2f us, p99 %.2f us, max %.2f ms\n",
+                reloads, reload.p50 / 1e6, static_cast<unsigned long long>(changes.load()),
+                change.p50 / 1000.0, change.p99 / 1000.0, change.max / 1e6);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int rules = argc > 1 ? std::atoi(argv[1]) : 10'000;
+    int inputCount = argc > 2 ? std::atoi(argv[2]) : 1000;
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::LIGHTS, LogLevel::WARN);
+
+    for (int id = 1; id <= LIGHTS; id++)
+    {
+        DeviceRegistry::getInstance() -> registerDevice(DeviceType::LIGHT, id, "Light " + std::to_string(id));
+    }
+
+    RuleEngine* engine = RuleEngine::getInstance();
+    std::string text = generateRules(rules, inputCount);
+    std::string error;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!engine -> loadText(text, "generated", error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    double loadMillis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("compiled %d rules over %d inputs in %.2f ms\n", rules, inputCount, loadMillis);
+
+    std::vector<RuleInputId> inputs;
+    for (int i = 0; i < inputCount; i++)
+    {
+        inputs.push_back(engine -> getInput("motion." + std::to_string(i)));
+    }
+    engine -> evaluate();
+
+    ChangeResult indexed = runChanges(inputs, 200'000, false);
+    ChangeResult full = runChanges(inputs, 2'000, true);
+    std::printf("%-28s | %10.1f rule evaluations per input change | %10.0f ns per change\n",
+                "dependency-indexed", indexed.evaluationsPerChange, indexed.nanosPerChange);
+    std::printf("%-28s | %10.1f rule evaluations per input change | %10.0f ns per change\n",
+                "every rule on every change", full.evaluationsPerChange, full.nanosPerChange);
+
+    std::vector<RuleInputId> hour{engine -> getInput("hour")};
+    ChangeResult hourly = runChanges(hour, 2'000, false);
+    std::printf("%-28s | %10.1f rule evaluations per input change | %10.0f ns per change\n",
+                "hour (shared input)", hourly.evaluationsPerChange, hourly.nanosPerChange);
+
+    runHotReload(text, inputs, 20);
+
+    return 0;
+}
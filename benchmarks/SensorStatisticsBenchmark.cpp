@@ -0,0 +1,139 @@
+#include "Logger.hpp"
+#include "RandomService.hpp"
+#include "SensorStatistics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace
+{
+
+// What a query costs without incremental state: a pass over the window
+struct NaiveWindow
+{
+    std::deque<std::pair<double, float>> samples;
+    double window;
+    double average{0.0};
+    float min{0.0f};
+    float max{0.0f};
+    double slope{0.0};
+
+    explicit NaiveWindow(double windowSeconds) : window(windowSeconds) {}
+
+    void update(double t, float value)
+    {
+        samples.push_back({t, value});
+        while (samples.front().first < t - window)
+        {
+            samples.pop_front();
+        }
+
+        double sumT = 0.0, sumTT = 0.0, sumV = 0.0, sumTV = 0.0;
+        min = max = value;
+        for (const auto& [time, sample] : samples)
+        {
+            double relative = time - samples.front().first;
+            sumT += relative;
+            sumTT += relative * relative;
+            sumV += sample;
+            sumTV += relative * sample;
+            min = std::min(min, sample);
+            max = std::max(max, sample);
+        }
+        double n = static_cast<double>(samples.size());
+        average = sumV / n;
+        double denominator = n * sumTT - sumT * sumT;
+        slope = denominator > 0.0 ? (n * sumTV - sumT * sumV) / denominator : 0.0;
+    }
+};
+
+double nanosPerCall(std::chrono::steady_clock::time_point start, size_t calls)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+void runWindow(size_t windowSeconds, const std::vector<float>& values)
+{
+    StreamingStatistics statistics("bench", std::chrono::seconds(windowSeconds), std::chrono::minutes(5));
+    auto origin = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        statistics.update(origin + std::chrono::seconds(i), values[i]);
+    }
+    double streaming = nanosPerCall(start, values.size());
+
+    // The naive pass is O(window); run it on fewer samples for big windows
+    size_t naiveSamples = std::min(values.size(), windowSeconds + 2'000'000 / windowSeconds);
+    NaiveWindow naive(static_cast<double>(windowSeconds));
+    double sink = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < naiveSamples; i++)
+    {
+        naive.update(static_cast<double>(i), values[i]);
+        sink += naive.average + naive.slope + naive.min + naive.max;
+    }
+    double recompute = nanosPerCall(start, naiveSamples);
+
+    size_t queries = 1'000'000;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries; i++)
+    {
+        sink += statistics.getSummary().windowAverage;
+    }
+    double query = nanosPerCall(start, queries);
+
+    std::printf("window %6zu samples | streaming update %7.1f ns | recompute per sample %11.1f ns | "
+                "query %5.1f ns%s\n", windowSeconds, streaming, recompute, query, sink < 0.0 ? " " : "");
+}
+
+// Counts warning changes for a reading hovering around the 25 C limit
+void runFlapping()
+{
+    Xoshiro256pp rng = RandomService::getInstance() -> createStream("bench.flapping");
+    StreamingStatistics statistics("temperature", std::chrono::minutes(15), std::chrono::minutes(5));
+    statistics.setAlertBands({25.0f, 24.0f, 20.0f, 21.0f});
+    auto origin = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+
+    // One day of 30 s readings: a slow swing of +-1.5 C around 24.5 C plus
+    // +-1 C sensor noise
+    int rawChanges = 0;
+    int rawState = 0;
+    for (int i = 0; i < 2880; i++)
+    {
+        float value = 24.5f + 1.5f * std::sin(i * 2.0f * 3.14159f / 960.0f) + rng.uniform(-1.0f, 1.0f);
+        int state = value > 25.0f ? 1 : (value < 20.0f ? -1 : 0);
+        rawChanges += state != rawState;
+        rawState = state;
+        statistics.update(origin + std::chrono::seconds(30 * i), value);
+    }
+
+    std::printf("warning changes over a day near 25 C | single-reading threshold: %d | EWMA + hysteresis: %llu\n",
+                rawChanges, static_cast<unsigned long long>(statistics.getSummary().alertChanges));
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::SENSORS, LogLevel::WARN);
+
+    Xoshiro256pp rng = RandomService::getInstance() -> createStream("bench.readings");
+    std::vector<float> values(samples);
+    rng.fillUniform(values.data(), samples, 18.0f, 26.0f);
+
+    for (size_t window : {60, 3600, 86400})
+    {
+        runWindow(window, values);
+    }
+    runFlapping();
+
+    return 0;
+}
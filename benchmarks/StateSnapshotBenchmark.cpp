@@ -0,0 +1,270 @@
+#include "DeviceRegistry.hpp"
+#include "LatencyHistogram.hpp"
+#include "Logger.hpp"
+#include "StateStore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Snapshots and journals a home of 100k devices (half lights, half blinds)
+// while another thread keeps changing them, then restores the files in fresh
+// processes: cold, registering every device from the snapshot, and warm,
+// into devices the tasks already created. The last journal batch is torn
+// off before the restores, as a crash in the middle of an append would.
+//   state_snapshot_benchmark [devices] [state file]
+//   state_snapshot_benchmark restore cold|warm <devices> <state file> <fingerprint>
+
+namespace
+{
+
+constexpr int SNAPSHOTS = 5;
+constexpr int JOURNAL_BATCHES = 10;
+
+void createDevices(size_t devices)
+{
+    DeviceRegistry::configure(devices / 2, devices - devices / 2);
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    for (size_t i = 0; i < devices; i++)
+    {
+        bool light = i < devices / 2;
+        int id = static_cast<int>(light ? i : i - devices / 2) + 1;
+        registry -> registerDevice(light ? DeviceType::LIGHT : DeviceType::BLIND, id,
+                                   (light ? "Light " : "Blind ") + std::to_string(id));
+    }
+}
+
+bool changeDevice(DeviceTable& table, DeviceHandle handle, uint8_t level)
+{
+    uint32_t nowMillis = table.toMillis(std::chrono::steady_clock::now());
+    return table.transition(handle, [&](DeviceState& state)
+    {
+        state.state = level > 0 ? 1 : 0;
+        state.level = level;
+        state.lastChangeMillis = nowMillis;
+        return true;
+    });
+}
+
+// Order-independent, so the restored tables may hold the devices at other
+// handles
+uint64_t fingerprint()
+{
+    uint64_t sum = 0;
+    for (DeviceType type : {DeviceType::LIGHT, DeviceType::BLIND})
+    {
+        DeviceTable& table = DeviceRegistry::getInstance() -> getTable(type);
+        for (DeviceHandle handle = 0; handle < table.size(); handle++)
+        {
+            DeviceState state = table.load(handle);
+            uint64_t value = (static_cast<uint64_t>(table.getDeviceId(handle)) << 24) |
+                             static_cast<uint64_t>(type) << 16 | static_cast<uint64_t>(state.state) << 8 | state.level;
+            value *= 0x9E3779B97F4A7C15ULL;
+            sum += value ^ (value >> 31);
+        }
+    }
+    return sum;
+}
+
+// Changes random devices as fast as it can and records how long each change
+// took, which would show any wait on the snapshot writer
+class Mutator
+{
+private:
+    std::atomic<bool> running{true};
+    std::thread thread;
+    LatencyHistogram latency;
+
+public:
+    Mutator()
+        : thread([this]()
+          {
+              std::mt19937 random(7);
+              DeviceTable& lights = DeviceRegistry::getInstance() -> getLights();
+              while (running.load(std::memory_order_relaxed))
+              {
+                  DeviceHandle handle = random() % lights.size();
+                  auto start = std::chrono::steady_clock::now();
+                  changeDevice(lights, handle, static_cast<uint8_t>(random() % 5 * 25));
+                  latency.record(static_cast<uint64_t>(
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count()));
+              }
+          })
+    {
+    }
+
+    void stop(double seconds)
+    {
+        running = false;
+        thread.join();
+        LatencyHistogram::Summary summary = latency.summarize();
+        std::printf("  concurrent changes: %.1f M/s, p50 %llu ns, p99 %llu ns, p999 %llu ns\n",
+                    latency.getCount() / seconds / 1e6, static_cast<unsigned long long>(summary.p50),
+                    static_cast<unsigned long long>(summary.p99), static_cast<unsigned long long>(summary.p999));
+    }
+};
+
+int runRestore(const std::string& mode, size_t devices, const std::string& path, uint64_t expected)
+{
+    if (mode == "warm")
+    {
+        createDevices(devices);
+    }
+    else
+    {
+        DeviceRegistry::configure(devices / 2, devices - devices / 2);
+    }
+
+    RestoreResult result;
+    std::string error;
+    if (!StateStore::getInstance() -> open(path, result, error) || !result.restored)
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    bool matches = fingerprint() == expected;
+    std::printf("restore %-4s | %7.2f ms | %zu devices (%zu registered), %zu journal batches, %zu records | %s\n",
+                mode.c_str(), result.seconds * 1000.0, result.devices, result.registered, result.journalBatches,
+                result.journalRecords, matches ? "state matches" : "STATE DIFFERS");
+    return matches ? 0 : 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::SYSTEM, LogLevel::WARN);
+
+    std::string phase = argc > 1 ? argv[1] : "";
+    if (phase == "restore")
+    {
+        return argc > 5 ? runRestore(argv[2], std::strtoul(argv[3], nullptr, 10), argv[4],
+                                     std::strtoull(argv[5], nullptr, 10))
+                        : 1;
+    }
+
+    size_t devices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::string path = argc > 2 ? argv[2] : "state_snapshot_benchmark.state";
+    std::string journalPath = path + ".journal";
+    std::remove(path.c_str());
+    std::remove(journalPath.c_str());
+
+    createDevices(devices);
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    std::mt19937 random(1);
+    for (DeviceType type : {DeviceType::LIGHT, DeviceType::BLIND})
+    {
+        DeviceTable& table = registry -> getTable(type);
+        for (DeviceHandle handle = 0; handle < table.size(); handle++)
+        {
+            changeDevice(table, handle, static_cast<uint8_t>(random() % 5 * 25));
+        }
+    }
+
+    StateStore* store = StateStore::getInstance();
+    RestoreResult none;
+    std::string error;
+    if (!store -> open(path, none, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::printf("%zu devices\n", devices);
+    {
+        Mutator mutator;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::printf("no snapshot  |\n");
+        mutator.stop(0.1);
+    }
+
+    double captureMillis = 0.0;
+    double writeMillis = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Mutator mutator;
+        for (int i = 0; i < SNAPSHOTS; i++)
+        {
+            if (!store -> snapshotNow(error))
+            {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+            captureMillis += store -> getStatistics().lastCaptureMillis;
+            writeMillis += store -> getStatistics().lastWriteMillis;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("snapshot     | %7.2f ms capture under shared locks + %.2f ms write and sync | %.2f MiB\n",
+                    captureMillis / SNAPSHOTS, writeMillis / SNAPSHOTS,
+                    store -> getStatistics().lastSnapshotBytes / (1024.0 * 1024.0));
+        mutator.stop(seconds);
+    }
+
+    // Quiet home: once the changes made during the snapshots are journaled,
+    // the writer thread's poll finds nothing to do
+    store -> journalNow(error);
+    auto quietStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; i++)
+    {
+        store -> journalNow(error);
+    }
+    std::printf("journal idle | %7.2f us per poll\n",
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - quietStart).count() /
+                    1000);
+
+    // 1% of the devices change between polls
+    double journalMillis = 0.0;
+    uint64_t beforeLastBatch = 0;
+    uintmax_t journalBytesBeforeLastBatch = 0;
+    for (int batch = 0; batch < JOURNAL_BATCHES; batch++)
+    {
+        if (batch == JOURNAL_BATCHES - 1)
+        {
+            beforeLastBatch = fingerprint();
+            journalBytesBeforeLastBatch = std::filesystem::file_size(journalPath);
+        }
+        for (size_t i = 0; i < devices / 100; i++)
+        {
+            DeviceTable& table = registry -> getTable(i % 2 == 0 ? DeviceType::LIGHT : DeviceType::BLIND);
+            changeDevice(table, static_cast<DeviceHandle>(random() % table.size()),
+                         static_cast<uint8_t>(random() % 5 * 25));
+        }
+        auto batchStart = std::chrono::steady_clock::now();
+        if (!store -> journalNow(error))
+        {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        journalMillis += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count();
+    }
+    StateStoreStatistics statistics = store -> getStatistics();
+    std::printf("journal      | %7.2f ms per batch of ~%zu changes (diff, append, sync) | %llu records\n",
+                journalMillis / JOURNAL_BATCHES, devices / 100,
+                static_cast<unsigned long long>(statistics.journalRecords));
+
+    uintmax_t journalBytes = std::filesystem::file_size(journalPath);
+    std::printf("files        | %.2f MiB snapshot, %.2f MiB journal\n",
+                statistics.lastSnapshotBytes / (1024.0 * 1024.0), journalBytes / (1024.0 * 1024.0));
+
+    // Tear the last batch in half; the restores must stop before it
+    std::filesystem::resize_file(journalPath, (journalBytesBeforeLastBatch + journalBytes) / 2);
+
+    std::string self = std::string("\"") + argv[0] + "\"";
+    std::string common = " " + std::to_string(devices) + " \"" + path + "\" " + std::to_string(beforeLastBatch);
+    std::fflush(stdout);
+    int status = std::system((self + " restore cold" + common).c_str());
+    status = status != 0 ? status : std::system((self + " restore warm" + common).c_str());
+
+    std::remove(path.c_str());
+    std::remove(journalPath.c_str());
+    return status == 0 ? 0 : 1;
+}
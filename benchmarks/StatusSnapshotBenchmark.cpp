@@ -0,0 +1,120 @@
+#include "DeviceRegistry.hpp"
+#include "LightControlTask.hpp"
+#include "LightController.hpp"
+#include "Logger.hpp"
+#include "AllocationCounter.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t DEVICES = 1000;
+
+// Replica of the former LightControlTask::getStatusReport
+std::vector<std::pair<int, std::string>> legacyStatusReport(const DeviceTable& lights)
+{
+    std::vector<std::pair<int, std::string>> report;
+
+    std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+    for (DeviceHandle light = 0; light < lights.size(); light++)
+    {
+        DeviceState snapshot = lights.load(light);
+        LightBrightness brightness = static_cast<LightBrightness>(snapshot.level);
+        int roomId = lights.getDeviceId(light);
+        std::stringstream ss;
+        ss << "Room " << roomId << ": "
+           << (snapshot.state == static_cast<uint8_t>(LightState::ON) ? "ON" : "OFF")
+           << " (" << LightController::getBrightnessName(brightness) << ", "
+           << static_cast<int>(brightness) << "%)";
+
+        report.push_back({roomId, ss.str()});
+    }
+
+    return report;
+}
+
+template <typename Call>
+void measure(const char* label, size_t calls, Call call)
+{
+    size_t allocationsBefore = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (size_t i = 0; i < calls; i++)
+    {
+        sink += call(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double perCall = static_cast<double>(allocations.load() - allocationsBefore) / calls;
+
+    std::printf("%-44s | %12.1f ns/call | %8.1f allocations/call%s\n", label, seconds * 1e9 / calls, perCall,
+                sink == 0 ? " " : "");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::LIGHTS, LogLevel::WARN);
+
+    DeviceTable lights(DEVICES);
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < DEVICES; i++)
+    {
+        lights.add(static_cast<int>(i + 1), 0, now);
+        if (i % 3 == 0)
+        {
+            LightController::turnOnLocked(lights, static_cast<DeviceHandle>(i), now);
+        }
+    }
+
+    std::printf("%zu lights, %zu calls per variant\n", DEVICES, calls);
+
+    measure("former report (vector<pair<int, string>>)", calls, [&](size_t)
+    {
+        return legacyStatusReport(lights).size();
+    });
+
+    std::vector<DeviceStatus> buffer(DEVICES);
+    measure("copyStatus into caller buffer", calls * 10, [&](size_t)
+    {
+        return lights.copyStatus(buffer.data(), buffer.size());
+    });
+
+    DeviceSnapshot snapshot;
+    snapshot.refresh(lights);
+    measure("DeviceSnapshot, nothing changed", calls * 1000, [&](size_t)
+    {
+        return static_cast<size_t>(snapshot.refresh(lights)) + snapshot.size();
+    });
+
+    measure("DeviceSnapshot, one light toggled per call", calls * 10, [&](size_t i)
+    {
+        DeviceHandle light = static_cast<DeviceHandle>(i % DEVICES);
+        if (!LightController::turnOnLocked(lights, light, now))
+        {
+            LightController::turnOffLocked(lights, light, now);
+        }
+        return static_cast<size_t>(snapshot.refresh(lights)) + snapshot.size();
+    });
+
+    char line[128];
+    measure("format every snapshot entry (optional)", calls, [&](size_t)
+    {
+        size_t written = 0;
+        for (const DeviceStatus& status : snapshot)
+        {
+            written += static_cast<size_t>(LightControlTask::formatStatus(status, line, sizeof(line)));
+        }
+        return written;
+    });
+
+    return 0;
+}
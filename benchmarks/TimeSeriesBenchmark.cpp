@@ -0,0 +1,125 @@
+#include "RandomService.hpp"
+#include "TimeSeries.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace
+{
+
+struct Dataset
+{
+    const char* label;
+    // Value of sample i and its timestamp offset from the exact 1 Hz grid
+    std::function<float(size_t)> value;
+    std::function<int(size_t)> jitterMillis;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void runDataset(const Dataset& dataset, size_t samples)
+{
+    TimeSeries series(dataset.label, std::chrono::hours(24 * 366));
+    auto origin = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+
+    std::vector<float> values(samples);
+    std::vector<std::chrono::steady_clock::time_point> times(samples);
+    for (size_t i = 0; i < samples; i++)
+    {
+        values[i] = dataset.value(i);
+        times[i] = origin + std::chrono::seconds(i) + std::chrono::milliseconds(dataset.jitterMillis(i));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < samples; i++)
+    {
+        series.append(times[i], values[i]);
+    }
+    double appendSeconds = secondsSince(start);
+
+    // Full scan, checked bit for bit against the input
+    size_t index = 0;
+    size_t mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    series.scan(times.front(), times.back(), [&](std::chrono::steady_clock::time_point time, float value)
+    {
+        uint32_t expected;
+        uint32_t actual;
+        std::memcpy(&expected, &values[index], sizeof(expected));
+        std::memcpy(&actual, &value, sizeof(actual));
+        auto expectedTime = std::chrono::time_point_cast<std::chrono::milliseconds>(times[index]);
+        if (expected != actual || time != expectedTime)
+        {
+            mismatches++;
+        }
+        index++;
+    });
+    double scanSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    auto hourly = series.downsample(times.front(), times.back(), std::chrono::hours(1));
+    double hourlySeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    auto minutes = series.downsample(times.front(), times.back(), std::chrono::minutes(1));
+    double minuteSeconds = secondsSince(start);
+
+    TimeSeries::Statistics stats = series.getStatistics();
+    // One year of 1 Hz samples for 300 sensors
+    double yearGiB = stats.bytesPerSample * 365.0 * 86400.0 * 300.0 / (1024.0 * 1024.0 * 1024.0);
+
+    std::printf("%-30s | %5.2f bytes/sample | append %6.1f ns, %5.1fM/s | scan %5.1fM/s | "
+                "downsample 1 h %7.2f ms, 1 min %7.2f ms | 300 sensors x 1 year: %5.2f GiB | %s\n",
+                dataset.label, stats.bytesPerSample, appendSeconds * 1e9 / samples, samples / appendSeconds / 1e6,
+                index / scanSeconds / 1e6, hourlySeconds * 1e3, minuteSeconds * 1e3, yearGiB,
+                mismatches == 0 && index == samples && !hourly.empty() && !minutes.empty() ? "lossless" : "MISMATCH");
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    size_t samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1'000'000;
+    Xoshiro256pp rng = RandomService::getInstance() -> createStream("bench.time-series");
+
+    std::vector<float> walk(samples);
+    float temperature = 21.0f;
+    for (size_t i = 0; i < samples; i++)
+    {
+        temperature += rng.uniform(0.0f, 1.0f) < 0.1f ? (rng.uniform(0.0f, 1.0f) < 0.5f ? -0.1f : 0.1f) : 0.0f;
+        walk[i] = std::round(temperature * 10.0f) / 10.0f;
+    }
+    std::vector<float> noise(samples);
+    rng.fillUniform(noise.data(), samples, -1.0f, 1.0f);
+    std::vector<int> jitter(samples);
+    for (size_t i = 0; i < samples; i++)
+    {
+        jitter[i] = rng.uniformInt(0, 4);
+    }
+
+    auto exact = [](size_t) { return 0; };
+    const Dataset datasets[] = {
+        {"constant (on/off sensor)", [](size_t i) { return (i / 3600) % 2 == 0 ? 0.0f : 1.0f; }, exact},
+        {"0.1 C random walk", [&walk](size_t i) { return walk[i]; }, exact},
+        {"0.1 C walk, 0-4 ms jitter", [&walk](size_t i) { return walk[i]; }, [&jitter](size_t i) { return jitter[i]; }},
+        {"daily sine + full noise",
+         [&noise](size_t i) { return 21.0f + 3.0f * std::sin(static_cast<float>(i) * 7.27e-5f) + noise[i]; }, exact},
+    };
+
+    std::printf("%zu samples per series at 1 Hz\n", samples);
+    for (const Dataset& dataset : datasets)
+    {
+        runDataset(dataset, samples);
+    }
+    std::printf("uncompressed (int64 ms + float) is 12 bytes/sample: %.2f GiB for 300 sensors x 1 year\n",
+                12.0 * 365.0 * 86400.0 * 300.0 / (1024.0 * 1024.0 * 1024.0));
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "DeviceRegistry.hpp"
+#include "Logger.hpp"
+#include "Timeline.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cost of the timeline instrumentation with recording off and on: an empty
+// span, an instant event and a device table transition (which records an
+// instant while on), then spans from four threads at once and the export
+// of everything recorded as Chrome trace JSON.
+//   timeline_benchmark [events per thread] [json file]
+
+namespace
+{
+
+constexpr size_t THREADS = 4;
+volatile uint64_t sink = 0;
+
+template <typename Body>
+double nanosPerCall(size_t calls, Body body)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < calls; i++)
+    {
+        body(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+struct Results
+{
+    double loop;
+    double span;
+    double instant;
+    double transition;
+};
+
+Results measure(size_t calls, DeviceTable& table)
+{
+    Results results;
+    results.loop = nanosPerCall(calls, [](size_t i) { sink = sink + i; });
+    results.span = nanosPerCall(calls, [](size_t i)
+    {
+        TimelineSpan span("benchmark", "span");
+        sink = sink + i;
+    });
+    results.instant = nanosPerCall(calls, [](size_t i)
+    {
+        TIMELINE_INSTANT("benchmark", "instant", "i", static_cast<int64_t>(i));
+        sink = sink + i;
+    });
+    results.transition = nanosPerCall(calls, [&table](size_t i)
+    {
+        table.transition(static_cast<DeviceHandle>(i % table.size()), [i](DeviceState& state)
+        {
+            state.level = static_cast<uint8_t>(i);
+            return true;
+        });
+    });
+    return results;
+}
+
+void print(const char* label, const Results& results)
+{
+    std::printf("%-14s | loop %5.2f ns | span %6.2f ns | instant %6.2f ns | transition %6.2f ns\n", label,
+                results.loop, results.span, results.instant, results.transition);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    Logger::setLevel(LogCategory::SYSTEM, LogLevel::WARN);
+
+    size_t calls = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::string path = argc > 2 ? argv[2] : "timeline_benchmark.json";
+
+    DeviceTable table(1024, "light change");
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1024; i++)
+    {
+        table.add(i + 1, 0, now);
+    }
+
+    Timeline* timeline = Timeline::getInstance();
+    timeline -> nameThread("benchmark");
+    measure(calls, table);
+    print("recording off", measure(calls, table));
+
+    // Room for every event, so none are dropped. The first recording faults
+    // in the buffer's pages; the second reuses them.
+    timeline -> start(calls * 3);
+    print("first record", measure(calls, table));
+    timeline -> start(calls * 3);
+    print("recording on", measure(calls, table));
+
+    // Every thread records a warm-up pass, then the timed pass into a new
+    // recording of the same size
+    std::atomic<int> phase{0};
+    std::atomic<size_t> finished{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&phase, &finished, calls, t]()
+        {
+            Timeline::getInstance() -> nameThread("benchmark " + std::to_string(t));
+            // Not the shared sink, which would bounce between the cores
+            volatile uint64_t local = 0;
+            for (int pass = 1; pass <= 2; pass++)
+            {
+                while (phase.load() != pass)
+                {
+                    std::this_thread::yield();
+                }
+                for (size_t i = 0; i < calls; i++)
+                {
+                    TimelineSpan span("benchmark", "span");
+                    local = local + i;
+                }
+                finished++;
+            }
+        });
+    }
+
+    timeline -> start(calls);
+    phase = 1;
+    while (finished.load() != THREADS)
+    {
+        std::this_thread::yield();
+    }
+    timeline -> start(calls);
+    auto start = std::chrono::steady_clock::now();
+    phase = 2;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    timeline -> stop();
+    TimelineStatistics statistics = timeline -> getStatistics();
+    std::printf("%zu threads      | %.1f M spans/s in total on %u cores, %llu dropped\n", THREADS,
+                statistics.events / seconds / 1e6, std::thread::hardware_concurrency(),
+                static_cast<unsigned long long>(statistics.dropped));
+
+    std::string error;
+    start = std::chrono::steady_clock::now();
+    if (!timeline -> exportJson(path, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uintmax_t bytes = std::filesystem::file_size(path);
+    std::printf("export         | %llu events in %.0f ms (%.1f M events/s), %.1f MiB\n",
+                static_cast<unsigned long long>(statistics.events), seconds * 1000.0,
+                statistics.events / seconds / 1e6, bytes / (1024.0 * 1024.0));
+
+    std::remove(path.c_str());
+    return 0;
+}
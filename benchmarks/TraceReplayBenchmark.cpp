@@ -0,0 +1,133 @@
+#include "ClimateBlindTask.hpp"
+#include "HomeTopology.hpp"
+#include "LightControlTask.hpp"
+#include "Logger.hpp"
+#include "RuleEngine.hpp"
+#include "SimulationClock.hpp"
+#include "SimulationTrace.hpp"
+#include "TaskManager.hpp"
+#include "TemperatureSensorTask.hpp"
+#include "WindowBlindTask.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Records a simulated week into a trace, then replays it in a fresh process
+// (the devices, rules and sensor state have to start where the recording
+// did). Each phase is a child process running this binary:
+//   trace_replay_benchmark [hours] [trace file]
+//   trace_replay_benchmark simulate|record <hours> <trace file>
+//   trace_replay_benchmark replay <trace file>
+
+namespace
+{
+
+std::vector<Task*> createTasks(TaskManager* taskManager)
+{
+    auto temperature = std::make_unique<TemperatureSensorTask>("Temperature Sensor Task", 1);
+    auto blinds = std::make_unique<WindowBlindTask>("Window Blind Control Task", 2);
+    auto lights = std::make_unique<LightControlTask>("Light Control Task", 3);
+    auto climate = std::make_unique<ClimateBlindTask>("Climate Blind Task", 2);
+    std::vector<Task*> tasks{temperature.get(), blinds.get(), lights.get(), climate.get()};
+
+    taskManager -> addTask(std::move(temperature));
+    taskManager -> addTask(std::move(blinds));
+    taskManager -> addTask(std::move(lights));
+    taskManager -> addTask(std::move(climate));
+    return tasks;
+}
+
+int runPhase(const std::string& phase, double hours, const std::string& path)
+{
+    auto taskManager = TaskManager::getInstance();
+    std::vector<Task*> tasks = createTasks(taskManager);
+    SimulationTrace* trace = SimulationTrace::getInstance();
+    std::string error;
+
+    if (phase == "replay")
+    {
+        ReplayResult result;
+        bool replayed = trace -> replay(path, tasks, [](TraceCommand, int, int) {}, result, error);
+        if (!replayed)
+        {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        std::printf("replay   | %7.2f s | %9.0f steps/s | %9.0f events/s | %.0fx real time | "
+                    "%llu state checks, %llu mismatches\n",
+                    result.seconds, result.steps / result.seconds, result.events / result.seconds,
+                    std::chrono::duration<double>(result.traceDuration).count() / result.seconds,
+                    static_cast<unsigned long long>(result.stateChecks),
+                    static_cast<unsigned long long>(result.mismatches));
+        return result.mismatches == 0 ? 0 : 1;
+    }
+
+    SimulationClock::getInstance() -> enableVirtualTime(std::chrono::system_clock::now());
+    if (phase == "record" && !trace -> startRecording(path, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    taskManager -> runFor(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::ratio<3600>>(hours)));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    trace -> stopRecording();
+
+    std::printf("%-8s | %7.2f s | %9.0f task executions/s\n", phase.c_str(), seconds,
+                taskManager -> getStatistics().completedTaskCount / seconds);
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    Logger::getInstance() -> setConsoleLevel(LogLevel::OFF);
+    for (LogCategory category : {LogCategory::SYSTEM, LogCategory::SCHEDULER, LogCategory::SENSORS,
+                                 LogCategory::BLINDS, LogCategory::LIGHTS})
+    {
+        Logger::setLevel(category, LogLevel::WARN);
+    }
+
+    std::string error;
+    if (!HomeTopology::getInstance() -> loadFile(SMART_HOME_TOPOLOGY_FILE, error) ||
+        !RuleEngine::getInstance() -> loadFile(SMART_HOME_RULES_FILE, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::string phase = argc > 1 ? argv[1] : "";
+    if (phase == "simulate" || phase == "record")
+    {
+        return argc > 3 ? runPhase(phase, std::atof(argv[2]), argv[3]) : 1;
+    }
+    if (phase == "replay")
+    {
+        return argc > 2 ? runPhase(phase, 0.0, argv[2]) : 1;
+    }
+
+    double hours = argc > 1 ? std::atof(argv[1]) : 168.0;
+    std::string path = argc > 2 ? argv[2] : "trace_replay_benchmark.trace";
+    std::string self = std::string("\"") + argv[0] + "\"";
+    std::string hoursArgument = std::to_string(hours);
+
+    std::printf("%.0f h of the default home (4 lights, 3 blinds, temperature sensor)\n", hours);
+    std::fflush(stdout);
+    int status = std::system((self + " simulate " + hoursArgument + " \"" + path + "\"").c_str());
+    status = status != 0 ? status : std::system((self + " record " + hoursArgument + " \"" + path + "\"").c_str());
+
+    std::ifstream recorded(path, std::ios::binary | std::ios::ate);
+    std::printf("trace    | %.2f MiB\n", recorded ? recorded.tellg() / (1024.0 * 1024.0) : 0.0);
+    std::fflush(stdout);
+
+    status = status != 0 ? status : std::system((self + " replay \"" + path + "\"").c_str());
+    std::remove(path.c_str());
+    return status == 0 ? 0 : 1;
+}
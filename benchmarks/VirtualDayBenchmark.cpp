@@ -0,0 +1,118 @@
+#include "TaskManager.hpp"
+#include "SimulationClock.hpp"
+#include "LightControlTask.hpp"
+#include "WindowBlindTask.hpp"
+#include "TemperatureSensorTask.hpp"
+#include "RuleEngine.hpp"
+#include "HomeTopology.hpp"
+#include "DeviceRegistry.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// Simulates a day of home behaviour in virtual time for a generated home of
+// the given number of rooms, each with a light and blinds and the motion and
+// idle rules of config/rules.conf. As in the simulator, one light task and
+// one blinds task drive every room, next to the temperature sensor; all
+// three pass the admission test.
+//   virtual_day_benchmark [rooms] [hours]
+
+namespace
+{
+
+constexpr const char* PROFILES[] = {"living", "bedroom", "kitchen", "bathroom"};
+
+bool writeTopology(const std::string& path, int rooms)
+{
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::fprintf(file, "# Generated by virtual_day_benchmark\n"
+                       "profile living: 7-9 70, 18-23 70, 9-18 30, default 5\n"
+                       "profile bedroom: 6-8 80, 22-1 80, 1-6 20, default 10\n"
+                       "profile kitchen: 7-9 90, 12-14 90, 18-20 90, default 20\n"
+                       "profile bathroom: default 30\n");
+    for (int room = 1; room <= rooms; room++)
+    {
+        std::fprintf(file, "room %d %s light+blinds: Room %d\n", room, PROFILES[room % 4], room);
+    }
+    return std::fclose(file) == 0;
+}
+
+std::string generateRules(int rooms)
+{
+    std::string text = "rule morning-blinds: hour >= 7 and hour <= 9 -> blinds all half_open when closed\n"
+                       "rule night-blinds: hour >= 21 or hour < 6 -> blinds all closed\n"
+                       "rule bright-light: outdoor_light > 90 -> blinds all three_quarters_open when open\n"
+                       "rule late-night-lights: hour >= 1 and hour < 6 -> lights all-except 2 off\n"
+                       "rule evening-lights: hour >= 18 and hour < 20 -> lights 1 on\n";
+    for (int room = 1; room <= rooms; room++)
+    {
+        std::string id = std::to_string(room);
+        text += "rule motion-" + id + ": motion." + id + " > 75 -> lights " + id + " on\n";
+        text += "rule idle-" + id + ": motion." + id + " < 10 and chance." + id + " < 0.1 -> lights " + id + " off\n";
+    }
+    return text;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int rooms = argc > 1 ? std::atoi(argv[1]) : 1000;
+    double hours = argc > 2 ? std::atof(argv[2]) : 24.0;
+
+    SimulationClock::getInstance() -> enableVirtualTime(std::chrono::system_clock::now());
+    auto taskManager = TaskManager::getInstance();
+
+    std::string path = "virtual_day_benchmark.conf";
+    if (!writeTopology(path, rooms))
+    {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        return 1;
+    }
+
+    std::string error;
+    HomeTopology* home = HomeTopology::getInstance();
+    bool loaded = home -> loadFile(path, error);
+    std::remove(path.c_str());
+    if (loaded)
+    {
+        DeviceRegistry::configure(std::max(home -> getLightCount(), DeviceRegistry::DEFAULT_CAPACITY),
+                                  std::max(home -> getBlindCount(), DeviceRegistry::DEFAULT_CAPACITY));
+        loaded = RuleEngine::getInstance() -> loadText(generateRules(rooms), "generated", error);
+    }
+    if (!loaded)
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    size_t admitted = 0;
+    admitted += taskManager -> addTask(std::make_unique<TemperatureSensorTask>("Temperature Sensor Task", 1));
+    admitted += taskManager -> addTask(std::make_unique<WindowBlindTask>("Window Blind Control Task", 2));
+    admitted += taskManager -> addTask(std::make_unique<LightControlTask>("Light Control Task", 3));
+    if (admitted != 3)
+    {
+        std::fprintf(stderr, "Only %zu of 3 tasks passed the admission test\n", admitted);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    taskManager -> runFor(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::ratio<3600>>(hours)));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto stats = taskManager -> getStatistics();
+    size_t roomCount = DeviceRegistry::getInstance() -> getLights().size();
+    std::fprintf(stderr, "Simulated %.1f h for %zu rooms with %zu tasks in %.2f s (%zu task executions, "
+                 "%.0f executions/s)\n", hours, roomCount, admitted, seconds, stats.completedTaskCount,
+                 stats.completedTaskCount / seconds);
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// One argument of a structured log event. Only the raw value is stored; the
+// text is produced later (or never) from the site's registered format.
+struct LogArg
+{
+    enum class Type : uint8_t
+    {
+        INT = 1,
+        FLOAT = 2,
+        DOUBLE = 3,
+        STRING = 4
+    };
+
+    Type type{Type::INT};
+    int64_t intValue{0};
+    double floatValue{0.0};
+    const char* stringValue{nullptr};
+    size_t stringLength{0};
+
+    LogArg() = default;
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    LogArg(T value) : type(Type::INT), intValue(static_cast<int64_t>(value)) {}
+
+    LogArg(float value) : type(Type::FLOAT), floatValue(value) {}
+    LogArg(double value) : type(Type::DOUBLE), floatValue(value) {}
+    LogArg(const char* value) : type(Type::STRING), stringValue(value), stringLength(std::char_traits<char>::length(value)) {}
+    LogArg(const std::string& value) : type(Type::STRING), stringValue(value.data()), stringLength(value.size()) {}
+};
+
+// printf-style formatting of a registered format (%d %u %f %g %s %%) with
+// typed arguments. Shared by the text path and smart_home_logdump.
+std::string formatLogMessage(const char* format, const LogArg* args, size_t argCount);
+
+// Binary structured log ("system.log.bin"). Each log site registers its
+// format once and afterwards only writes the format ID, a delta-encoded
+// steady timestamp and the raw arguments.
+//
+// File layout: "SHLB" magic, u16 version, then records:
+//   0x01 FORMAT  varint id, varint length, bytes
+//   0x02 ANCHOR  i64 steady ns, i64 wall ns (maps steady to wall time)
+//   0x03 EVENT   varint id, zigzag varint timestamp delta, u8 argc, args
+// Arguments are a type byte followed by a zigzag varint (INT), 4-byte
+// float, 8-byte double or varint length + bytes (STRING).
+class BinaryLog
+{
+public:
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr uint8_t RECORD_FORMAT = 0x01;
+    static constexpr uint8_t RECORD_ANCHOR = 0x02;
+    static constexpr uint8_t RECORD_EVENT = 0x03;
+
+private:
+    static BinaryLog* instance;
+
+    std::mutex writeMutex;
+    std::FILE* file{nullptr};
+    std::atomic<bool> opened{false};
+    std::vector<uint8_t> buffer;
+    std::vector<std::string> formats;
+    size_t formatsWritten{0};
+    int64_t lastTimestampNanos{0};
+
+    BinaryLog() = default;
+
+    void writeFormatsLocked();
+    void flushLocked();
+
+public:
+    static BinaryLog* getInstance();
+
+    // Format IDs are process-wide and stable for the life of the process.
+    static uint16_t registerFormat(const char* format);
+    static std::string getFormat(uint16_t formatId);
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    void writeEvent(uint16_t formatId, const LogArg* args, size_t argCount);
+    void flush();
+
+    static void appendVarint(std::vector<uint8_t>& out, uint64_t value);
+    static uint64_t zigzagEncode(int64_t value);
+    static int64_t zigzagDecode(uint64_t value);
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free multi-producer / single-consumer ring buffer (Vyukov
+// style). Every slot carries a sequence number that tells producers whether
+// the slot is free for their ticket and tells the consumer whether the value
+// has been published. Capacity is rounded up to a power of two.
+template <typename T>
+class BoundedMpscQueue
+{
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) std::atomic<size_t> dequeuePosition{0};
+
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    explicit BoundedMpscQueue(size_t requestedCapacity)
+        : slots(new Slot[roundUpToPowerOfTwo(requestedCapacity)]),
+          mask(roundUpToPowerOfTwo(requestedCapacity) - 1)
+    {
+        for (size_t i = 0; i <= mask; i++)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+    BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+    // Safe to call from any number of threads. Returns false when full.
+    bool tryPush(T&& value)
+    {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            Slot& slot = slots[position & mask];
+            size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.value = std::move(value);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single consumer only. Returns false when empty.
+    bool tryPop(T& out)
+    {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if (sequence != position + 1)
+        {
+            return false;
+        }
+
+        out = std::move(slot.value);
+        slot.sequence.store(position + mask + 1, std::memory_order_release);
+        dequeuePosition.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    size_t sizeApprox() const
+    {
+        size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "TaskManager.hpp"
+#include "EventBus.hpp"
+#include "WindowBlindController.hpp"
+#include <string>
+#include <memory>
+
+// Event-driven: lowers the blinds when the room gets too warm. It has no
+// period and is woken only when a temperature reading is published.
+class ClimateBlindTask : public Task
+{
+private:
+    std::string name;
+    int priority;
+    std::shared_ptr<EventSubscription> subscription;
+    DeviceGroup blinds;
+    bool shading{false};
+
+    void onTemperature(float celsius);
+
+public:
+    static constexpr float SHADE_ABOVE_CELSIUS = 25.0f;
+    static constexpr float RELEASE_BELOW_CELSIUS = 22.0f;
+
+    ClimateBlindTask(const std::string& taskName, int taskPriority);
+    ~ClimateBlindTask() override;
+    void execute() override;
+    const std::string& getName() const override;
+    int getPriority() const override;
+    bool isEventDriven() const override;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "DeviceRegistry.hpp"
+#include "SimulationClock.hpp"
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+enum class GroupOutcome
+{
+    CHANGED,
+    UNCHANGED,
+    HELD_BY_COOLDOWN
+};
+
+// What a group command did, by device ID
+struct GroupResult
+{
+    std::vector<int> changed;
+    std::vector<int> heldByCooldown;
+    // Already at the target state
+    size_t unchanged{0};
+    // IDs in the group that are not registered
+    size_t missing{0};
+};
+
+// A named set of devices of one type, such as a floor or a scene's
+// fixtures. Members are kept by device ID, so the group survives devices
+// being removed or moved by a swap-remove; an "all" group simply walks the
+// whole table.
+class DeviceGroup
+{
+private:
+    std::string name;
+    DeviceType type;
+    std::vector<int> deviceIds;
+    bool everyDevice{false};
+    // Skipped by an "all" group
+    std::vector<int> excludedIds;
+
+    bool isExcluded(int deviceId) const
+    {
+        return std::find(excludedIds.begin(), excludedIds.end(), deviceId) != excludedIds.end();
+    }
+
+public:
+    DeviceGroup(const std::string& groupName, DeviceType deviceType, std::vector<int> ids);
+    // Every device of the type, including ones registered later
+    static DeviceGroup all(const std::string& groupName, DeviceType deviceType);
+    // Every device of the type except the given IDs
+    static DeviceGroup allExcept(const std::string& groupName, DeviceType deviceType, std::vector<int> excluded);
+
+    const std::string& getName() const;
+    DeviceType getType() const;
+    size_t size() const;
+
+    // Applies decide(DeviceState&, nowMillis) -> GroupOutcome to every
+    // member in one pass under a single shared table lock. Each device
+    // changes through its own compare-and-swap, so a concurrent writer
+    // simply makes decide() run again for that device. Nothing is logged;
+    // callers emit one aggregated record for the whole group.
+    template <typename Decide>
+    GroupResult apply(Decide decide) const
+    {
+        DeviceRegistry* registry = DeviceRegistry::getInstance();
+        DeviceTable& table = registry -> getTable(type);
+        uint32_t nowMillis = table.toMillis(SimulationClock::getInstance() -> now());
+        GroupResult result;
+
+        std::shared_lock<std::shared_mutex> lock(table.getMutex());
+
+        auto applyOne = [&](DeviceHandle handle)
+        {
+            GroupOutcome outcome = GroupOutcome::UNCHANGED;
+            table.transition(handle, [&](DeviceState& device)
+            {
+                outcome = decide(device, nowMillis);
+                return outcome == GroupOutcome::CHANGED;
+            });
+
+            if (outcome == GroupOutcome::CHANGED)
+            {
+                result.changed.push_back(table.getDeviceId(handle));
+            }
+            else if (outcome == GroupOutcome::HELD_BY_COOLDOWN)
+            {
+                result.heldByCooldown.push_back(table.getDeviceId(handle));
+            }
+            else
+            {
+                result.unchanged++;
+            }
+        };
+
+        if (everyDevice)
+        {
+            DeviceHandle count = static_cast<DeviceHandle>(table.size());
+            result.changed.reserve(count);
+            for (DeviceHandle handle = 0; handle < count; handle++)
+            {
+                if (excludedIds.empty() || !isExcluded(table.getDeviceId(handle)))
+                {
+                    applyOne(handle);
+                }
+            }
+        }
+        else
+        {
+            result.changed.reserve(deviceIds.size());
+            for (int deviceId : deviceIds)
+            {
+                DeviceHandle handle = registry -> findDevice(type, deviceId);
+                if (handle == INVALID_DEVICE_HANDLE)
+                {
+                    result.missing++;
+                    continue;
+                }
+                applyOne(handle);
+            }
+        }
+
+        return result;
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "DeviceRegistry.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Home-wide map from (device type, device ID) to DeviceHandle. Open
+// addressing with linear probing over a fixed power-of-two array of packed
+// 64-bit slots: [type + 1 : 8][device ID : 32][handle : 24]. Lookups are
+// lock-free and retry only if a writer ran concurrently (seqlock); writers
+// serialize on a mutex.
+class DeviceIndex
+{
+public:
+    static constexpr size_t MAX_HANDLES = 1u << 24;
+
+private:
+    static constexpr uint64_t EMPTY_SLOT = 0;
+    static constexpr uint64_t DELETED_SLOT = UINT64_MAX;
+    static constexpr uint64_t HANDLE_MASK = MAX_HANDLES - 1;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    size_t mask;
+    size_t liveCount{0};
+    size_t deletedCount{0};
+    std::atomic<uint64_t> version{0};
+    mutable std::mutex writeMutex;
+
+    static uint64_t makeKey(DeviceType type, int deviceId);
+    static size_t hashKey(uint64_t key);
+    // Slot holding the key, or the end of its probe sequence when absent
+    size_t probe(uint64_t key, bool& found) const;
+    void beginWrite();
+    void endWrite();
+    void purgeDeleted();
+
+public:
+    // Sized for at most maxDevices live entries at half load
+    explicit DeviceIndex(size_t maxDevices);
+
+    // False if the ID is already present or the index is full
+    bool insert(DeviceType type, int deviceId, DeviceHandle handle);
+    // Points an existing ID at a new handle, e.g. after a swap-remove
+    bool update(DeviceType type, int deviceId, DeviceHandle handle);
+    bool erase(DeviceType type, int deviceId);
+    DeviceHandle find(DeviceType type, int deviceId) const;
+    size_t size() const;
+};
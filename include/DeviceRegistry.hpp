@@ -0,0 +1,293 @@
+#pragma once
+
+#include "Metrics.hpp"
+#include "Timeline.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class DeviceType : uint8_t
+{
+    LIGHT,
+    BLIND
+};
+
+// Dense index of a device within its type's table
+using DeviceHandle = uint32_t;
+constexpr DeviceHandle INVALID_DEVICE_HANDLE = UINT32_MAX;
+
+// Device names are stored once and referenced by ID. The text lives in
+// fixed-size blocks that never move, so returned pointers stay valid; a
+// small open-addressing table of IDs finds duplicates.
+class NameTable
+{
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockCapacity{0};
+    size_t blockUsed{0};
+    std::vector<const char*> names;
+    std::vector<uint32_t> slots;
+
+    static uint64_t hash(std::string_view name);
+    void growSlots();
+
+public:
+    uint32_t intern(std::string_view name);
+    // Makes room for count more names of bytes characters in total, so that
+    // interning them allocates nothing further
+    void reserve(size_t count, size_t bytes);
+    const char* get(uint32_t nameId) const;
+    size_t size() const;
+};
+
+// Mutable state of one device, packed into a single 64-bit word so that a
+// reader gets a consistent snapshot with one atomic load:
+// [last change ms : 32][version : 16][level : 8][state : 8]
+struct DeviceState
+{
+    uint8_t state{0};
+    uint8_t level{0};
+    // Incremented by every successful transition; wraps at 16 bits
+    uint16_t version{0};
+    // Milliseconds since the table's epoch, modulo 2^32
+    uint32_t lastChangeMillis{0};
+
+    static DeviceState unpack(uint64_t word)
+    {
+        DeviceState unpacked;
+        unpacked.state = static_cast<uint8_t>(word);
+        unpacked.level = static_cast<uint8_t>(word >> 8);
+        unpacked.version = static_cast<uint16_t>(word >> 16);
+        unpacked.lastChangeMillis = static_cast<uint32_t>(word >> 32);
+        return unpacked;
+    }
+
+    uint64_t pack() const
+    {
+        return static_cast<uint64_t>(lastChangeMillis) << 32 | static_cast<uint64_t>(version) << 16 |
+               static_cast<uint64_t>(level) << 8 | state;
+    }
+
+    // Wrap-safe for intervals shorter than 49 days; DeviceTable keeps idle
+    // devices' stamps within DeviceTable::MAX_TRACKED_AGE of now
+    uint32_t millisSinceChange(uint32_t nowMillis) const
+    {
+        return nowMillis - lastChangeMillis;
+    }
+};
+
+// One device as copied out of its table by a status snapshot
+struct DeviceStatus
+{
+    int32_t deviceId;
+    DeviceState state;
+};
+
+// One device of a bulk registration
+struct DeviceDefinition
+{
+    int32_t deviceId;
+    std::string_view name;
+};
+
+// Struct-of-arrays storage for all devices of one type. Every field lives in
+// its own contiguous array indexed by DeviceHandle, carved out of a single
+// fixed-capacity allocation so that handles and array pointers stay valid.
+//
+// Device state changes through lock-free compare-and-swap transitions and
+// is read with a single atomic load. getMutex() only guards the table's
+// structure: add() and removeAt() hold it exclusively, while rule passes,
+// commands and status reports hold it shared so that their handles stay
+// valid. State writers therefore never block readers or each other.
+class DeviceTable
+{
+private:
+    size_t capacity{0};
+    size_t count{0};
+    std::unique_ptr<int64_t[]> storage;
+    std::chrono::steady_clock::time_point epoch;
+    // Timeline event recorded for every state change
+    const char* changeEventName;
+
+    std::atomic<uint64_t>* stateWords{nullptr};
+    int32_t* deviceIds{nullptr};
+    uint32_t* nameIds{nullptr};
+
+    mutable std::shared_mutex tableMutex;
+    // Bumped by every transition, add and removal
+    std::atomic<uint64_t> changeCount{0};
+    // Transitions only, for metrics; sharded so that concurrent writers
+    // do not contend on it
+    ShardedCounter stateChanges;
+    std::atomic<uint32_t> lastIdleRefreshMillis{0};
+
+public:
+    // A change stamp older than this is moved up to it, so that the 32-bit
+    // millisecond clock of a device left alone for 49 days never wraps
+    // around and makes it look just changed (and held by a cooldown)
+    static constexpr std::chrono::hours MAX_TRACKED_AGE{24 * 7};
+    static constexpr std::chrono::hours IDLE_REFRESH_INTERVAL{1};
+
+    explicit DeviceTable(size_t maxDevices, const char* changeEvent = "device change");
+    DeviceTable(const DeviceTable&) = delete;
+    DeviceTable& operator=(const DeviceTable&) = delete;
+
+    // Returns INVALID_DEVICE_HANDLE when the table is full
+    DeviceHandle add(int deviceId, uint32_t nameId, std::chrono::steady_clock::time_point now);
+    // Swap-remove: the last device moves into the freed handle, keeping
+    // the columns dense
+    void removeAt(DeviceHandle handle);
+    void clear();
+
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    static size_t bytesPerDevice();
+    std::shared_mutex& getMutex() const { return tableMutex; }
+
+    int getDeviceId(DeviceHandle handle) const { return deviceIds[handle]; }
+    uint32_t getNameId(DeviceHandle handle) const { return nameIds[handle]; }
+
+    DeviceState load(DeviceHandle handle) const
+    {
+        return DeviceState::unpack(stateWords[handle].load(std::memory_order_acquire));
+    }
+    uint8_t getState(DeviceHandle handle) const { return load(handle).state; }
+    uint8_t getLevel(DeviceHandle handle) const { return load(handle).level; }
+    uint16_t getVersion(DeviceHandle handle) const { return load(handle).version; }
+
+    // Timestamp in the table's 32-bit millisecond clock
+    uint32_t toMillis(std::chrono::steady_clock::time_point time) const
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - epoch).count());
+    }
+
+    // Applies apply(DeviceState&) atomically: it is called with the current
+    // state, returns false to leave the device unchanged, and is retried if
+    // another writer got there first. On success the version is bumped and
+    // the state before the transition is stored in previous, if given.
+    template <typename Apply>
+    bool transition(DeviceHandle handle, Apply apply, DeviceState* previous = nullptr)
+    {
+        uint64_t word = stateWords[handle].load(std::memory_order_acquire);
+
+        while (true)
+        {
+            DeviceState current = DeviceState::unpack(word);
+            DeviceState next = current;
+
+            if (!apply(next))
+            {
+                return false;
+            }
+
+            next.version = static_cast<uint16_t>(current.version + 1);
+            if (stateWords[handle].compare_exchange_weak(word, next.pack(), std::memory_order_acq_rel,
+                                                         std::memory_order_acquire))
+            {
+                changeCount.fetch_add(1, std::memory_order_release);
+                stateChanges.add();
+                TIMELINE_INSTANT("devices", changeEventName, "device", deviceIds[handle], "level", next.level);
+                if (previous != nullptr)
+                {
+                    *previous = current;
+                }
+                return true;
+            }
+        }
+    }
+
+    // Moves the stamps of devices idle for longer than MAX_TRACKED_AGE up to
+    // that age. Cheap to call often: it walks the table at most once per
+    // IDLE_REFRESH_INTERVAL. Not a state change; the version is kept.
+    void refreshIdleStamps(std::chrono::steady_clock::time_point now);
+
+    // Overwrites a device's state outside of a transition, for restoring
+    // persisted state; the version is still bumped
+    void restore(DeviceHandle handle, DeviceState state);
+
+    // Raw column access for linear rule passes
+    const int32_t* deviceIdData() const { return deviceIds; }
+
+    uint64_t getChangeCount() const { return changeCount.load(std::memory_order_acquire); }
+    uint64_t getStateChangeCount() const { return stateChanges.load(); }
+    // Copies up to maxDevices entries into the caller's buffer under a
+    // shared lock and returns the number of devices in the table, which may
+    // be larger. Never allocates.
+    size_t copyStatus(DeviceStatus* out, size_t maxDevices) const;
+};
+
+// Reusable status copy of one table for polling readers. refresh() skips
+// the copy when no device changed since the last one and otherwise refills
+// the same buffer, so steady polling does not allocate.
+class DeviceSnapshot
+{
+private:
+    std::vector<DeviceStatus> devices;
+    size_t count{0};
+    const DeviceTable* source{nullptr};
+    uint64_t changeCount{0};
+
+public:
+    // Returns false when the snapshot was already current
+    bool refresh(const DeviceTable& table);
+
+    size_t size() const { return count; }
+    const DeviceStatus& operator[](size_t index) const { return devices[index]; }
+    const DeviceStatus* begin() const { return devices.data(); }
+    const DeviceStatus* end() const { return devices.data() + count; }
+    // Table change count the snapshot reflects
+    uint64_t getChangeCount() const { return changeCount; }
+};
+
+class DeviceIndex;
+
+// Home-wide device storage: one table per device type, the interned names
+// and the (type, ID) -> handle index. Handles stay valid until a device is
+// removed; resolve them by ID under a shared table lock when that matters.
+class DeviceRegistry
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+private:
+    static DeviceRegistry* instance;
+
+    DeviceTable lights;
+    DeviceTable blinds;
+    NameTable names;
+    mutable std::mutex namesMutex;
+    std::unique_ptr<DeviceIndex> index;
+
+    DeviceRegistry(size_t lightCapacity, size_t blindCapacity);
+
+public:
+    ~DeviceRegistry();
+    static DeviceRegistry* getInstance();
+    // Sets the table capacities; only valid before the first getInstance()
+    static void configure(size_t lightCapacity, size_t blindCapacity);
+
+    DeviceTable& getTable(DeviceType type);
+    DeviceTable& getLights();
+    DeviceTable& getBlinds();
+
+    // Returns INVALID_DEVICE_HANDLE if the ID is taken or the table is full
+    DeviceHandle registerDevice(DeviceType type, int deviceId, const std::string& name);
+    // Registers many devices under one lock, with the names interned into
+    // one reserved block; skips taken IDs and returns the number added
+    size_t registerDevices(DeviceType type, const DeviceDefinition* devices, size_t count);
+    bool removeDevice(DeviceType type, int deviceId);
+    // Lock-free; O(1) regardless of the number of devices
+    DeviceHandle findDevice(DeviceType type, int deviceId) const;
+    const char* getName(DeviceType type, DeviceHandle handle) const;
+    size_t getNameCount() const;
+};
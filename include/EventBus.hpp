@@ -0,0 +1,206 @@
+#pragma once
+
+#include "BoundedMpscQueue.hpp"
+#include "DeviceRegistry.hpp"
+#include "SimulationClock.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+enum class EventTopic : uint8_t
+{
+    TEMPERATURE_READING,
+    LIGHT_LEVEL,
+    MOTION,
+    DEVICE_STATE_CHANGE,
+    COUNT
+};
+
+struct TemperatureReading
+{
+    float celsius;
+};
+
+// Outdoor light in percent
+struct LightLevelReading
+{
+    float percent;
+};
+
+struct MotionDetected
+{
+    int roomId;
+    float activity;
+};
+
+struct DeviceStateChanged
+{
+    DeviceType type;
+    int deviceId;
+    uint8_t state;
+    uint8_t level;
+};
+
+// One published event: the topic tag, the publish time and the payload.
+// Plain data, so it moves through the subscriber queues by copy.
+struct Event
+{
+    EventTopic topic{EventTopic::TEMPERATURE_READING};
+    std::chrono::steady_clock::time_point publishedAt;
+    union
+    {
+        TemperatureReading temperature;
+        LightLevelReading lightLevel;
+        MotionDetected motion;
+        DeviceStateChanged stateChange;
+    };
+
+    Event() : temperature{0.0f} {}
+
+    template <typename Payload>
+    static constexpr EventTopic topicOf()
+    {
+        if constexpr (std::is_same<Payload, TemperatureReading>::value)
+        {
+            return EventTopic::TEMPERATURE_READING;
+        }
+        else if constexpr (std::is_same<Payload, LightLevelReading>::value)
+        {
+            return EventTopic::LIGHT_LEVEL;
+        }
+        else if constexpr (std::is_same<Payload, MotionDetected>::value)
+        {
+            return EventTopic::MOTION;
+        }
+        else
+        {
+            static_assert(std::is_same<Payload, DeviceStateChanged>::value, "unknown event payload");
+            return EventTopic::DEVICE_STATE_CHANGE;
+        }
+    }
+
+    template <typename Payload>
+    static Event make(const Payload& payload, std::chrono::steady_clock::time_point publishTime)
+    {
+        Event event;
+        event.topic = topicOf<Payload>();
+        event.publishedAt = publishTime;
+
+        if constexpr (std::is_same<Payload, TemperatureReading>::value)
+        {
+            event.temperature = payload;
+        }
+        else if constexpr (std::is_same<Payload, LightLevelReading>::value)
+        {
+            event.lightLevel = payload;
+        }
+        else if constexpr (std::is_same<Payload, MotionDetected>::value)
+        {
+            event.motion = payload;
+        }
+        else
+        {
+            event.stateChange = payload;
+        }
+
+        return event;
+    }
+};
+
+// A subscriber's inbox: a bounded lock-free queue filled by any number of
+// publishers and drained by the subscriber alone. When the inbox is full the
+// event is dropped and counted; publishers never wait for a subscriber.
+class EventSubscription
+{
+private:
+    friend class EventBus;
+
+    std::string name;
+    uint32_t topicMask;
+    BoundedMpscQueue<Event> inbox;
+    // Called after each delivery, e.g. to wake the subscribing task
+    std::function<void()> notify;
+    std::atomic<uint64_t> deliveredCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+
+public:
+    EventSubscription(const std::string& subscriberName, uint32_t topics, size_t capacity,
+                      std::function<void()> onDelivery);
+
+    // Single consumer only. Returns false when the inbox is empty.
+    bool poll(Event& event);
+
+    const std::string& getName() const;
+    bool isSubscribed(EventTopic topic) const;
+    uint64_t getDeliveredCount() const;
+    uint64_t getDroppedCount() const;
+};
+
+// In-process publish/subscribe bus with typed topics. The subscriber lists
+// are an immutable snapshot replaced on (un)subscribe, so a publisher never
+// waits for subscribe() or for a subscriber: it copies the event into the
+// inbox of every subscriber of the topic and then notifies them.
+class EventBus
+{
+public:
+    static constexpr size_t DEFAULT_INBOX_CAPACITY = 256;
+
+    struct SubscriberStatistics
+    {
+        std::string name;
+        uint64_t delivered;
+        uint64_t dropped;
+        size_t queued;
+    };
+
+private:
+    struct SubscriberLists
+    {
+        std::vector<std::shared_ptr<EventSubscription>> byTopic[static_cast<size_t>(EventTopic::COUNT)];
+        std::vector<std::shared_ptr<EventSubscription>> all;
+    };
+
+    static EventBus* instance;
+
+    std::shared_ptr<const SubscriberLists> subscribers;
+    std::mutex subscribeMutex;
+    // Bit per topic with at least one subscriber; publishing to a topic
+    // nobody listens to stops here
+    std::atomic<uint32_t> activeTopics{0};
+    std::atomic<uint64_t> publishedCount{0};
+
+    EventBus();
+    void deliver(const Event& event);
+
+public:
+    static EventBus* getInstance();
+
+    std::shared_ptr<EventSubscription> subscribe(const std::string& subscriberName, std::initializer_list<EventTopic> topics,
+                                                 std::function<void()> onDelivery = {},
+                                                 size_t capacity = DEFAULT_INBOX_CAPACITY);
+    void unsubscribe(const std::shared_ptr<EventSubscription>& subscription);
+
+    // Timestamped with the simulation clock
+    template <typename Payload>
+    void publish(const Payload& payload)
+    {
+        publishedCount.fetch_add(1, std::memory_order_relaxed);
+        if (hasSubscribers(Event::topicOf<Payload>()))
+        {
+            deliver(Event::make(payload, SimulationClock::getInstance() -> now()));
+        }
+    }
+
+    // Lets bulk publishers skip building events nobody listens to
+    bool hasSubscribers(EventTopic topic) const;
+    uint64_t getPublishedCount() const;
+    std::vector<SubscriberStatistics> getStatistics() const;
+};
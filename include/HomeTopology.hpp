@@ -0,0 +1,79 @@
+#pragma once
+
+#include "DeviceRegistry.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Base chance of motion in a room for each hour of the day, in percent
+struct OccupancyProfile
+{
+    std::string name;
+    float hourly[24];
+};
+
+struct HomeRoom
+{
+    int32_t roomId;
+    // Into the name block
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint16_t profile;
+    bool hasLight;
+    bool hasBlinds;
+    // Line in the file, for error messages
+    uint32_t line;
+};
+
+// Rooms of the home and their occupancy profiles, loaded from a topology
+// file at startup:
+//
+//   profile <name>: <from>-<to> <percent>, ..., default <percent>
+//   room <id> <profile> <light|blinds|light+blinds>: <room name>
+//
+// The file is parsed as a stream, a chunk at a time, and validated as a
+// whole before anything is replaced. The rooms are kept sorted by ID in one
+// array, with their names in one block, so that the lights and blinds can
+// be registered with a single bulk call per table and a light's profile is
+// found by binary search when its task first sees it.
+class HomeTopology
+{
+private:
+    static HomeTopology* instance;
+
+    std::string source;
+    std::vector<OccupancyProfile> profiles;
+    std::vector<HomeRoom> rooms;
+    std::string names;
+    size_t lightCount{0};
+    size_t blindCount{0};
+
+    HomeTopology() = default;
+
+    size_t registerDevices(DeviceType type, const char* suffix) const;
+
+public:
+    static constexpr size_t READ_CHUNK = 64 * 1024;
+
+    static HomeTopology* getInstance();
+
+    // Keeps the current topology when the file is invalid
+    bool loadFile(const std::string& path, std::string& error);
+
+    // Registers a light or blinds for every room that has one, named after
+    // the room and with the room's ID
+    size_t createLights() const;
+    size_t createBlinds() const;
+
+    size_t getRoomCount() const { return rooms.size(); }
+    size_t getLightCount() const { return lightCount; }
+    size_t getBlindCount() const { return blindCount; }
+    const std::string& getSource() const { return source; }
+    std::string_view getRoomName(const HomeRoom& room) const;
+
+    // The hourly motion chances of a room; all zero for a room that is not
+    // in the topology
+    const float* getOccupancy(int roomId) const;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Fixed-bucket log-linear histogram of nanosecond values. Each power of two
+// is split into 16 linear sub-buckets, so any reported percentile is within
+// 1/16 (6.25%) of the recorded value while the layout stays a flat array.
+//
+// record() uses relaxed load/store pairs instead of read-modify-write
+// instructions: a histogram has a single writer at a time (the thread
+// executing the owning task), and readers only need a recent value.
+class LatencyHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    struct Summary
+    {
+        uint64_t count;
+        uint64_t p50;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
+        double mean;
+    };
+
+    void record(uint64_t valueNanos)
+    {
+        bump(buckets[bucketIndex(valueNanos)], 1);
+        bump(count, 1);
+        bump(sum, valueNanos);
+
+        if (valueNanos > maxValue.load(std::memory_order_relaxed))
+        {
+            maxValue.store(valueNanos, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t getCount() const;
+    uint64_t percentile(double quantile) const;
+    Summary summarize() const;
+
+    static int bucketIndex(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+        {
+            return static_cast<int>(value);
+        }
+
+        int exponent = highestSetBit(value);
+        int shift = exponent - SUB_BUCKET_BITS;
+        int subBucket = static_cast<int>((value >> shift) & (SUB_BUCKETS - 1));
+        return (shift + 1) * SUB_BUCKETS + subBucket;
+    }
+
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static int highestSetBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+};
@@ -2,31 +2,50 @@
 
 #include "TaskManager.hpp"
 #include "LightController.hpp"
-#include <memory>
+#include "RandomService.hpp"
+#include "RuleEngine.hpp"
 #include <string>
 #include <chrono>
 #include <vector>
 
 class LightControlTask : public Task {
 private:
-    std::vector<std::unique_ptr<LightController>> controllers;
+    DeviceTable& lights;
     std::string name;
     int priority;
-    std::chrono::steady_clock::time_point lastExecuted;
+    Xoshiro256pp rng;
+    // Room IDs copied under the table lock, so that the rule engine, which
+    // takes the table locks while it holds its own, is called without it
+    std::vector<int32_t> roomIds;
+    // Per-pass random samples, one per light, drawn in a single batch
+    std::vector<float> motionNoise;
+    std::vector<float> motionLevels;
+    std::vector<float> inactivityDraws;
 
-    float simulateMotion(int roomId) const;
+    // motion.<room> and chance.<room> rule inputs, two per light, and the
+    // room's occupancy profile
+    RuleInputId hourInput;
+    std::vector<int> inputRooms;
+    std::vector<RuleInputId> roomInputs;
+    std::vector<const float*> roomOccupancy;
+    std::vector<float> inputValues;
 
-    void applyTimeBasedRules();
-    void applyMotionBasedRules();
+    void updateMotionInputs();
 
 public:
     LightControlTask(const std::string& taskName, int taskPriority);
     void execute() override;
     const std::string& getName() const override;
     int getPriority() const override;
+    std::chrono::milliseconds getPeriod() const override;
+    std::chrono::milliseconds getWcetBudget() const override;
 
     bool setLight(int roomId, bool on);
     bool setBrightness(int roomId, LightBrightness level);
 
-    std::vector<std::pair<int, std::string>> getStatusReport() const;
+    // Refreshes the caller's snapshot of the lights; false if it was current
+    bool getStatusSnapshot(DeviceSnapshot& snapshot) const;
+    // Text form of one entry, written like snprintf; kept apart from the
+    // snapshot so that polling readers only pay for it when they print
+    static int formatStatus(const DeviceStatus& status, char* buffer, size_t size);
 };
\ No newline at end of file
@@ -1,10 +1,9 @@
 #pragma once
 
-#include "Sensor.hpp"
+#include "DeviceGroup.hpp"
+#include "DeviceRegistry.hpp"
 #include <string>
-#include <mutex>
-#include <vector>
-#include <memory>
+#include <chrono>
 
 enum class LightState
 {
@@ -21,25 +20,52 @@ enum class LightBrightness
     FULL = 100
 };
 
-class LightController : public Sensor
+// Lightweight view of one light in the DeviceRegistry. Copies are cheap and
+// all state lives in the registry's light table.
+class LightController
 {
 private:
-    LightState state;
-    LightBrightness brightness;
-    int roomId;
-    static std::vector<LightController*> allLights;
+    DeviceTable* table;
+    DeviceHandle handle;
+
+    // DEVICE_STATE_CHANGE events for the event bus
+    static void publishStateChange(const DeviceTable& lights, DeviceHandle handle);
+    static void publishGroupChange(const GroupResult& result, LightState state, LightBrightness level);
 
 public:
-    explicit LightController(const std::string& controllerName, int id);
-    float readValue() override;
+    LightController(DeviceTable& lights, DeviceHandle lightHandle);
+
+    // Registers a new light in the home-wide registry
+    static LightController create(const std::string& controllerName, int id);
+
+    float readValue() const;
     bool turnOn();
     bool turnOff();
     bool setBrightness(LightBrightness level);
     LightState getState() const;
     LightBrightness getBrightness() const;
     int getRoomId() const;
+    DeviceHandle getHandle() const;
+    const char* getName() const;
     std::string getBrightnessName() const;
 
-    static void turnOnAllLights();
-    static void turnOffAllLights();
-};
\ No newline at end of file
+    // Transitions for callers that already hold the table lock (shared is
+    // enough), such as rule passes that lock once and walk the table
+    // linearly. Each is a single compare-and-swap on the device's state
+    // word, e.g. turnOnLocked only succeeds if the light is currently OFF.
+    static bool turnOnLocked(DeviceTable& lights, DeviceHandle handle, std::chrono::steady_clock::time_point now);
+    static bool turnOffLocked(DeviceTable& lights, DeviceHandle handle, std::chrono::steady_clock::time_point now);
+    static bool setBrightnessLocked(DeviceTable& lights, DeviceHandle handle, LightBrightness level,
+                                    std::chrono::steady_clock::time_point now);
+    static const char* getBrightnessName(LightBrightness level);
+
+    // Group commands: one pass over the group and one aggregated log record
+    // instead of a line per light. turnOnGroup leaves lights that are
+    // already on at their current brightness.
+    static GroupResult turnOnGroup(const DeviceGroup& group);
+    static GroupResult turnOffGroup(const DeviceGroup& group);
+    static GroupResult setGroupBrightness(const DeviceGroup& group, LightBrightness level);
+
+    static GroupResult turnOnAllLights();
+    static GroupResult turnOffAllLights();
+};
@@ -4,19 +4,181 @@
 #include <mutex>
 #include <fstream>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include "BoundedMpscQueue.hpp"
+#include "BinaryLog.hpp"
+#include "SegmentedLogWriter.hpp"
+
+enum class LogLevel : uint8_t
+{
+    TRACE,
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+};
+
+enum class LogCategory : uint8_t
+{
+    SYSTEM,
+    SCHEDULER,
+    SENSORS,
+    BLINDS,
+    LIGHTS,
+    COUNT
+};
+
+// Statements below this level are compiled out entirely; Release builds
+// set it to INFO (2) from CMake.
+#ifndef SMART_HOME_MIN_LOG_LEVEL
+#define SMART_HOME_MIN_LOG_LEVEL 0
+#endif
+
+enum class OverflowPolicy
+{
+    BLOCK,          // producers wait for free space
+    DROP,           // records that do not fit are discarded silently
+    COUNT_DROPS     // records are discarded and the loss is reported in the log
+};
 
 class Logger {
     private:
+    struct LogRecord
+    {
+        std::chrono::system_clock::time_point timestamp;
+        bool toConsole;
+        std::string message;
+    };
+
     static Logger* instance;
+    // Runtime threshold per category, read with a single relaxed load by
+    // the logging macros before any argument is evaluated.
+    static std::atomic<uint8_t> categoryLevels[static_cast<size_t>(LogCategory::COUNT)];
+    std::atomic<uint8_t> consoleLevel{static_cast<uint8_t>(LogLevel::INFO)};
     std::mutex logMutex;
     std::ofstream logFile;
+    SegmentedLogWriter segments;
     bool consoleOutput;
 
+    // Asynchronous mode: producers enqueue records, the writer thread formats
+    // and writes them in batches.
+    std::unique_ptr<BoundedMpscQueue<LogRecord>> asyncQueue;
+    std::atomic<bool> asyncEnabled{false};
+    std::atomic<bool> writerRunning{false};
+    std::atomic<bool> writerWaiting{false};
+    OverflowPolicy overflowPolicy{OverflowPolicy::BLOCK};
+    std::thread writerThread;
+    std::mutex writerMutex;
+    std::condition_variable writerCV;
+    std::condition_variable flushedCV;
+    std::atomic<uint64_t> enqueuedCount{0};
+    std::atomic<uint64_t> writtenCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+    uint64_t reportedDrops{0};
+
+    std::atomic<bool> binaryOutput{false};
+    uint16_t plainMessageFormat;
+
+    std::time_t cachedSecond{-1};
+    char cachedTimestamp[32]{};
+
     Logger();
 
+    const char* formatTimestamp(std::chrono::system_clock::time_point timestamp);
+    void writeEntry(std::chrono::system_clock::time_point timestamp, const std::string& message, bool toConsole);
+    void writerLoop();
+    void wakeWriter();
+    void logEventPacked(uint16_t formatId, bool toConsole, const char* format, const LogArg* args, size_t argCount);
+
 public:
     static Logger* getInstance();
     void log(const std::string& message, bool toConsole = false);
     void setConsoleOutput(bool enabled);
+
+    static bool isEnabled(LogLevel level, LogCategory category)
+    {
+        return static_cast<uint8_t>(level) >=
+               categoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(LogLevel level);
+    static void setLevel(LogCategory category, LogLevel level);
+    static LogLevel getLevel(LogCategory category);
+    static const char* getLevelName(LogLevel level);
+    static const char* getCategoryName(LogCategory category);
+    static bool parseLevel(const std::string& name, LogLevel& level);
+    static bool parseCategory(const std::string& name, LogCategory& category);
+
+    // Enabled messages at or above this level are echoed to the console
+    void setConsoleLevel(LogLevel level);
+
+    // Structured log event from a site with a registered format; use the
+    // LOG_* macros rather than calling this directly. In binary mode only
+    // the raw arguments are recorded, otherwise the text is formatted here.
+    template <typename... Args>
+    void logEvent(uint16_t formatId, LogLevel level, const char* format, const Args&... args)
+    {
+        LogArg packed[] = {LogArg(args)..., LogArg()};
+        bool toConsole = static_cast<uint8_t>(level) >= consoleLevel.load(std::memory_order_relaxed);
+        logEventPacked(formatId, toConsole, format, packed, sizeof...(Args));
+    }
+
+    // Records every message to the binary log instead of system.log;
+    // decode it with smart_home_logdump.
+    bool enableBinaryOutput(const std::string& path = "system.log.bin");
+
+    // Replaces system.log with rotating memory-mapped segments; shutdown()
+    // closes the current segment.
+    bool enableSegmentedOutput(const SegmentOptions& options = SegmentOptions());
+
+    // Switches to asynchronous logging through a bounded MPSC ring buffer
+    // of the given capacity. flush() waits until everything enqueued so far
+    // has been written; shutdown() flushes and returns to synchronous mode.
+    void enableAsync(size_t capacity = 8192, OverflowPolicy policy = OverflowPolicy::BLOCK);
+    void flush();
+    void shutdown();
+    bool isAsync() const;
+    uint64_t getDroppedCount() const;
     ~Logger();
 };
+
+constexpr LogLevel compiledMinimumLogLevel = static_cast<LogLevel>(SMART_HOME_MIN_LOG_LEVEL);
+
+constexpr bool isLogLevelCompiledIn(LogLevel level)
+{
+    return level >= compiledMinimumLogLevel;
+}
+
+template <typename... Args>
+constexpr const char* logFormatOf(const char* format, const Args&...)
+{
+    return format;
+}
+
+// LOG_INFO(CATEGORY, "printf-style format", args...): the arguments are only
+// evaluated when the level is enabled for the category. The format is
+// registered once per call site and the raw arguments are logged.
+#define LOG_AT(level, category, ...) \
+    do \
+    { \
+        if constexpr (isLogLevelCompiledIn(level)) \
+        { \
+            if (Logger::isEnabled(level, category)) \
+            { \
+                static const uint16_t logFormatId = BinaryLog::registerFormat(logFormatOf(__VA_ARGS__)); \
+                Logger::getInstance() -> logEvent(logFormatId, level, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_TRACE(category, ...) LOG_AT(LogLevel::TRACE, LogCategory::category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) LOG_AT(LogLevel::DEBUG, LogCategory::category, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG_AT(LogLevel::INFO, LogCategory::category, __VA_ARGS__)
+#define LOG_WARN(category, ...) LOG_AT(LogLevel::WARN, LogCategory::category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LogLevel::ERROR, LogCategory::category, __VA_ARGS__)
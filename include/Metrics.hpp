@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Task;
+class DeviceTable;
+
+// Monotonic counter split into cache-line-sized shards. Each thread adds to
+// the shard it was handed on first use, so counting from several threads
+// never bounces one cache line between them. A read sums the shards without
+// a lock and may miss adds still in flight.
+class ShardedCounter
+{
+public:
+    static constexpr size_t SHARDS = 16;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static std::atomic<size_t> nextShard;
+    Shard shards[SHARDS];
+
+    static size_t threadShard()
+    {
+        thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+        return shard;
+    }
+
+public:
+    void add(uint64_t amount = 1)
+    {
+        shards[threadShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    uint64_t load() const;
+};
+
+// System-wide counters and the sources of the per-task and per-device ones,
+// rendered in the Prometheus text format. Rendering reads only atomics: it
+// never takes the scheduler's taskMutex or a device table's mutex, so a
+// scrape cannot stall a task or a device change.
+class Metrics
+{
+private:
+    static Metrics* instance;
+
+    // Guards the lists below, which only grow; tasks and tables are never
+    // destroyed while the process runs
+    mutable std::mutex sourcesMutex;
+    std::vector<const Task*> tasks;
+    std::vector<std::pair<std::string, const DeviceTable*>> deviceTables;
+
+    Metrics() = default;
+
+public:
+    ShardedCounter logRecords;
+    // Every record the asynchronous logger discarded, whatever its overflow
+    // policy; the logger's own drop count covers COUNT_DROPS only
+    ShardedCounter logRecordsDropped;
+    ShardedCounter blindsCooldownRejections;
+
+    static Metrics* getInstance();
+
+    void registerTask(const Task* task);
+    void registerDeviceTable(const std::string& type, const DeviceTable* table);
+
+    // Text exposition format 0.0.4; out is cleared first
+    void render(std::string& out) const;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Serves the Metrics in the Prometheus text format at
+// http://127.0.0.1:<port>/metrics. One thread accepts and answers the
+// scrapes one at a time; it only reads counters, so a slow scraper can
+// delay other scrapers but never the scheduler.
+class MetricsServer
+{
+private:
+    static MetricsServer* instance;
+
+    // A SOCKET on Windows, a file descriptor elsewhere
+    intptr_t listener{-1};
+    uint16_t port{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> scrapes{0};
+    std::thread server;
+
+    MetricsServer() = default;
+
+    void run();
+    void serve(intptr_t connection, std::string& body, std::string& response);
+
+public:
+    // Stop checks while waiting for a connection
+    static constexpr int POLL_MILLIS = 200;
+    // A scraper that sends nothing for this long is dropped
+    static constexpr int RECEIVE_TIMEOUT_MILLIS = 2000;
+
+    static MetricsServer* getInstance();
+
+    // Binds to the loopback interface only; port 0 picks a free port
+    bool start(uint16_t listenPort, std::string& error);
+    void stop();
+
+    bool isRunning() const { return server.joinable(); }
+    uint16_t getPort() const { return port; }
+    uint64_t getScrapeCount() const { return scrapes.load(std::memory_order_relaxed); }
+};
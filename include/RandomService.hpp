@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+// xoshiro256++ (Blackman & Vigna): 32 bytes of state, a few cycles per
+// 64-bit output. Satisfies UniformRandomBitGenerator, so it also works with
+// the <random> distributions.
+class Xoshiro256pp
+{
+private:
+    uint64_t state[4];
+    // Second Box-Muller variate, returned by the next normal() call
+    float spareNormal{0.0f};
+    bool hasSpareNormal{false};
+
+    static uint64_t rotl(uint64_t value, int shift)
+    {
+        return (value << shift) | (value >> (64 - shift));
+    }
+
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256pp(uint64_t seed = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+        uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    // Uniform in [0, 1) from the top 24 bits
+    float nextFloat()
+    {
+        return static_cast<float>((*this)() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    float uniform(float low, float high)
+    {
+        return low + (high - low) * nextFloat();
+    }
+
+    // Uniform integer in [low, high]
+    int uniformInt(int low, int high);
+
+    float normal(float mean, float stddev);
+
+    // Batched variates for rule passes that sample every device at once
+    void fillUniform(float* out, size_t count, float low, float high);
+    void fillNormal(float* out, size_t count, float mean, float stddev);
+};
+
+// Deterministic source of simulation randomness. Every consumer draws from
+// its own named stream, seeded from the master seed and the stream name, so
+// a run is reproduced exactly by its seed regardless of thread timing.
+class RandomService
+{
+private:
+    static RandomService* instance;
+    uint64_t masterSeed;
+
+    RandomService();
+
+public:
+    static RandomService* getInstance();
+
+    // Affects streams created afterwards
+    void setMasterSeed(uint64_t seed);
+    uint64_t getMasterSeed() const;
+
+    Xoshiro256pp createStream(const std::string& streamName) const;
+
+    static uint64_t splitMix64(uint64_t& state);
+};
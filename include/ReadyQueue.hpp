@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class Task;
+
+// RTOS-style ready structure: one FIFO list per priority level plus a bitmap
+// of non-empty levels. The highest ready priority is found with a single
+// count-leading-zeros, so push, remove and pop are all O(1).
+class ReadyQueue
+{
+public:
+    static constexpr int PRIORITY_LEVELS = 64;
+
+    static int clampPriority(int priority);
+
+    void push(Task* task);
+    void remove(Task* task);
+    Task* popHighest();
+    Task* peekHighest() const;
+
+    bool empty() const;
+    size_t size() const;
+    void clear();
+
+private:
+    struct Level
+    {
+        Task* head{nullptr};
+        Task* tail{nullptr};
+    };
+
+    std::array<Level, PRIORITY_LEVELS> levels{};
+    uint64_t readyBitmap{0};
+    size_t count{0};
+
+    static int highestSetBit(uint64_t bitmap);
+};
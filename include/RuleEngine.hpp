@@ -0,0 +1,158 @@
+#pragma once
+
+#include "DeviceGroup.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Set by the build to the rule file in the source tree
+#ifndef SMART_HOME_RULES_FILE
+#define SMART_HOME_RULES_FILE "config/rules.conf"
+#endif
+
+// Index of a named rule input such as "hour" or "motion.2"
+using RuleInputId = uint32_t;
+
+enum class CompareOp : uint8_t
+{
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    EQUAL,
+    NOT_EQUAL
+};
+
+struct RuleComparison
+{
+    RuleInputId input;
+    CompareOp op;
+    float threshold;
+};
+
+enum class RuleCommand : uint8_t
+{
+    LIGHT_ON,
+    LIGHT_OFF,
+    BLIND_POSITION
+};
+
+struct RuleAction
+{
+    RuleCommand command{RuleCommand::LIGHT_ON};
+    // Target position for BLIND_POSITION
+    uint8_t level{0};
+    // "when <state>": only devices currently in that light state or blind
+    // position are changed
+    bool guarded{false};
+    uint8_t guardValue{0};
+};
+
+// One compiled rule: the condition is an OR of AND-clauses over inputs
+struct Rule
+{
+    std::string name;
+    std::vector<std::vector<RuleComparison>> clauses;
+    DeviceGroup targets;
+    RuleAction action;
+    int line;
+};
+
+// The compiled rule set. dependents[input] lists, in file order, the rules
+// whose condition reads that input.
+struct RuleSet
+{
+    std::string source;
+    std::vector<Rule> rules;
+    std::vector<std::vector<uint32_t>> dependents;
+};
+
+// Automation rules loaded from a config file, one per line:
+//
+//   rule <name>: <condition> -> <lights|blinds> <targets> <command> [when <state>]
+//
+// e.g. "rule morning: hour >= 7 and hour <= 9 -> blinds all half_open when closed".
+// Tasks feed inputs with setInput(); a change marks only the rules that read
+// that input, and evaluate() runs just those. A rule fires every time it is
+// evaluated with a true condition; its action is idempotent, so firing again
+// changes nothing. Rules whose devices were held by a cooldown stay pending
+// for the next evaluate().
+class RuleEngine
+{
+public:
+    struct RuleStatistics
+    {
+        std::string name;
+        uint64_t evaluations;
+        uint64_t firings;
+    };
+
+    struct Statistics
+    {
+        std::string source;
+        size_t inputs;
+        uint64_t inputChanges;
+        uint64_t evaluations;
+        uint64_t firings;
+        uint64_t reloads;
+        std::vector<RuleStatistics> rules;
+    };
+
+private:
+    static RuleEngine* instance;
+
+    mutable std::mutex engineMutex;
+    std::unordered_map<std::string, RuleInputId> inputIds;
+    std::vector<std::string> inputNames;
+    std::vector<float> inputValues;
+    // Inputs never set make every comparison on them false
+    std::vector<uint8_t> inputKnown;
+
+    std::shared_ptr<const RuleSet> ruleSet;
+    std::vector<uint8_t> pending;
+    std::vector<uint32_t> pendingRules;
+    std::vector<uint32_t> evaluationBatch;
+    std::vector<uint64_t> ruleEvaluations;
+    std::vector<uint64_t> ruleFirings;
+
+    uint64_t inputChanges{0};
+    uint64_t evaluations{0};
+    uint64_t firings{0};
+    uint64_t reloads{0};
+
+    RuleEngine();
+    void setInputLocked(RuleInputId input, float value);
+    void markPendingLocked(uint32_t rule);
+    bool conditionHolds(const Rule& rule) const;
+    bool fire(const Rule& rule);
+    bool compile(const std::string& text, const std::string& source, RuleSet& compiled, std::string& error);
+
+public:
+    static RuleEngine* getInstance();
+
+    // Replaces the rule set. The new set is compiled off to the side and
+    // swapped in between two evaluations, so tasks keep running; on a syntax
+    // error the old rules stay active and error names the line.
+    bool loadFile(const std::string& path, std::string& error);
+    bool loadText(const std::string& text, const std::string& source, std::string& error);
+    // Reloads from the file the current rules came from
+    bool reload(std::string& error);
+
+    RuleInputId getInput(const std::string& inputName);
+    // No-op when the value is unchanged; otherwise marks its dependents
+    void setInput(RuleInputId input, float value);
+    // Same, for a pass that updates many inputs at once under one lock
+    void setInputs(const RuleInputId* inputs, const float* values, size_t count);
+    // Evaluates the pending rules in file order and fires those that hold.
+    // Returns the number of rules evaluated.
+    size_t evaluate();
+    // Makes every rule pending, e.g. after devices were changed by hand
+    void invalidateAll();
+
+    size_t getRuleCount() const;
+    Statistics getStatistics() const;
+};
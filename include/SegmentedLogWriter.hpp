@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+struct SegmentOptions
+{
+    // Segments are named <baseName>.<index><extension>, e.g. system.000003.log
+    std::string baseName{"system"};
+    std::string extension{".log"};
+    size_t segmentSize{64u << 20};
+    // Zero disables time-based rollover
+    std::chrono::seconds maxSegmentAge{3600};
+    // Older segments beyond this count are deleted on rollover
+    size_t retainedSegments{8};
+};
+
+// Log sink writing into preallocated, memory-mapped segment files of a fixed
+// size. Appending is a memcpy into the mapping; the kernel writes pages back
+// on its own, so there is no syscall per line. A segment is truncated to its
+// used length when it is closed (after a crash its tail stays zero-filled).
+// Not thread-safe: the Logger serializes calls.
+//
+// Windows has no mmap here and falls back to buffered stdio with the same
+// naming, rollover and retention.
+class SegmentedLogWriter
+{
+private:
+    SegmentOptions options;
+    uint64_t segmentIndex{0};
+    size_t writeOffset{0};
+    std::chrono::system_clock::time_point segmentOpenedAt;
+    bool opened{false};
+
+#ifdef _WIN32
+    std::FILE* file{nullptr};
+#else
+    int fd{-1};
+    char* mapping{nullptr};
+#endif
+
+    std::string segmentPath(uint64_t index) const;
+    uint64_t findLastSegmentIndex() const;
+    bool openSegment(std::chrono::system_clock::time_point now);
+    void closeSegment();
+    void removeExpiredSegments();
+
+public:
+    SegmentedLogWriter() = default;
+    SegmentedLogWriter(const SegmentedLogWriter&) = delete;
+    SegmentedLogWriter& operator=(const SegmentedLogWriter&) = delete;
+    ~SegmentedLogWriter();
+
+    // Continues numbering after the highest existing segment
+    bool open(const SegmentOptions& segmentOptions, std::chrono::system_clock::time_point now);
+    void close();
+    bool isOpen() const;
+
+    // Appends the parts as one contiguous record, rolling over first when
+    // the record does not fit or the segment is too old. Records longer
+    // than a segment are truncated.
+    void append(std::chrono::system_clock::time_point now, std::initializer_list<std::string_view> parts);
+
+    // Schedules write-back of dirty pages without waiting for it
+    void flush();
+
+    uint64_t getSegmentIndex() const;
+    std::string getSegmentPath() const;
+};
@@ -15,12 +15,3 @@ public:
     virtual float readValue() = 0;
     const std::string& getName() const;
 };
-
-class TemperatureSensor : public Sensor {
-private:
-    static float lastReading;
-public:
-    explicit TemperatureSensor(const std::string& sensorName);
-    float readValue() override;
-    static float getLastReading();
-};
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class SensorAlert
+{
+    NORMAL,
+    HIGH,
+    LOW
+};
+
+// Hysteresis bands on the smoothed value: an alert is raised past the
+// "above"/"below" limit and cleared only once the value is back past the
+// matching "clear" limit, so noise around a limit cannot make it flap
+struct AlertBands
+{
+    float highAbove;
+    float highClearBelow;
+    float lowBelow;
+    float lowClearAbove;
+};
+
+// Everything a query needs, kept current by update()
+struct SensorSummary
+{
+    std::string name;
+    float latest{0.0f};
+    // Arithmetic mean over the window
+    double windowAverage{0.0};
+    double ewma{0.0};
+    float windowMin{0.0f};
+    float windowMax{0.0f};
+    // Least-squares slope over the window, per hour
+    double ratePerHour{0.0};
+    size_t windowSamples{0};
+    uint64_t totalSamples{0};
+    SensorAlert alert{SensorAlert::NORMAL};
+    uint64_t alertChanges{0};
+    std::chrono::steady_clock::time_point updatedAt;
+};
+
+// Sliding-window aggregates of one sensor, maintained in amortized O(1) per
+// sample: running sums over the samples in the window for the average and
+// the trend line, monotonic deques for its minimum and maximum, and a
+// time-aware EWMA. The summary is refreshed on every update, so reading it
+// is a copy, not a recomputation.
+class StreamingStatistics
+{
+private:
+    struct Sample
+    {
+        std::chrono::steady_clock::time_point time;
+        float value;
+    };
+
+    std::string name;
+    std::chrono::steady_clock::duration window;
+    std::chrono::steady_clock::duration ewmaTimeConstant;
+    bool alertsEnabled{false};
+    AlertBands bands{};
+
+    std::deque<Sample> samples;
+    // Candidates for the window minimum, values increasing front to back;
+    // maxima decreasing
+    std::deque<Sample> minimums;
+    std::deque<Sample> maximums;
+    double windowSum{0.0};
+    // Running sums for the trend line; t in seconds since timeOrigin, which
+    // is moved forward as samples leave so that the sums stay small
+    std::chrono::steady_clock::time_point timeOrigin;
+    double sumT{0.0};
+    double sumTT{0.0};
+    double sumTV{0.0};
+
+    SensorSummary summary;
+    mutable std::mutex statisticsMutex;
+
+    double secondsSinceOrigin(std::chrono::steady_clock::time_point time) const;
+    void rebaseTime(std::chrono::steady_clock::time_point origin);
+    void evictBefore(std::chrono::steady_clock::time_point cutoff);
+    void updateAlert();
+
+public:
+    StreamingStatistics(const std::string& sensorName, std::chrono::steady_clock::duration windowLength,
+                        std::chrono::steady_clock::duration ewmaTimeConstantLength);
+
+    void setAlertBands(const AlertBands& alertBands);
+    // Returns the alert state after the sample
+    SensorAlert update(std::chrono::steady_clock::time_point time, float value);
+    SensorSummary getSummary() const;
+    // Carries the EWMA, the alert state and the counters over from a saved
+    // summary; the window starts empty
+    void restore(const SensorSummary& saved);
+
+    static const char* getAlertName(SensorAlert alert);
+};
+
+// Named per-sensor statistics, created on first use
+class SensorMonitor
+{
+private:
+    static SensorMonitor* instance;
+
+    std::unordered_map<std::string, std::unique_ptr<StreamingStatistics>> sensors;
+    std::vector<StreamingStatistics*> ordered;
+    mutable std::mutex monitorMutex;
+
+    SensorMonitor() = default;
+
+public:
+    static constexpr std::chrono::minutes DEFAULT_WINDOW{15};
+    static constexpr std::chrono::minutes DEFAULT_EWMA_TIME_CONSTANT{5};
+
+    static SensorMonitor* getInstance();
+
+    // Statistics live as long as the monitor, so the reference can be cached
+    StreamingStatistics& getSensor(const std::string& sensorName);
+    std::vector<SensorSummary> getSummaries() const;
+};
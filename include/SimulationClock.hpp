@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+// Single source of time for the simulation. In real mode it forwards to
+// steady_clock/system_clock. In virtual mode time only moves when the
+// scheduler advances it, which lets a simulated day run in seconds.
+class SimulationClock
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+    using WallTimePoint = std::chrono::system_clock::time_point;
+
+private:
+    static SimulationClock* instance;
+
+    std::atomic<bool> virtualMode{false};
+    TimePoint steadyOrigin;
+    WallTimePoint wallOrigin;
+    std::atomic<int64_t> virtualOffsetNanos{0};
+
+    SimulationClock() = default;
+
+public:
+    static SimulationClock* getInstance();
+
+    // Switches to virtual time starting at the given wall-clock time. The
+    // steady timeline continues from the current real steady time.
+    void enableVirtualTime(WallTimePoint startWallTime);
+    void disableVirtualTime();
+    bool isVirtual() const;
+
+    TimePoint now() const;
+    WallTimePoint wallNow() const;
+    std::tm localTime() const;
+    int localHour() const;
+
+    // Virtual mode only; never moves time backwards.
+    void advanceTo(TimePoint target);
+    void advanceBy(std::chrono::nanoseconds delta);
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "DeviceRegistry.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Task;
+
+// Random or operator-supplied values a task pass consumes
+enum class TraceInput : uint8_t
+{
+    TEMPERATURE,
+    TEMPERATURE_READING,
+    OUTDOOR_LIGHT,
+    MOTION,
+    INACTIVITY
+};
+
+// Operator commands that change devices or rules
+enum class TraceCommand : uint8_t
+{
+    SET_LIGHT,
+    SET_BRIGHTNESS,
+    SET_BLINDS,
+    ALL_LIGHTS_ON,
+    ALL_LIGHTS_OFF,
+    OPEN_ALL_BLINDS,
+    CLOSE_ALL_BLINDS,
+    RELOAD_RULES
+};
+
+struct ReplayResult
+{
+    uint64_t steps{0};
+    uint64_t commands{0};
+    uint64_t inputs{0};
+    // Steps, input samples and state records
+    uint64_t events{0};
+    uint64_t stateChecks{0};
+    uint64_t mismatches{0};
+    // Step number and trace time of the first mismatch
+    uint64_t firstMismatchStep{0};
+    std::chrono::nanoseconds firstMismatchOffset{0};
+    std::chrono::nanoseconds traceDuration{0};
+    double seconds{0.0};
+};
+
+// Record and replay of a run. A trace is a sequence of steps, each a task
+// pass or an operator command with its time since the start of the trace.
+// A step is followed by the inputs it consumed and, when a device changed,
+// a fingerprint of every device's state. Recording serializes steps, so a
+// pass and a command never interleave.
+//
+// Replay runs the steps in order on the virtual clock, as fast as they
+// execute: task passes call the same execute() with the recorded inputs in
+// place of fresh random ones, and commands go to the caller's handler. The
+// device fingerprints are checked after every step.
+//
+// File layout: "SHTR" magic, u16 version, u64 master seed, i64 wall-clock
+// start in ns, then records:
+//   0x01 TASK     varint id, varint length, name bytes (first use of a task)
+//   0x02 STEP     varint task id, zigzag varint time delta
+//   0x03 COMMAND  u8 command, zigzag varint time delta, zigzag target, value
+//   0x04 INPUT    u8 input, varint count, count 4-byte floats
+//   0x05 STATE    u64 device fingerprint
+class SimulationTrace
+{
+public:
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr uint8_t RECORD_TASK = 0x01;
+    static constexpr uint8_t RECORD_STEP = 0x02;
+    static constexpr uint8_t RECORD_COMMAND = 0x03;
+    static constexpr uint8_t RECORD_INPUT = 0x04;
+    static constexpr uint8_t RECORD_STATE = 0x05;
+
+    using CommandHandler = std::function<void(TraceCommand command, int target, int value)>;
+
+private:
+    enum class Mode : uint8_t
+    {
+        OFF,
+        RECORDING,
+        REPLAYING
+    };
+
+    static SimulationTrace* instance;
+
+    std::atomic<Mode> mode{Mode::OFF};
+
+    // Recording; everything below is guarded by stepMutex, held for a step
+    std::mutex stepMutex;
+    std::FILE* file{nullptr};
+    std::vector<uint8_t> buffer;
+    std::unordered_map<const Task*, uint32_t> taskIds;
+    std::chrono::steady_clock::time_point origin;
+    int64_t lastOffsetNanos{0};
+
+    // Replay cursor, read by input() during a replayed step
+    const std::vector<uint8_t>* replayData{nullptr};
+    size_t replayPosition{0};
+    uint64_t replayInputs{0};
+    uint64_t inputMismatches{0};
+
+    DeviceSnapshot lightSnapshot;
+    DeviceSnapshot blindSnapshot;
+
+    SimulationTrace() = default;
+
+    int64_t offsetNanos();
+    // True, with the fingerprint, when a device changed since the last call
+    bool refreshFingerprint(uint64_t& fingerprint);
+    void flushLocked();
+    bool readInput(TraceInput channel, float* values, size_t count);
+
+public:
+    static SimulationTrace* getInstance();
+
+    bool startRecording(const std::string& path, std::string& error);
+    void stopRecording();
+    bool isRecording() const { return mode.load(std::memory_order_relaxed) == Mode::RECORDING; }
+    bool isReplaying() const { return mode.load(std::memory_order_relaxed) == Mode::REPLAYING; }
+
+    // Step boundaries while recording; begin returns false when not
+    // recording, and end must follow a begin that returned true
+    bool beginStep(const Task& task);
+    bool beginCommand(TraceCommand command, int target, int value);
+    void endStep();
+
+    // Passes the value through and records it, or during a replay returns
+    // the recorded one instead. Called by a task from inside its step.
+    float input(TraceInput channel, float value);
+    void inputs(TraceInput channel, float* values, size_t count);
+
+    // Switches the clock to virtual time at the recorded start and runs the
+    // trace against the given tasks, matched by name
+    bool replay(const std::string& path, const std::vector<Task*>& tasks, const CommandHandler& onCommand,
+                ReplayResult& result, std::string& error);
+};
+
+// Marks one task pass or command as a trace step for its scope
+class TraceStep
+{
+private:
+    bool active;
+
+public:
+    explicit TraceStep(const Task& task) : active(SimulationTrace::getInstance() -> beginStep(task)) {}
+    TraceStep(TraceCommand command, int target, int value)
+        : active(SimulationTrace::getInstance() -> beginCommand(command, target, value)) {}
+    ~TraceStep()
+    {
+        if (active)
+        {
+            SimulationTrace::getInstance() -> endStep();
+        }
+    }
+
+    TraceStep(const TraceStep&) = delete;
+    TraceStep& operator=(const TraceStep&) = delete;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "DeviceRegistry.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// On-disk layout of a snapshot, read in place from a memory mapping: the
+// header, deviceCount device records, sensorCount sensor records and then
+// nameBytes of NUL-terminated device names. Fixed-width, host byte order.
+struct SnapshotHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t deviceCount;
+    uint32_t sensorCount;
+    // Incremented by every snapshot; the journal names the one it follows
+    uint64_t sequence;
+    // Wall-clock capture time in ns since the epoch
+    int64_t wallNanos;
+    uint64_t nameBytes;
+    float temperature;
+    uint32_t reserved;
+    // Over everything after the header
+    uint64_t checksum;
+};
+
+// One device in a snapshot or a journal batch. The cooldown clock is stored
+// as the time since the last change, which survives a restart, rather than
+// the table's own millisecond timestamp, which does not.
+struct SnapshotDevice
+{
+    int32_t deviceId;
+    // Into the snapshot's name block; unused in the journal
+    uint32_t nameOffset;
+    uint32_t millisSinceChange;
+    uint8_t type;
+    uint8_t state;
+    uint8_t level;
+    uint8_t reserved;
+};
+
+struct SnapshotSensor
+{
+    char name[32];
+    double ewma;
+    uint64_t totalSamples;
+    uint64_t alertChanges;
+    float latest;
+    uint8_t alert;
+    uint8_t reserved[3];
+};
+
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value && sizeof(SnapshotHeader) == 56,
+              "snapshot header layout");
+static_assert(sizeof(SnapshotDevice) == 16 && sizeof(SnapshotSensor) == 64, "snapshot record layout");
+
+struct RestoreResult
+{
+    // False on a first start, when there is no snapshot yet
+    bool restored{false};
+    uint64_t sequence{0};
+    size_t devices{0};
+    // Devices in the snapshot that no task had created
+    size_t registered{0};
+    size_t sensors{0};
+    size_t journalBatches{0};
+    size_t journalRecords{0};
+    // Wall-clock time between the snapshot and the restore
+    std::chrono::nanoseconds snapshotAge{0};
+    double seconds{0.0};
+};
+
+struct StateStoreStatistics
+{
+    uint64_t snapshots{0};
+    uint64_t journalBatches{0};
+    uint64_t journalRecords{0};
+    uint64_t failures{0};
+    size_t lastSnapshotBytes{0};
+    // Copying the state out under the tables' shared locks, and writing and
+    // syncing the file afterwards
+    double lastCaptureMillis{0.0};
+    double lastWriteMillis{0.0};
+};
+
+// Crash-consistent persistence of the home state: device states with their
+// cooldown clocks, the sensor aggregates and the last temperature.
+//
+// A snapshot is written to a temporary file, synced and renamed over the
+// previous one, so the file on disk is always a complete snapshot. Between
+// snapshots the changed devices are appended to a journal in checksummed
+// batches; a torn batch at the end is ignored on restore. Every snapshot
+// restarts the journal, whose header names the snapshot it follows.
+//
+// All the work runs on a writer thread. It polls the tables' change counts
+// once per journal interval, diffs the changed tables against the last
+// state it recorded and appends the difference, so the scheduler never waits
+// for the disk and a quiet home costs two atomic loads per interval. A device
+// added or removed forces a snapshot instead of a journal batch.
+class StateStore
+{
+public:
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr std::chrono::seconds DEFAULT_SNAPSHOT_INTERVAL{60};
+    static constexpr std::chrono::milliseconds JOURNAL_INTERVAL{1000};
+    // Restored cooldown clocks are clamped to the oldest age a table tracks
+    static constexpr std::chrono::hours MAX_RESTORED_AGE = DeviceTable::MAX_TRACKED_AGE;
+
+private:
+    static StateStore* instance;
+
+    std::string path;
+    std::string journalPath;
+    uint64_t sequence{0};
+    uint64_t journalBatch{0};
+
+    // What the files on disk add up to for one table, and the table's change
+    // count when it was copied
+    struct TableBaseline
+    {
+        uint64_t changeCount{0};
+        std::vector<DeviceStatus> devices;
+    };
+
+    // Guards the files and everything below
+    std::mutex fileMutex;
+    std::FILE* journal{nullptr};
+    TableBaseline baselines[2];
+    std::vector<DeviceStatus> current;
+    std::vector<uint8_t> buffer;
+    std::string names;
+
+    std::thread writer;
+    std::mutex writerMutex;
+    std::condition_variable wake;
+    bool stopping{false};
+    bool snapshotRequested{false};
+    std::chrono::steady_clock::duration snapshotInterval{DEFAULT_SNAPSHOT_INTERVAL};
+
+    mutable std::mutex statisticsMutex;
+    StateStoreStatistics statistics;
+
+    StateStore() = default;
+
+    void run();
+    bool writeSnapshotLocked(std::string& error);
+    // Sets structural and appends nothing when a device was added or removed
+    bool appendJournalLocked(bool& structural, std::string& error);
+    bool restoreJournal(const SnapshotHeader& snapshot, RestoreResult& result, std::string& error);
+    void recordFailure(const std::string& error);
+
+public:
+    static StateStore* getInstance();
+
+    // Restores the snapshot and journal at path, if there are any, into the
+    // devices and sensors the tasks created; snapshot devices that do not
+    // exist yet are registered. Call before the scheduler starts.
+    bool open(const std::string& snapshotPath, RestoreResult& result, std::string& error);
+    bool isOpen() const { return !path.empty(); }
+
+    // Starts the writer thread, which takes a snapshot straight away
+    void start(std::chrono::steady_clock::duration interval);
+    void requestSnapshot();
+    // Stops the writer thread and takes a final snapshot
+    void stop();
+
+    // Synchronous versions of the writer thread's work
+    bool snapshotNow(std::string& error);
+    bool journalNow(std::string& error);
+
+    StateStoreStatistics getStatistics() const;
+};
@@ -9,6 +9,40 @@
 #include <chrono>
 #include <atomic>
 #include <algorithm>
+#include <functional>
+#include <string>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include "ReadyQueue.hpp"
+#include "WorkerPool.hpp"
+#include "LatencyHistogram.hpp"
+
+enum class SchedulingPolicy
+{
+    FIXED_PRIORITY,
+    RATE_MONOTONIC,
+    EARLIEST_DEADLINE_FIRST
+};
+
+struct DeadlineCounters
+{
+    std::atomic<uint64_t> releases{0};
+    std::atomic<uint64_t> deadlineMisses{0};
+    std::atomic<uint64_t> budgetOverruns{0};
+    std::atomic<int64_t> maxLatenessNs{std::numeric_limits<int64_t>::min()};
+    std::atomic<int64_t> minStartLatencyNs{std::numeric_limits<int64_t>::max()};
+    std::atomic<int64_t> maxStartLatencyNs{0};
+};
+
+// Per-task execution counters, written only by the thread running the task
+struct TaskMetrics
+{
+    std::atomic<uint64_t> executions{0};
+    std::atomic<uint64_t> exceptions{0};
+    LatencyHistogram executionTime;
+    LatencyHistogram dispatchLatency;
+};
 
 class Task {
 public:
@@ -17,19 +51,88 @@ public:
     virtual const std::string& getName() const = 0;
     virtual int getPriority() const = 0;
 
+    // Earliest time the task has work to do; the scheduler sleeps until the
+    // smallest of these instead of polling.
+    virtual std::chrono::steady_clock::time_point getNextDueTime() const;
+
+    // Timing contract of a periodic task. A zero period means the task is
+    // aperiodic; a zero deadline defaults to the period and a zero budget
+    // leaves the task out of the admission test.
+    virtual std::chrono::milliseconds getPeriod() const;
+    virtual std::chrono::milliseconds getRelativeDeadline() const;
+    virtual std::chrono::milliseconds getWcetBudget() const;
+
+    // Event-driven tasks have no timer release at all; they run only when
+    // TaskManager::wakeTask() is called, typically by an event delivery.
+    virtual bool isEventDriven() const;
+
     std::chrono::microseconds timeSlice{100};
     std::chrono::steady_clock::time_point lastExecutionTime;
     bool isReady{true};
+
+    // Tasks sharing a non-zero exclusion group never run concurrently in the
+    // worker pool; a task never runs concurrently with itself.
+    int exclusionGroup{0};
+    // The tasks that evaluate rules and move devices: RuleEngine::evaluate
+    // holds its engine lock while it takes the device table locks, so these
+    // run one at a time and only unrelated tasks run beside them.
+    static constexpr int HOME_STATE_GROUP = 1;
+
+    // Ready-list bookkeeping owned by the scheduler's ReadyQueue
+    int schedulingPriority{0};
+    Task* readyNext{nullptr};
+    Task* readyPrev{nullptr};
+    bool inReadyQueue{false};
+    bool inFlight{false};
+
+    // Wake bookkeeping owned by the scheduler: a release is queued, or a
+    // wake arrived while the task was running and it must run again
+    bool wakeQueued{false};
+    bool wakePending{false};
+
+    // Release/deadline bookkeeping owned by the scheduler
+    std::chrono::steady_clock::time_point releaseTime;
+    std::chrono::steady_clock::time_point absoluteDeadline;
+    std::chrono::steady_clock::time_point nextReleaseTime;
+    DeadlineCounters deadlineCounters;
+    TaskMetrics metrics;
 };
 
 class TaskManager {
 private:
+    struct ScheduleEntry
+    {
+        std::chrono::steady_clock::time_point dueTime;
+        Task* task;
+
+        bool operator>(const ScheduleEntry& other) const
+        {
+            return dueTime > other.dueTime;
+        }
+    };
+
     std::vector<std::unique_ptr<Task>> tasks;
+    std::priority_queue<ScheduleEntry, std::vector<ScheduleEntry>, std::greater<ScheduleEntry>> timerQueue;
+    ReadyQueue readyQueue;
+    // EDF ready queue, ordered by absolute deadline
+    std::priority_queue<ScheduleEntry, std::vector<ScheduleEntry>, std::greater<ScheduleEntry>> deadlineQueue;
+    SchedulingPolicy policy{SchedulingPolicy::FIXED_PRIORITY};
     mutable std::mutex taskMutex;
     std::condition_variable scheduleCV;
     std::atomic<bool> isRunning{false};
+    bool rescheduleRequested{false};
     std::thread schedulerThread;
 
+    size_t workerCount{0};
+    std::unique_ptr<WorkerPool> workerPool;
+    size_t inFlightTasks{0};
+    std::unordered_set<int> busyGroups;
+    std::unordered_map<int, std::vector<Task*>> parkedTasks;
+
+    std::atomic<uint64_t> wakeupCount{0};
+    std::chrono::steady_clock::time_point schedulerStartTime;
+    uint64_t wakeupsAtStart{0};
+
     const std::chrono::milliseconds minTimeSlice{50};
     const std::chrono::milliseconds maxTimeSlice{200};
     
@@ -37,24 +140,87 @@ private:
     TaskManager() = default;
 
     void schedulerLoop();
-    std::unique_ptr<Task>& selectNextTask();
-    void executeTask(Task* task);
-    bool hasReadyTasks() const;
+    Task* selectNextTask();
+    // Runs the task on the calling thread; false if it threw
+    bool executeTask(Task* task);
+    void collectDueTasks(std::chrono::steady_clock::time_point now);
+    void rebuildTimerQueue();
+    void dispatchReadyTasks();
+    void onTaskCompleted(Task* task, bool succeeded);
+    void rearmTask(Task* task);
+    void makeReady(Task* task);
+    void waitForNextEvent(std::unique_lock<std::mutex>& lock);
+    void runInline(std::unique_lock<std::mutex>& lock, Task* task);
+    void assignPriorities();
+    bool admits(const Task* candidate) const;
+    void recordRelease(Task* task, std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point finish);
 
 public:
     static TaskManager* getInstance();
-    void addTask(std::unique_ptr<Task> task);
+    // Returns false (and drops the task) when it would fail the admission
+    // test of the current scheduling policy.
+    bool addTask(std::unique_ptr<Task> task);
     void startScheduler();
     void stopScheduler();
+    void wakeScheduler();
+    // Releases an event-driven task now. Wakes that arrive while the task is
+    // queued coalesce; one that arrives while it runs releases it again
+    // afterwards, so no delivery goes unhandled. Safe from any thread.
+    void wakeTask(Task* task);
+    // Runs the schedule on the calling thread until the given time. With a
+    // virtual SimulationClock this is a discrete-event simulation that jumps
+    // from one due time to the next; the scheduler thread must be stopped.
+    void runUntil(std::chrono::steady_clock::time_point endTime);
+    void runFor(std::chrono::steady_clock::duration duration);
+    // 0 runs every task on the scheduler thread; N > 0 dispatches ready
+    // tasks to a pool of N work-stealing workers. Takes effect on the next
+    // startScheduler().
+    void setWorkerCount(size_t count);
+    void setSchedulingPolicy(SchedulingPolicy newPolicy);
+    SchedulingPolicy getSchedulingPolicy() const;
+    uint64_t getWakeupCount() const { return wakeupCount.load(std::memory_order_relaxed); }
+    static const char* getPolicyName(SchedulingPolicy schedulingPolicy);
     ~TaskManager();
 
+    struct TaskTiming
+    {
+        std::string name;
+        std::chrono::milliseconds period;
+        std::chrono::milliseconds relativeDeadline;
+        std::chrono::milliseconds wcetBudget;
+        uint64_t releases;
+        uint64_t deadlineMisses;
+        uint64_t budgetOverruns;
+        std::chrono::nanoseconds maxLateness;
+        std::chrono::nanoseconds startJitter;
+    };
+
+    struct TaskLatency
+    {
+        std::string name;
+        uint64_t executions;
+        uint64_t exceptions;
+        LatencyHistogram::Summary executionTime;
+        LatencyHistogram::Summary dispatchLatency;
+    };
+
     struct TaskStatistics
     {
         size_t totalTasks;
         size_t activeTasks;
         size_t completedTaskCount;
+        uint64_t schedulerWakeups;
+        // Average since the scheduler thread started
+        double wakeupsPerSecond;
+        size_t workerCount;
+        std::vector<WorkerPool::WorkerStatistics> workers;
         std::vector<std::pair<std::string, int>> taskPriorities;
+        SchedulingPolicy policy;
+        double utilization;
+        std::vector<TaskTiming> taskTimings;
+        std::vector<TaskLatency> taskLatencies;
     };
 
     TaskStatistics getStatistics() const;
-}; 
\ No newline at end of file
+}; 
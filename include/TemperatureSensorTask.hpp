@@ -4,15 +4,17 @@
 #include "Sensor.hpp"
 #include <string>
 #include <mutex>
-#include <random>
+#include "RandomService.hpp"
+#include "RuleEngine.hpp"
+#include "TimeSeries.hpp"
+#include "SensorStatistics.hpp"
 #include <chrono>
 
 class TemperatureSensor : public Sensor {
 private:
     static float currentTemperature;
     static std::mutex temperatureMutex;
-    std::mt19937 rng;
-    std::uniform_real_distribution<float> tempVariation;
+    Xoshiro256pp rng;
 
 public:
     explicit TemperatureSensor(const std::string& sensorName);
@@ -27,13 +29,18 @@ private:
     std::string name;
     int priority;
     std::unique_ptr<TemperatureSensor> sensor;
-    std::chrono::steady_clock::time_point lastExecuted;
+    Xoshiro256pp rng;
+    RuleInputId temperatureInput;
+    TimeSeries& history;
+    StreamingStatistics& statistics;
 
-    float simulateTemperature() const;
+    float simulateTemperature();
 
 public:
     TemperatureSensorTask(const std::string& taskName, int taskPriority);
     void execute() override;
     const std::string& getName() const override;
     int getPriority() const override;
+    std::chrono::milliseconds getPeriod() const override;
+    std::chrono::milliseconds getWcetBudget() const override;
 };
\ No newline at end of file
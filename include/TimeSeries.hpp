@@ -0,0 +1,266 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TimeSeriesSample
+{
+    std::chrono::steady_clock::time_point time;
+    float value;
+};
+
+// min/max/avg of the samples in [start, start + bucket width)
+struct TimeSeriesAggregate
+{
+    std::chrono::steady_clock::time_point start;
+    float min;
+    float max;
+    double avg;
+    size_t count;
+};
+
+// A run of up to SAMPLES_PER_BLOCK samples, compressed as in Facebook's
+// Gorilla: millisecond timestamps as delta-of-delta with variable-length
+// prefixes, and values as the XOR with the previous value, storing only
+// its meaningful bits. A regular 1 Hz series of a slowly changing reading
+// costs one bit per timestamp and a few bits per value. The header keeps a
+// summary, so aggregates over whole blocks need no decoding.
+struct TimeSeriesBlock
+{
+    static constexpr uint32_t SAMPLES_PER_BLOCK = 1024;
+
+    int64_t firstMillis{0};
+    int64_t lastMillis{0};
+    uint32_t count{0};
+    float min{std::numeric_limits<float>::max()};
+    float max{std::numeric_limits<float>::lowest()};
+    double sum{0.0};
+
+    // Bit stream, most significant bit first
+    std::vector<uint64_t> words;
+    size_t bitCount{0};
+
+    // Encoder state, only meaningful while the block is open
+    int64_t previousDelta{0};
+    uint32_t previousBits{0};
+    uint8_t previousLeading{0xFF};
+    uint8_t previousTrailing{0};
+
+    size_t byteSize() const { return sizeof(TimeSeriesBlock) + words.capacity() * sizeof(uint64_t); }
+};
+
+// Sequential decoder over one block
+class TimeSeriesBlockReader
+{
+private:
+    const TimeSeriesBlock& block;
+    size_t bitPosition{0};
+    uint32_t decoded{0};
+    int64_t millis{0};
+    int64_t delta{0};
+    uint32_t bits{0};
+    uint8_t leading{0};
+    uint8_t meaningful{0};
+
+    uint64_t readBits(unsigned count)
+    {
+        uint64_t value = 0;
+        while (count > 0)
+        {
+            size_t word = bitPosition >> 6;
+            unsigned offset = static_cast<unsigned>(bitPosition & 63);
+            unsigned available = 64 - offset;
+            unsigned take = count < available ? count : available;
+            uint64_t chunk = (block.words[word] << offset) >> (64 - take);
+            value = take == 64 ? chunk : (value << take) | chunk;
+            bitPosition += take;
+            count -= take;
+        }
+        return value;
+    }
+
+    bool readBit()
+    {
+        bool bit = (block.words[bitPosition >> 6] >> (63 - (bitPosition & 63))) & 1u;
+        bitPosition++;
+        return bit;
+    }
+
+    static int64_t signExtend(uint64_t value, unsigned width)
+    {
+        uint64_t sign = uint64_t{1} << (width - 1);
+        return static_cast<int64_t>((value ^ sign) - sign);
+    }
+
+public:
+    explicit TimeSeriesBlockReader(const TimeSeriesBlock& source) : block(source) {}
+
+    bool next(int64_t& sampleMillis, float& value)
+    {
+        if (decoded == block.count)
+        {
+            return false;
+        }
+
+        if (decoded == 0)
+        {
+            millis = block.firstMillis;
+            bits = static_cast<uint32_t>(readBits(32));
+        }
+        else
+        {
+            // Delta-of-delta: 0 | 10+7 | 110+9 | 1110+12 | 1111+64 bits
+            int64_t deltaOfDelta = 0;
+            if (readBit())
+            {
+                if (!readBit())
+                {
+                    deltaOfDelta = signExtend(readBits(7), 7);
+                }
+                else if (!readBit())
+                {
+                    deltaOfDelta = signExtend(readBits(9), 9);
+                }
+                else if (!readBit())
+                {
+                    deltaOfDelta = signExtend(readBits(12), 12);
+                }
+                else
+                {
+                    deltaOfDelta = static_cast<int64_t>(readBits(64));
+                }
+            }
+            delta += deltaOfDelta;
+            millis += delta;
+
+            // Value: 0 = same | 10 = reuse the previous window | 11 = new window
+            if (readBit())
+            {
+                if (readBit())
+                {
+                    leading = static_cast<uint8_t>(readBits(5));
+                    meaningful = static_cast<uint8_t>(readBits(5) + 1);
+                }
+                bits ^= static_cast<uint32_t>(readBits(meaningful)) << (32 - leading - meaningful);
+            }
+        }
+
+        decoded++;
+        sampleMillis = millis;
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+};
+
+// Append-only history of one sensor: an open block plus a ring of sealed
+// blocks. Sealed blocks older than the retention are dropped whole.
+// Appends take the lock exclusively, queries share it.
+class TimeSeries
+{
+public:
+    struct Statistics
+    {
+        std::string name;
+        size_t samples;
+        size_t blocks;
+        size_t bytes;
+        double bytesPerSample;
+        std::chrono::steady_clock::time_point oldest;
+        std::chrono::steady_clock::time_point newest;
+    };
+
+private:
+    std::string name;
+    std::chrono::milliseconds retention;
+    std::deque<TimeSeriesBlock> blocks;
+    size_t sampleCount{0};
+    size_t sealedBytes{0};
+    mutable std::shared_mutex seriesMutex;
+
+    static int64_t toMillis(std::chrono::steady_clock::time_point time);
+    static std::chrono::steady_clock::time_point fromMillis(int64_t millis);
+    void seal();
+
+public:
+    TimeSeries(const std::string& seriesName, std::chrono::milliseconds retentionPeriod);
+
+    // Returns false for a sample older than the newest one
+    bool append(std::chrono::steady_clock::time_point time, float value);
+
+    // Visits visitor(time, value) for each sample in [from, to], oldest first
+    template <typename Visitor>
+    void scan(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to,
+              Visitor visitor) const
+    {
+        int64_t startMillis = toMillis(from);
+        int64_t endMillis = toMillis(to);
+
+        std::shared_lock<std::shared_mutex> lock(seriesMutex);
+        for (const TimeSeriesBlock& block : blocks)
+        {
+            if (block.count == 0 || block.lastMillis < startMillis)
+            {
+                continue;
+            }
+            if (block.firstMillis > endMillis)
+            {
+                break;
+            }
+
+            TimeSeriesBlockReader reader(block);
+            int64_t millis;
+            float value;
+            while (reader.next(millis, value) && millis <= endMillis)
+            {
+                if (millis >= startMillis)
+                {
+                    visitor(fromMillis(millis), value);
+                }
+            }
+        }
+    }
+
+    std::vector<TimeSeriesSample> range(std::chrono::steady_clock::time_point from,
+                                        std::chrono::steady_clock::time_point to) const;
+    // Buckets of the given width starting at from; empty buckets are omitted
+    std::vector<TimeSeriesAggregate> downsample(std::chrono::steady_clock::time_point from,
+                                                std::chrono::steady_clock::time_point to,
+                                                std::chrono::milliseconds bucket) const;
+
+    const std::string& getName() const;
+    void setRetention(std::chrono::milliseconds retentionPeriod);
+    Statistics getStatistics() const;
+};
+
+// Named per-sensor series, created on first use
+class TimeSeriesStore
+{
+private:
+    static TimeSeriesStore* instance;
+
+    std::unordered_map<std::string, std::unique_ptr<TimeSeries>> series;
+    std::vector<TimeSeries*> ordered;
+    std::chrono::milliseconds retention{std::chrono::hours(24 * 30)};
+    mutable std::mutex storeMutex;
+
+    TimeSeriesStore() = default;
+
+public:
+    static TimeSeriesStore* getInstance();
+
+    // Series live as long as the store, so the reference can be cached
+    TimeSeries& getSeries(const std::string& seriesName);
+    // Applies to existing and future series
+    void setRetention(std::chrono::milliseconds retentionPeriod);
+    std::vector<TimeSeries::Statistics> getStatistics() const;
+};
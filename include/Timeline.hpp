@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TimelinePhase : uint8_t
+{
+    SPAN,
+    INSTANT
+};
+
+// One recorded event. Names and categories are not copied: they must stay
+// valid until the timeline is exported (string literals, task names).
+struct TimelineEvent
+{
+    const char* name;
+    const char* category;
+    uint64_t startNanos;
+    uint64_t durationNanos;
+    const char* argNames[2];
+    int64_t args[2];
+    TimelinePhase phase;
+};
+
+struct TimelineStatistics
+{
+    bool recording;
+    size_t threads;
+    uint64_t events;
+    uint64_t dropped;
+};
+
+// Records what the scheduler, the tasks, the rule engine, the logger and the
+// device tables do, for viewing as a timeline in ui.perfetto.dev or
+// chrome://tracing.
+//
+// Every thread appends to its own fixed-capacity buffer, so recording takes
+// no lock and touches no shared cache line; a full buffer drops further
+// events and counts them. While recording is off, each instrumented site
+// costs one relaxed load and a branch, and no arguments are evaluated.
+// start() begins a new recording; the buffers of the previous one are reset
+// by their own threads the next time they record.
+class Timeline
+{
+private:
+    struct ThreadBuffer
+    {
+        std::unique_ptr<TimelineEvent[]> events;
+        size_t capacity{0};
+        // Published with release once an event is complete
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+        // The recording the events belong to
+        std::atomic<uint32_t> generation{0};
+        uint32_t threadId{0};
+        std::string threadName;
+    };
+
+    static Timeline* instance;
+    static std::atomic<bool> enabled;
+
+    // Guards the buffer list, the thread names and the recording settings
+    mutable std::mutex timelineMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::atomic<uint32_t> generation{0};
+    size_t eventsPerThread{DEFAULT_EVENTS_PER_THREAD};
+
+    Timeline() = default;
+
+    ThreadBuffer& getThreadBuffer();
+    void append(const TimelineEvent& event);
+
+public:
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 1 << 18;
+
+    static Timeline* getInstance();
+
+    static bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static uint64_t nowNanos()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Discards the previous recording and starts a new one
+    void start(size_t maxEventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+    void stop();
+
+    // Names the calling thread in the exported timeline
+    void nameThread(const std::string& name);
+
+    void recordSpan(const char* category, const char* name, uint64_t startNanos, uint64_t endNanos,
+                    const char* argName0 = nullptr, int64_t arg0 = 0, const char* argName1 = nullptr,
+                    int64_t arg1 = 0);
+    void recordInstant(const char* category, const char* name, const char* argName0 = nullptr, int64_t arg0 = 0,
+                       const char* argName1 = nullptr, int64_t arg1 = 0);
+
+    // Writes the current recording as Chrome trace-event JSON. Safe while
+    // recording; events completed before the call are included.
+    bool exportJson(const std::string& path, std::string& error) const;
+
+    TimelineStatistics getStatistics() const;
+};
+
+// Records the enclosing scope as a span when the timeline is recording at
+// its start
+class TimelineSpan
+{
+private:
+    const char* category;
+    const char* name;
+    uint64_t startNanos{0};
+    const char* argNames[2]{};
+    int64_t args[2]{};
+
+public:
+    TimelineSpan(const char* spanCategory, const char* spanName) : category(spanCategory), name(spanName)
+    {
+        if (Timeline::isEnabled())
+        {
+            startNanos = Timeline::nowNanos();
+        }
+    }
+
+    ~TimelineSpan()
+    {
+        if (startNanos != 0)
+        {
+            Timeline::getInstance() -> recordSpan(category, name, startNanos, Timeline::nowNanos(), argNames[0],
+                                                  args[0], argNames[1], args[1]);
+        }
+    }
+
+    TimelineSpan(const TimelineSpan&) = delete;
+    TimelineSpan& operator=(const TimelineSpan&) = delete;
+
+    bool isRecording() const { return startNanos != 0; }
+
+    // index is 0 or 1
+    void setArg(size_t index, const char* argName, int64_t value)
+    {
+        argNames[index] = argName;
+        args[index] = value;
+    }
+};
+
+// TIMELINE_INSTANT("devices", "light change", "device", id, "level", level):
+// the arguments are only evaluated while the timeline is recording
+#define TIMELINE_INSTANT(category, ...) \
+    do \
+    { \
+        if (Timeline::isEnabled()) \
+        { \
+            Timeline::getInstance() -> recordInstant(category, __VA_ARGS__); \
+        } \
+    } while (0)
@@ -1,9 +1,9 @@
 #pragma once
 
+#include "DeviceGroup.hpp"
+#include "DeviceRegistry.hpp"
 #include <string>
-#include <mutex>
 #include <chrono>
-#include "Sensor.hpp"
 
 enum class BlindsPosition
 {
@@ -14,22 +14,43 @@ enum class BlindsPosition
     OPEN = 100
 };
 
-class WindowBlindController : Sensor
+// Lightweight view of one window blind in the DeviceRegistry; the position
+// and the time of the last move live in the blind's packed state word.
+class WindowBlindController
 {
 private:
-    BlindsPosition currentPosition;
-    int windowId;
-    std::chrono::steady_clock::time_point lastMoveTime;
-    static const int MOVE_COOLDOWN_MS = 5000;
+    DeviceTable* table;
+    DeviceHandle handle;
 
 public:
-    explicit WindowBlindController(const std::string& controllerName, int id);
-    float readValue() override;
+    static const int MOVE_COOLDOWN_MS = 5000;
+
+    WindowBlindController(DeviceTable& blinds, DeviceHandle blindHandle);
+
+    // Registers a new blind in the home-wide registry
+    static WindowBlindController create(const std::string& controllerName, int id);
+
+    float readValue() const;
     bool setPosition(BlindsPosition position);
     BlindsPosition getPosition() const;
     int getWindowId() const;
+    DeviceHandle getHandle() const;
+    const char* getName() const;
     std::string getPositionName() const;
 
-    static void openAllBlinds();
-    static void closeAllBlinds();
+    // For callers that already hold the table lock (shared is enough). The
+    // cooldown check and the move are one compare-and-swap; returns false
+    // while the blind is still in its move cooldown.
+    static bool setPositionLocked(DeviceTable& blinds, DeviceHandle handle, BlindsPosition position,
+                                  std::chrono::steady_clock::time_point now);
+    static const char* getPositionName(BlindsPosition position);
+
+    // Moves every blind in the group in one pass with one aggregated log
+    // record; blinds still in their cooldown are reported, not moved
+    static GroupResult setGroupPosition(const DeviceGroup& group, BlindsPosition position);
+    // Publishes a DeviceStateChanged for every blind a group apply moved
+    static void publishGroupChange(const GroupResult& result, uint8_t level);
+
+    static GroupResult openAllBlinds();
+    static GroupResult closeAllBlinds();
 };
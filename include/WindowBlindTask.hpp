@@ -2,26 +2,38 @@
 
 #include "TaskManager.hpp"
 #include "WindowBlindController.hpp"
-#include <memory>
+#include "RandomService.hpp"
+#include "RuleEngine.hpp"
+#include "TimeSeries.hpp"
+#include "SensorStatistics.hpp"
 #include <string>
 #include <chrono>
+#include <vector>
 
 class WindowBlindTask : public Task
 {
 private:
-    std::vector<std::unique_ptr<WindowBlindController>> controllers;
+    DeviceTable& blinds;
     std::string name;
     int priority;
-    std::chrono::steady_clock::time_point lastExecuted;
-    float simulateOutdoorLight() const;
-    void applyTimeBasedRules();
-    void applyLightBasedRules(float lightLevel);
+    Xoshiro256pp rng;
+    RuleInputId hourInput;
+    RuleInputId outdoorLightInput;
+    TimeSeries& lightHistory;
+    StreamingStatistics& lightStatistics;
+    float simulateOutdoorLight();
 
 public:
     WindowBlindTask(const std::string& taskName, int taskPriority);
     void execute() override;
     const std::string& getName() const override;
     int getPriority() const override;
+    std::chrono::milliseconds getPeriod() const override;
+    std::chrono::milliseconds getWcetBudget() const override;
     bool setBlindsPosition(int windowId, BlindsPosition position);
-    std::vector<std::pair<int, std::string>> getStatusReport() const;
+    // Refreshes the caller's snapshot of the blinds; false if it was current
+    bool getStatusSnapshot(DeviceSnapshot& snapshot) const;
+    // Text form of one entry, written like snprintf; kept apart from the
+    // snapshot so that polling readers only pay for it when they print
+    static int formatStatus(const DeviceStatus& status, char* buffer, size_t size);
 };
\ No newline at end of file
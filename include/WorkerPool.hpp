@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Task;
+
+// Fixed pool of executor threads. Each worker owns a deque: it takes work
+// from the front of its own deque and, when that is empty, steals from the
+// back of another worker's deque.
+class WorkerPool
+{
+public:
+    // The runner's result, false for a failed task, is handed to the
+    // completion handler
+    using TaskRunner = std::function<bool(Task*)>;
+    using CompletionHandler = std::function<void(Task*, bool)>;
+
+    struct WorkerStatistics
+    {
+        size_t workerId;
+        uint64_t executedTasks;
+        uint64_t steals;
+        double utilization;
+    };
+
+private:
+    struct Worker
+    {
+        std::deque<Task*> queue;
+        std::mutex queueMutex;
+        std::thread thread;
+        std::atomic<uint64_t> executedTasks{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<int64_t> busyNanos{0};
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    TaskRunner runTask;
+    CompletionHandler onComplete;
+
+    std::mutex poolMutex;
+    std::condition_variable workCV;
+    std::atomic<size_t> pendingTasks{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> nextWorker{0};
+    std::chrono::steady_clock::time_point startTime;
+
+    void workerLoop(size_t workerId);
+    Task* takeOwn(size_t workerId);
+    Task* steal(size_t thiefId);
+
+public:
+    WorkerPool(size_t workerCount, TaskRunner runner, CompletionHandler completion);
+    ~WorkerPool();
+
+    void start();
+    // Joins the workers after their current task and returns the tasks that
+    // were queued but never started.
+    std::vector<Task*> stop();
+    void submit(Task* task);
+
+    size_t size() const;
+    std::vector<WorkerStatistics> getStatistics() const;
+};
@@ -0,0 +1,264 @@
+#include "BinaryLog.hpp"
+#include "SimulationClock.hpp"
+#include <chrono>
+#include <cstring>
+
+BinaryLog* BinaryLog::instance = nullptr;
+
+namespace
+{
+
+constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+void appendBytes(std::vector<uint8_t>& out, const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+}
+
+std::string formatLogMessage(const char* format, const LogArg* args, size_t argCount)
+{
+    std::string result;
+    size_t nextArg = 0;
+    char number[64];
+
+    for (const char* cursor = format; *cursor != '\0'; cursor++)
+    {
+        if (*cursor != '%')
+        {
+            result.push_back(*cursor);
+            continue;
+        }
+
+        char spec = *(cursor + 1);
+        if (spec == '\0')
+        {
+            result.push_back('%');
+            break;
+        }
+        cursor++;
+
+        if (spec == '%')
+        {
+            result.push_back('%');
+            continue;
+        }
+
+        if (nextArg >= argCount)
+        {
+            result += "<missing>";
+            continue;
+        }
+
+        const LogArg& arg = args[nextArg++];
+
+        switch (arg.type)
+        {
+            case LogArg::Type::INT:
+                if (spec == 'u')
+                {
+                    std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(arg.intValue));
+                }
+                else
+                {
+                    std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(arg.intValue));
+                }
+                result += number;
+                break;
+            case LogArg::Type::FLOAT:
+            case LogArg::Type::DOUBLE:
+                std::snprintf(number, sizeof(number), spec == 'f' ? "%f" : "%g", arg.floatValue);
+                result += number;
+                break;
+            case LogArg::Type::STRING:
+                result.append(arg.stringValue, arg.stringLength);
+                break;
+        }
+    }
+
+    return result;
+}
+
+BinaryLog* BinaryLog::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new BinaryLog();
+    }
+
+    return instance;
+}
+
+uint16_t BinaryLog::registerFormat(const char* format)
+{
+    BinaryLog* log = getInstance();
+    std::lock_guard<std::mutex> lock(log -> writeMutex);
+
+    log -> formats.push_back(format);
+    if (log -> file != nullptr)
+    {
+        log -> writeFormatsLocked();
+    }
+
+    return static_cast<uint16_t>(log -> formats.size() - 1);
+}
+
+std::string BinaryLog::getFormat(uint16_t formatId)
+{
+    BinaryLog* log = getInstance();
+    std::lock_guard<std::mutex> lock(log -> writeMutex);
+    return formatId < log -> formats.size() ? log -> formats[formatId] : std::string();
+}
+
+uint64_t BinaryLog::zigzagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t BinaryLog::zigzagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void BinaryLog::appendVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool BinaryLog::open(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    if (file != nullptr)
+    {
+        return true;
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    buffer.clear();
+    buffer.reserve(FLUSH_THRESHOLD + 1024);
+    appendBytes(buffer, "SHLB", 4);
+    uint16_t version = FORMAT_VERSION;
+    appendBytes(buffer, &version, sizeof(version));
+
+    auto clock = SimulationClock::getInstance();
+    int64_t steadyNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(clock -> now().time_since_epoch()).count();
+    int64_t wallNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(clock -> wallNow().time_since_epoch()).count();
+    buffer.push_back(RECORD_ANCHOR);
+    appendBytes(buffer, &steadyNanos, sizeof(steadyNanos));
+    appendBytes(buffer, &wallNanos, sizeof(wallNanos));
+    lastTimestampNanos = steadyNanos;
+
+    formatsWritten = 0;
+    writeFormatsLocked();
+    opened = true;
+    return true;
+}
+
+void BinaryLog::writeFormatsLocked()
+{
+    for (; formatsWritten < formats.size(); formatsWritten++)
+    {
+        const std::string& format = formats[formatsWritten];
+        buffer.push_back(RECORD_FORMAT);
+        appendVarint(buffer, formatsWritten);
+        appendVarint(buffer, format.size());
+        appendBytes(buffer, format.data(), format.size());
+    }
+}
+
+void BinaryLog::writeEvent(uint16_t formatId, const LogArg* args, size_t argCount)
+{
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        SimulationClock::getInstance() -> now().time_since_epoch()).count();
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    buffer.push_back(RECORD_EVENT);
+    appendVarint(buffer, formatId);
+    appendVarint(buffer, zigzagEncode(timestamp - lastTimestampNanos));
+    buffer.push_back(static_cast<uint8_t>(argCount));
+    lastTimestampNanos = timestamp;
+
+    for (size_t i = 0; i < argCount; i++)
+    {
+        const LogArg& arg = args[i];
+        buffer.push_back(static_cast<uint8_t>(arg.type));
+
+        switch (arg.type)
+        {
+            case LogArg::Type::INT:
+                appendVarint(buffer, zigzagEncode(arg.intValue));
+                break;
+            case LogArg::Type::FLOAT:
+            {
+                float value = static_cast<float>(arg.floatValue);
+                appendBytes(buffer, &value, sizeof(value));
+                break;
+            }
+            case LogArg::Type::DOUBLE:
+                appendBytes(buffer, &arg.floatValue, sizeof(arg.floatValue));
+                break;
+            case LogArg::Type::STRING:
+                appendVarint(buffer, arg.stringLength);
+                appendBytes(buffer, arg.stringValue, arg.stringLength);
+                break;
+        }
+    }
+
+    if (buffer.size() >= FLUSH_THRESHOLD)
+    {
+        flushLocked();
+    }
+}
+
+void BinaryLog::flushLocked()
+{
+    if (file != nullptr && !buffer.empty())
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        std::fflush(file);
+    }
+    buffer.clear();
+}
+
+void BinaryLog::flush()
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    flushLocked();
+}
+
+void BinaryLog::close()
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    flushLocked();
+
+    if (file != nullptr)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+    opened = false;
+}
+
+bool BinaryLog::isOpen() const
+{
+    return opened.load(std::memory_order_acquire);
+}
@@ -0,0 +1,87 @@
+#include "ClimateBlindTask.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+
+ClimateBlindTask::ClimateBlindTask(const std::string& taskName, int taskPriority)
+    : name(taskName), priority(taskPriority), blinds(DeviceGroup::all("all blinds", DeviceType::BLIND))
+{
+    exclusionGroup = HOME_STATE_GROUP;
+    subscription = EventBus::getInstance() -> subscribe(name, {EventTopic::TEMPERATURE_READING},
+        [this]() { TaskManager::getInstance() -> wakeTask(this); });
+
+    LOG_INFO(BLINDS, "Climate blind control subscribed to temperature readings");
+}
+
+ClimateBlindTask::~ClimateBlindTask()
+{
+    EventBus::getInstance() -> unsubscribe(subscription);
+}
+
+void ClimateBlindTask::execute()
+{
+    Event event;
+    while (subscription -> poll(event))
+    {
+        onTemperature(event.temperature.celsius);
+    }
+}
+
+void ClimateBlindTask::onTemperature(float celsius)
+{
+    // Hysteresis keeps a reading that hovers around the threshold from
+    // toggling the rule on every sample
+    if (shading && celsius < RELEASE_BELOW_CELSIUS)
+    {
+        shading = false;
+        LOG_INFO(BLINDS, "Heat rule: %g°C, blinds back on their schedule", celsius);
+        return;
+    }
+
+    if (shading || celsius <= SHADE_ABOVE_CELSIUS)
+    {
+        return;
+    }
+
+    const uint8_t target = static_cast<uint8_t>(BlindsPosition::QUARTER_OPEN);
+
+    // Only lowers blinds; a closed blind stays closed
+    GroupResult result = blinds.apply([target](DeviceState& blind, uint32_t nowMillis)
+    {
+        if (blind.level <= target)
+        {
+            return GroupOutcome::UNCHANGED;
+        }
+        if (blind.millisSinceChange(nowMillis) < static_cast<uint32_t>(WindowBlindController::MOVE_COOLDOWN_MS))
+        {
+            return GroupOutcome::HELD_BY_COOLDOWN;
+        }
+
+        blind.level = target;
+        blind.lastChangeMillis = nowMillis;
+        return GroupOutcome::CHANGED;
+    });
+
+    LOG_INFO(BLINDS, "Heat rule: %g°C, lowered %u blinds to keep the heat out (%u held by cooldown)",
+             celsius, result.changed.size(), result.heldByCooldown.size());
+    Metrics::getInstance() -> blindsCooldownRejections.add(result.heldByCooldown.size());
+    WindowBlindController::publishGroupChange(result, target);
+
+    // Blinds held by their cooldown are retried on the next warm reading,
+    // as rules retry theirs
+    shading = result.heldByCooldown.empty();
+}
+
+const std::string& ClimateBlindTask::getName() const
+{
+    return name;
+}
+
+int ClimateBlindTask::getPriority() const
+{
+    return priority;
+}
+
+bool ClimateBlindTask::isEventDriven() const
+{
+    return true;
+}
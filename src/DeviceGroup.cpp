@@ -0,0 +1,43 @@
+#include "DeviceGroup.hpp"
+#include <utility>
+
+DeviceGroup::DeviceGroup(const std::string& groupName, DeviceType deviceType, std::vector<int> ids)
+    : name(groupName), type(deviceType), deviceIds(std::move(ids))
+{
+}
+
+DeviceGroup DeviceGroup::all(const std::string& groupName, DeviceType deviceType)
+{
+    DeviceGroup group(groupName, deviceType, {});
+    group.everyDevice = true;
+    return group;
+}
+
+DeviceGroup DeviceGroup::allExcept(const std::string& groupName, DeviceType deviceType, std::vector<int> excluded)
+{
+    DeviceGroup group = all(groupName, deviceType);
+    group.excludedIds = std::move(excluded);
+    return group;
+}
+
+const std::string& DeviceGroup::getName() const
+{
+    return name;
+}
+
+DeviceType DeviceGroup::getType() const
+{
+    return type;
+}
+
+size_t DeviceGroup::size() const
+{
+    if (!everyDevice)
+    {
+        return deviceIds.size();
+    }
+
+    // Exclusions of unregistered IDs are not subtracted
+    size_t devices = DeviceRegistry::getInstance() -> getTable(type).size();
+    return devices > excludedIds.size() ? devices - excludedIds.size() : 0;
+}
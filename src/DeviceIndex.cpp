@@ -0,0 +1,207 @@
+#include "DeviceIndex.hpp"
+#include <thread>
+#include <vector>
+
+DeviceIndex::DeviceIndex(size_t maxDevices)
+{
+    size_t capacity = 16;
+    while (capacity < maxDevices * 2)
+    {
+        capacity *= 2;
+    }
+
+    slots = std::make_unique<std::atomic<uint64_t>[]>(capacity);
+    for (size_t i = 0; i < capacity; i++)
+    {
+        slots[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+    mask = capacity - 1;
+}
+
+uint64_t DeviceIndex::makeKey(DeviceType type, int deviceId)
+{
+    return (static_cast<uint64_t>(type) + 1) << 56 | static_cast<uint64_t>(static_cast<uint32_t>(deviceId)) << 24;
+}
+
+size_t DeviceIndex::hashKey(uint64_t key)
+{
+    // Murmur3 finalizer; device IDs are often small and sequential
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    return static_cast<size_t>(key);
+}
+
+size_t DeviceIndex::probe(uint64_t key, bool& found) const
+{
+    size_t slot = hashKey(key) & mask;
+    size_t firstDeleted = SIZE_MAX;
+
+    for (size_t step = 0; step <= mask; step++, slot = (slot + 1) & mask)
+    {
+        uint64_t entry = slots[slot].load(std::memory_order_relaxed);
+
+        if (entry == EMPTY_SLOT)
+        {
+            found = false;
+            return firstDeleted != SIZE_MAX ? firstDeleted : slot;
+        }
+        if (entry == DELETED_SLOT)
+        {
+            if (firstDeleted == SIZE_MAX)
+            {
+                firstDeleted = slot;
+            }
+            continue;
+        }
+        if ((entry & ~HANDLE_MASK) == key)
+        {
+            found = true;
+            return slot;
+        }
+    }
+
+    found = false;
+    return firstDeleted;
+}
+
+void DeviceIndex::beginWrite()
+{
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void DeviceIndex::endWrite()
+{
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool DeviceIndex::insert(DeviceType type, int deviceId, DeviceHandle handle)
+{
+    if (handle > HANDLE_MASK)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    uint64_t key = makeKey(type, deviceId);
+    bool found;
+    size_t slot = probe(key, found);
+
+    if (found || slot == SIZE_MAX || liveCount * 2 >= mask + 1)
+    {
+        return false;
+    }
+
+    beginWrite();
+    if (slots[slot].load(std::memory_order_relaxed) == DELETED_SLOT)
+    {
+        deletedCount--;
+    }
+    slots[slot].store(key | handle, std::memory_order_relaxed);
+    liveCount++;
+    endWrite();
+    return true;
+}
+
+bool DeviceIndex::update(DeviceType type, int deviceId, DeviceHandle handle)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    uint64_t key = makeKey(type, deviceId);
+    bool found;
+    size_t slot = probe(key, found);
+
+    if (!found || handle > HANDLE_MASK)
+    {
+        return false;
+    }
+
+    beginWrite();
+    slots[slot].store(key | handle, std::memory_order_relaxed);
+    endWrite();
+    return true;
+}
+
+bool DeviceIndex::erase(DeviceType type, int deviceId)
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    bool found;
+    size_t slot = probe(makeKey(type, deviceId), found);
+
+    if (!found)
+    {
+        return false;
+    }
+
+    beginWrite();
+    slots[slot].store(DELETED_SLOT, std::memory_order_relaxed);
+    liveCount--;
+    deletedCount++;
+
+    // Tombstones lengthen every probe; rehash once they make up a quarter
+    if (deletedCount * 4 > mask + 1)
+    {
+        purgeDeleted();
+    }
+    endWrite();
+    return true;
+}
+
+void DeviceIndex::purgeDeleted()
+{
+    std::vector<uint64_t> live;
+    live.reserve(liveCount);
+
+    for (size_t i = 0; i <= mask; i++)
+    {
+        uint64_t entry = slots[i].load(std::memory_order_relaxed);
+        if (entry != EMPTY_SLOT && entry != DELETED_SLOT)
+        {
+            live.push_back(entry);
+        }
+        slots[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+
+    for (uint64_t entry : live)
+    {
+        size_t slot = hashKey(entry & ~HANDLE_MASK) & mask;
+        while (slots[slot].load(std::memory_order_relaxed) != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot].store(entry, std::memory_order_relaxed);
+    }
+
+    deletedCount = 0;
+}
+
+DeviceHandle DeviceIndex::find(DeviceType type, int deviceId) const
+{
+    uint64_t key = makeKey(type, deviceId);
+
+    while (true)
+    {
+        uint64_t before = version.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        bool found;
+        size_t slot = probe(key, found);
+        uint64_t entry = found ? slots[slot].load(std::memory_order_relaxed) : 0;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (version.load(std::memory_order_relaxed) == before)
+        {
+            return found ? static_cast<DeviceHandle>(entry & HANDLE_MASK) : INVALID_DEVICE_HANDLE;
+        }
+    }
+}
+
+size_t DeviceIndex::size() const
+{
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return liveCount;
+}
@@ -0,0 +1,387 @@
+#include "DeviceRegistry.hpp"
+#include "DeviceIndex.hpp"
+#include "SimulationClock.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+DeviceRegistry* DeviceRegistry::instance = nullptr;
+
+namespace
+{
+size_t pendingLightCapacity = DeviceRegistry::DEFAULT_CAPACITY;
+size_t pendingBlindCapacity = DeviceRegistry::DEFAULT_CAPACITY;
+}
+
+uint64_t NameTable::hash(std::string_view name)
+{
+    // FNV-1a
+    uint64_t value = 14695981039346656037ull;
+    for (char c : name)
+    {
+        value = (value ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return value;
+}
+
+void NameTable::growSlots()
+{
+    std::vector<uint32_t> grown(slots.empty() ? 64 : slots.size() * 2, EMPTY_SLOT);
+    size_t mask = grown.size() - 1;
+
+    for (uint32_t nameId = 0; nameId < names.size(); nameId++)
+    {
+        size_t slot = hash(names[nameId]) & mask;
+        while (grown[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        grown[slot] = nameId;
+    }
+
+    slots.swap(grown);
+}
+
+uint32_t NameTable::intern(std::string_view name)
+{
+    if ((names.size() + 1) * 2 > slots.size())
+    {
+        growSlots();
+    }
+
+    size_t mask = slots.size() - 1;
+    size_t slot = hash(name) & mask;
+    for (; slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+    {
+        if (name == names[slots[slot]])
+        {
+            return slots[slot];
+        }
+    }
+
+    size_t length = name.size() + 1;
+    if (blockUsed + length > blockCapacity)
+    {
+        blockCapacity = std::max(BLOCK_SIZE, length);
+        blocks.push_back(std::make_unique<char[]>(blockCapacity));
+        blockUsed = 0;
+    }
+
+    char* text = blocks.back().get() + blockUsed;
+    std::memcpy(text, name.data(), name.size());
+    text[name.size()] = '\0';
+    blockUsed += length;
+
+    uint32_t nameId = static_cast<uint32_t>(names.size());
+    names.push_back(text);
+    slots[slot] = nameId;
+    return nameId;
+}
+
+void NameTable::reserve(size_t count, size_t bytes)
+{
+    names.reserve(names.size() + count);
+    while ((names.size() + count) * 2 > slots.size())
+    {
+        growSlots();
+    }
+
+    if (blockUsed + bytes > blockCapacity)
+    {
+        blockCapacity = std::max(BLOCK_SIZE, bytes);
+        blocks.push_back(std::make_unique<char[]>(blockCapacity));
+        blockUsed = 0;
+    }
+}
+
+const char* NameTable::get(uint32_t nameId) const
+{
+    return names[nameId];
+}
+
+size_t NameTable::size() const
+{
+    return names.size();
+}
+
+DeviceTable::DeviceTable(size_t maxDevices, const char* changeEvent)
+    : capacity(maxDevices), epoch(std::chrono::steady_clock::now()), changeEventName(changeEvent)
+{
+    // Columns are laid out widest first so that each stays naturally aligned
+    size_t bytes = capacity * bytesPerDevice();
+    storage = std::make_unique<int64_t[]>((bytes + sizeof(int64_t) - 1) / sizeof(int64_t));
+
+    char* cursor = reinterpret_cast<char*>(storage.get());
+    stateWords = reinterpret_cast<std::atomic<uint64_t>*>(cursor);
+    for (size_t i = 0; i < capacity; i++)
+    {
+        new (&stateWords[i]) std::atomic<uint64_t>(0);
+    }
+    cursor += capacity * sizeof(std::atomic<uint64_t>);
+    deviceIds = reinterpret_cast<int32_t*>(cursor);
+    cursor += capacity * sizeof(int32_t);
+    nameIds = reinterpret_cast<uint32_t*>(cursor);
+}
+
+size_t DeviceTable::bytesPerDevice()
+{
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "state words must be lock-free 64-bit atomics");
+    return sizeof(std::atomic<uint64_t>) + sizeof(int32_t) + sizeof(uint32_t);
+}
+
+DeviceHandle DeviceTable::add(int deviceId, uint32_t nameId, std::chrono::steady_clock::time_point now)
+{
+    if (count == capacity)
+    {
+        return INVALID_DEVICE_HANDLE;
+    }
+
+    DeviceHandle handle = static_cast<DeviceHandle>(count);
+    DeviceState initial;
+    initial.lastChangeMillis = toMillis(now);
+
+    deviceIds[handle] = deviceId;
+    nameIds[handle] = nameId;
+    stateWords[handle].store(initial.pack(), std::memory_order_release);
+    count++;
+    changeCount.fetch_add(1, std::memory_order_release);
+    return handle;
+}
+
+void DeviceTable::removeAt(DeviceHandle handle)
+{
+    DeviceHandle last = static_cast<DeviceHandle>(count - 1);
+
+    if (handle != last)
+    {
+        stateWords[handle].store(stateWords[last].load(std::memory_order_acquire), std::memory_order_release);
+        deviceIds[handle] = deviceIds[last];
+        nameIds[handle] = nameIds[last];
+    }
+    count--;
+    changeCount.fetch_add(1, std::memory_order_release);
+}
+
+void DeviceTable::clear()
+{
+    count = 0;
+    changeCount.fetch_add(1, std::memory_order_release);
+}
+
+void DeviceTable::restore(DeviceHandle handle, DeviceState state)
+{
+    state.version = static_cast<uint16_t>(load(handle).version + 1);
+    stateWords[handle].store(state.pack(), std::memory_order_release);
+    changeCount.fetch_add(1, std::memory_order_release);
+}
+
+void DeviceTable::refreshIdleStamps(std::chrono::steady_clock::time_point now)
+{
+    const uint32_t interval = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(IDLE_REFRESH_INTERVAL).count());
+    const uint32_t maxAge = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(MAX_TRACKED_AGE).count());
+
+    uint32_t nowMillis = toMillis(now);
+    uint32_t lastRefresh = lastIdleRefreshMillis.load(std::memory_order_relaxed);
+    if (nowMillis - lastRefresh < interval ||
+        !lastIdleRefreshMillis.compare_exchange_strong(lastRefresh, nowMillis, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+    for (size_t handle = 0; handle < count; handle++)
+    {
+        uint64_t word = stateWords[handle].load(std::memory_order_acquire);
+        DeviceState state = DeviceState::unpack(word);
+
+        // A transition that lands first leaves a fresh stamp, so a failed
+        // exchange needs no retry
+        if (state.millisSinceChange(nowMillis) > maxAge)
+        {
+            state.lastChangeMillis = nowMillis - maxAge;
+            stateWords[handle].compare_exchange_strong(word, state.pack(), std::memory_order_acq_rel);
+        }
+    }
+}
+
+size_t DeviceTable::copyStatus(DeviceStatus* out, size_t maxDevices) const
+{
+    std::shared_lock<std::shared_mutex> lock(tableMutex);
+
+    size_t copied = std::min(count, maxDevices);
+    for (size_t handle = 0; handle < copied; handle++)
+    {
+        out[handle] = {deviceIds[handle], DeviceState::unpack(stateWords[handle].load(std::memory_order_acquire))};
+    }
+    return count;
+}
+
+bool DeviceSnapshot::refresh(const DeviceTable& table)
+{
+    // Read the count before the states: a change racing with the copy
+    // leaves the count behind, so the next refresh copies again
+    uint64_t current = table.getChangeCount();
+    if (source == &table && current == changeCount)
+    {
+        return false;
+    }
+
+    // Sized to the table's capacity once, so later refreshes never grow it
+    if (devices.size() < table.getCapacity())
+    {
+        devices.resize(table.getCapacity());
+    }
+    count = table.copyStatus(devices.data(), devices.size());
+    source = &table;
+    changeCount = current;
+    return true;
+}
+
+DeviceRegistry::DeviceRegistry(size_t lightCapacity, size_t blindCapacity)
+    : lights(lightCapacity, "light change"), blinds(blindCapacity, "blinds change"),
+      index(std::make_unique<DeviceIndex>(lightCapacity + blindCapacity))
+{
+    Metrics::getInstance() -> registerDeviceTable("light", &lights);
+    Metrics::getInstance() -> registerDeviceTable("blinds", &blinds);
+}
+
+DeviceRegistry::~DeviceRegistry() = default;
+
+DeviceRegistry* DeviceRegistry::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new DeviceRegistry(pendingLightCapacity, pendingBlindCapacity);
+    }
+
+    return instance;
+}
+
+void DeviceRegistry::configure(size_t lightCapacity, size_t blindCapacity)
+{
+    pendingLightCapacity = std::min(lightCapacity, DeviceIndex::MAX_HANDLES);
+    pendingBlindCapacity = std::min(blindCapacity, DeviceIndex::MAX_HANDLES);
+}
+
+DeviceTable& DeviceRegistry::getTable(DeviceType type)
+{
+    return type == DeviceType::LIGHT ? lights : blinds;
+}
+
+DeviceTable& DeviceRegistry::getLights()
+{
+    return lights;
+}
+
+DeviceTable& DeviceRegistry::getBlinds()
+{
+    return blinds;
+}
+
+DeviceHandle DeviceRegistry::registerDevice(DeviceType type, int deviceId, const std::string& name)
+{
+    uint32_t nameId;
+    {
+        std::lock_guard<std::mutex> lock(namesMutex);
+        nameId = names.intern(name);
+    }
+
+    DeviceTable& table = getTable(type);
+    std::unique_lock<std::shared_mutex> lock(table.getMutex());
+
+    if (index -> find(type, deviceId) != INVALID_DEVICE_HANDLE)
+    {
+        return INVALID_DEVICE_HANDLE;
+    }
+
+    DeviceHandle handle = table.add(deviceId, nameId, SimulationClock::getInstance() -> now());
+    if (handle != INVALID_DEVICE_HANDLE && !index -> insert(type, deviceId, handle))
+    {
+        table.removeAt(handle);
+        return INVALID_DEVICE_HANDLE;
+    }
+
+    return handle;
+}
+
+size_t DeviceRegistry::registerDevices(DeviceType type, const DeviceDefinition* devices, size_t count)
+{
+    // Table before names, the order status readers take them in
+    DeviceTable& table = getTable(type);
+    std::unique_lock<std::shared_mutex> lock(table.getMutex());
+    std::lock_guard<std::mutex> namesLock(namesMutex);
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        bytes += devices[i].name.size() + 1;
+    }
+    names.reserve(count, bytes);
+
+    auto now = SimulationClock::getInstance() -> now();
+    size_t added = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (index -> find(type, devices[i].deviceId) != INVALID_DEVICE_HANDLE)
+        {
+            continue;
+        }
+
+        DeviceHandle handle = table.add(devices[i].deviceId, names.intern(devices[i].name), now);
+        if (handle == INVALID_DEVICE_HANDLE)
+        {
+            break;
+        }
+        if (!index -> insert(type, devices[i].deviceId, handle))
+        {
+            table.removeAt(handle);
+            continue;
+        }
+        added++;
+    }
+    return added;
+}
+
+bool DeviceRegistry::removeDevice(DeviceType type, int deviceId)
+{
+    DeviceTable& table = getTable(type);
+    std::unique_lock<std::shared_mutex> lock(table.getMutex());
+
+    DeviceHandle handle = index -> find(type, deviceId);
+    if (handle == INVALID_DEVICE_HANDLE)
+    {
+        return false;
+    }
+
+    DeviceHandle last = static_cast<DeviceHandle>(table.size() - 1);
+    int movedId = table.getDeviceId(last);
+
+    table.removeAt(handle);
+    index -> erase(type, deviceId);
+    if (handle != last)
+    {
+        index -> update(type, movedId, handle);
+    }
+
+    return true;
+}
+
+DeviceHandle DeviceRegistry::findDevice(DeviceType type, int deviceId) const
+{
+    return index -> find(type, deviceId);
+}
+
+const char* DeviceRegistry::getName(DeviceType type, DeviceHandle handle) const
+{
+    const DeviceTable& table = type == DeviceType::LIGHT ? lights : blinds;
+    std::lock_guard<std::mutex> lock(namesMutex);
+    return names.get(table.getNameId(handle));
+}
+
+size_t DeviceRegistry::getNameCount() const
+{
+    std::lock_guard<std::mutex> lock(namesMutex);
+    return names.size();
+}
@@ -0,0 +1,148 @@
+#include "EventBus.hpp"
+#include <algorithm>
+#include <utility>
+
+EventBus* EventBus::instance = nullptr;
+
+EventSubscription::EventSubscription(const std::string& subscriberName, uint32_t topics, size_t capacity,
+                                     std::function<void()> onDelivery)
+    : name(subscriberName), topicMask(topics), inbox(capacity), notify(std::move(onDelivery))
+{
+}
+
+bool EventSubscription::poll(Event& event)
+{
+    return inbox.tryPop(event);
+}
+
+const std::string& EventSubscription::getName() const
+{
+    return name;
+}
+
+bool EventSubscription::isSubscribed(EventTopic topic) const
+{
+    return (topicMask & (1u << static_cast<uint32_t>(topic))) != 0;
+}
+
+uint64_t EventSubscription::getDeliveredCount() const
+{
+    return deliveredCount.load(std::memory_order_relaxed);
+}
+
+uint64_t EventSubscription::getDroppedCount() const
+{
+    return droppedCount.load(std::memory_order_relaxed);
+}
+
+EventBus::EventBus() : subscribers(std::make_shared<SubscriberLists>())
+{
+}
+
+EventBus* EventBus::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new EventBus();
+    }
+
+    return instance;
+}
+
+std::shared_ptr<EventSubscription> EventBus::subscribe(const std::string& subscriberName,
+                                                       std::initializer_list<EventTopic> topics,
+                                                       std::function<void()> onDelivery, size_t capacity)
+{
+    uint32_t mask = 0;
+    for (EventTopic topic : topics)
+    {
+        mask |= 1u << static_cast<uint32_t>(topic);
+    }
+
+    auto subscription = std::make_shared<EventSubscription>(subscriberName, mask, capacity, std::move(onDelivery));
+
+    std::lock_guard<std::mutex> lock(subscribeMutex);
+    auto next = std::make_shared<SubscriberLists>(*std::atomic_load(&subscribers));
+    for (EventTopic topic : topics)
+    {
+        next -> byTopic[static_cast<size_t>(topic)].push_back(subscription);
+    }
+    next -> all.push_back(subscription);
+    std::atomic_store(&subscribers, std::shared_ptr<const SubscriberLists>(std::move(next)));
+    activeTopics.fetch_or(mask, std::memory_order_release);
+
+    return subscription;
+}
+
+void EventBus::unsubscribe(const std::shared_ptr<EventSubscription>& subscription)
+{
+    std::lock_guard<std::mutex> lock(subscribeMutex);
+    auto next = std::make_shared<SubscriberLists>(*std::atomic_load(&subscribers));
+
+    auto erase = [&](std::vector<std::shared_ptr<EventSubscription>>& list)
+    {
+        list.erase(std::remove(list.begin(), list.end(), subscription), list.end());
+    };
+    for (auto& list : next -> byTopic)
+    {
+        erase(list);
+    }
+    erase(next -> all);
+
+    uint32_t mask = 0;
+    for (size_t topic = 0; topic < static_cast<size_t>(EventTopic::COUNT); topic++)
+    {
+        if (!next -> byTopic[topic].empty())
+        {
+            mask |= 1u << topic;
+        }
+    }
+    activeTopics.store(mask, std::memory_order_release);
+
+    std::atomic_store(&subscribers, std::shared_ptr<const SubscriberLists>(std::move(next)));
+}
+
+void EventBus::deliver(const Event& event)
+{
+    std::shared_ptr<const SubscriberLists> current = std::atomic_load(&subscribers);
+
+    for (const auto& subscription : current -> byTopic[static_cast<size_t>(event.topic)])
+    {
+        Event copy = event;
+        if (!subscription -> inbox.tryPush(std::move(copy)))
+        {
+            subscription -> droppedCount.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        subscription -> deliveredCount.fetch_add(1, std::memory_order_relaxed);
+        if (subscription -> notify)
+        {
+            subscription -> notify();
+        }
+    }
+}
+
+bool EventBus::hasSubscribers(EventTopic topic) const
+{
+    return (activeTopics.load(std::memory_order_acquire) & (1u << static_cast<uint32_t>(topic))) != 0;
+}
+
+uint64_t EventBus::getPublishedCount() const
+{
+    return publishedCount.load(std::memory_order_relaxed);
+}
+
+std::vector<EventBus::SubscriberStatistics> EventBus::getStatistics() const
+{
+    std::shared_ptr<const SubscriberLists> current = std::atomic_load(&subscribers);
+    std::vector<SubscriberStatistics> statistics;
+
+    for (const auto& subscription : current -> all)
+    {
+        statistics.push_back({subscription -> getName(), subscription -> getDeliveredCount(),
+                              subscription -> getDroppedCount(), subscription -> inbox.sizeApprox()});
+    }
+
+    return statistics;
+}
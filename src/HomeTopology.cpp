@@ -0,0 +1,387 @@
+#include "HomeTopology.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+HomeTopology* HomeTopology::instance = nullptr;
+
+namespace
+{
+
+std::string_view trim(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// Splits off the next space-separated word
+std::string_view nextWord(std::string_view& text)
+{
+    text = trim(text);
+    size_t end = text.find_first_of(" \t");
+    std::string_view word = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view() : text.substr(end);
+    return word;
+}
+
+bool parseInt(std::string_view token, int& value)
+{
+    auto [end, code] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return !token.empty() && code == std::errc() && end == token.data() + token.size();
+}
+
+bool parsePercent(std::string_view token, float& value)
+{
+    char text[32];
+    if (token.empty() || token.size() >= sizeof(text))
+    {
+        return false;
+    }
+    std::memcpy(text, token.data(), token.size());
+    text[token.size()] = '\0';
+
+    char* end = nullptr;
+    value = std::strtof(text, &end);
+    return *end == '\0' && value >= 0.0f && value <= 100.0f;
+}
+
+// Builds a topology one line at a time, without copying lines
+class TopologyParser
+{
+private:
+    const std::string& source;
+    std::string& error;
+    uint32_t lineNumber{0};
+
+    bool fail(const std::string& message)
+    {
+        error = source + ":" + std::to_string(lineNumber) + ": " + message;
+        return false;
+    }
+
+    int findProfile(std::string_view name) const
+    {
+        // Homes have a handful of profiles, shared by many rooms
+        for (size_t i = 0; i < profiles.size(); i++)
+        {
+            if (profiles[i].name == name)
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    bool parseProfile(std::string_view text)
+    {
+        size_t colon = text.find(':');
+        std::string_view name = trim(text.substr(0, colon));
+        if (colon == std::string_view::npos || name.empty() || name.find_first_of(" \t") != std::string_view::npos)
+        {
+            return fail("expected 'profile <name>: <from>-<to> <percent>, ...'");
+        }
+        if (findProfile(name) >= 0)
+        {
+            return fail("duplicate profile '" + std::string(name) + "'");
+        }
+
+        OccupancyProfile profile;
+        profile.name = std::string(name);
+        std::fill(std::begin(profile.hourly), std::end(profile.hourly), NAN);
+        float fallback = 0.0f;
+
+        std::string_view entries = text.substr(colon + 1);
+        while (!trim(entries).empty())
+        {
+            size_t comma = entries.find(',');
+            std::string_view entry = entries.substr(0, comma);
+            entries = comma == std::string_view::npos ? std::string_view() : entries.substr(comma + 1);
+
+            std::string_view hours = nextWord(entry);
+            float percent;
+            if (!parsePercent(trim(entry), percent))
+            {
+                return fail("expected a percentage from 0 to 100 after '" + std::string(hours) + "'");
+            }
+            if (hours == "default")
+            {
+                fallback = percent;
+                continue;
+            }
+
+            // Half-open, wrapping past midnight when from > to
+            size_t dash = hours.find('-');
+            int from;
+            int to;
+            if (dash == std::string_view::npos || !parseInt(hours.substr(0, dash), from) ||
+                !parseInt(hours.substr(dash + 1), to) || from < 0 || from > 23 || to < 0 || to > 24 || from == to)
+            {
+                return fail("expected an hour range such as 7-9 or 22-1, got '" + std::string(hours) + "'");
+            }
+            int hour = from;
+            do
+            {
+                profile.hourly[hour] = percent;
+                hour = (hour + 1) % 24;
+            } while (hour != to % 24);
+        }
+
+        for (float& chance : profile.hourly)
+        {
+            if (std::isnan(chance))
+            {
+                chance = fallback;
+            }
+        }
+        profiles.push_back(std::move(profile));
+        return true;
+    }
+
+    bool parseRoom(std::string_view text)
+    {
+        size_t colon = text.find(':');
+        if (colon == std::string_view::npos)
+        {
+            return fail("expected 'room <id> <profile> <light|blinds|light+blinds>: <name>'");
+        }
+
+        std::string_view head = text.substr(0, colon);
+        std::string_view id = nextWord(head);
+        std::string_view profileName = nextWord(head);
+        std::string_view devices = nextWord(head);
+        std::string_view name = trim(text.substr(colon + 1));
+
+        HomeRoom room{};
+        if (!parseInt(id, room.roomId) || room.roomId <= 0)
+        {
+            return fail("expected a positive room ID, got '" + std::string(id) + "'");
+        }
+        int profile = findProfile(profileName);
+        if (profile < 0)
+        {
+            return fail("unknown profile '" + std::string(profileName) + "'; define it before the rooms using it");
+        }
+        if (devices == "light" || devices == "light+blinds")
+        {
+            room.hasLight = true;
+        }
+        if (devices == "blinds" || devices == "light+blinds")
+        {
+            room.hasBlinds = true;
+        }
+        if (!room.hasLight && !room.hasBlinds)
+        {
+            return fail("expected 'light', 'blinds' or 'light+blinds', got '" + std::string(devices) + "'");
+        }
+        if (!trim(head).empty())
+        {
+            return fail("unexpected '" + std::string(trim(head)) + "' before ':'");
+        }
+        if (name.empty())
+        {
+            return fail("room " + std::string(id) + " has no name");
+        }
+
+        room.nameOffset = static_cast<uint32_t>(names.size());
+        room.nameLength = static_cast<uint32_t>(name.size());
+        room.profile = static_cast<uint16_t>(profile);
+        room.line = lineNumber;
+        names.append(name.data(), name.size());
+        rooms.push_back(room);
+        return true;
+    }
+
+public:
+    std::vector<OccupancyProfile> profiles;
+    std::vector<HomeRoom> rooms;
+    std::string names;
+
+    TopologyParser(const std::string& sourceName, std::string& errorMessage)
+        : source(sourceName), error(errorMessage)
+    {
+    }
+
+    bool parseLine(std::string_view line)
+    {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+        {
+            return true;
+        }
+
+        std::string_view rest = line;
+        std::string_view keyword = nextWord(rest);
+        if (keyword == "profile")
+        {
+            return parseProfile(rest);
+        }
+        if (keyword == "room")
+        {
+            return parseRoom(rest);
+        }
+        return fail("expected 'profile' or 'room', got '" + std::string(keyword) + "'");
+    }
+
+    // Sorts the rooms by ID and rejects duplicates
+    bool finish()
+    {
+        std::sort(rooms.begin(), rooms.end(), [](const HomeRoom& a, const HomeRoom& b)
+        {
+            return a.roomId != b.roomId ? a.roomId < b.roomId : a.line < b.line;
+        });
+
+        for (size_t i = 1; i < rooms.size(); i++)
+        {
+            if (rooms[i].roomId == rooms[i - 1].roomId)
+            {
+                lineNumber = rooms[i].line;
+                return fail("duplicate room " + std::to_string(rooms[i].roomId) + ", first defined on line " +
+                            std::to_string(rooms[i - 1].line));
+            }
+        }
+        if (profiles.size() > UINT16_MAX)
+        {
+            return fail("too many profiles");
+        }
+        return true;
+    }
+};
+
+}
+
+HomeTopology* HomeTopology::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new HomeTopology();
+    }
+
+    return instance;
+}
+
+bool HomeTopology::loadFile(const std::string& path, std::string& error)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        error = "cannot open " + path;
+        LOG_ERROR(SYSTEM, "Home topology not loaded: %s", error);
+        return false;
+    }
+
+    // Lines are parsed straight out of the read buffer; only a line split
+    // across two chunks is copied
+    TopologyParser parser(path, error);
+    std::vector<char> chunk(READ_CHUNK);
+    std::string carry;
+    bool valid = true;
+    size_t read;
+
+    while (valid && (read = std::fread(chunk.data(), 1, chunk.size(), file)) > 0)
+    {
+        const char* start = chunk.data();
+        const char* end = chunk.data() + read;
+        const char* newline;
+
+        while (valid && (newline = static_cast<const char*>(std::memchr(start, '\n', end - start))) != nullptr)
+        {
+            if (carry.empty())
+            {
+                valid = parser.parseLine(std::string_view(start, newline - start));
+            }
+            else
+            {
+                carry.append(start, newline);
+                valid = parser.parseLine(carry);
+                carry.clear();
+            }
+            start = newline + 1;
+        }
+        carry.append(start, end);
+    }
+    std::fclose(file);
+
+    if (valid && !carry.empty())
+    {
+        valid = parser.parseLine(carry);
+    }
+    if (!valid || !parser.finish())
+    {
+        LOG_ERROR(SYSTEM, "Home topology not loaded: %s", error);
+        return false;
+    }
+
+    source = path;
+    profiles = std::move(parser.profiles);
+    rooms = std::move(parser.rooms);
+    names = std::move(parser.names);
+    lightCount = std::count_if(rooms.begin(), rooms.end(), [](const HomeRoom& room) { return room.hasLight; });
+    blindCount = std::count_if(rooms.begin(), rooms.end(), [](const HomeRoom& room) { return room.hasBlinds; });
+
+    LOG_INFO(SYSTEM, "Loaded home topology %s: %u rooms, %u lights, %u blinds, %u occupancy profiles", path,
+             rooms.size(), lightCount, blindCount, profiles.size());
+    return true;
+}
+
+size_t HomeTopology::registerDevices(DeviceType type, const char* suffix) const
+{
+    size_t count = type == DeviceType::LIGHT ? lightCount : blindCount;
+    size_t suffixLength = std::strlen(suffix);
+
+    // Device names are the room names with the suffix, built in one block
+    std::string deviceNames;
+    deviceNames.reserve(names.size() + count * suffixLength);
+    std::vector<DeviceDefinition> devices;
+    devices.reserve(count);
+
+    for (const HomeRoom& room : rooms)
+    {
+        if (type == DeviceType::LIGHT ? room.hasLight : room.hasBlinds)
+        {
+            size_t offset = deviceNames.size();
+            deviceNames.append(getRoomName(room)).append(suffix);
+            devices.push_back({room.roomId, std::string_view(deviceNames.data() + offset,
+                                                             room.nameLength + suffixLength)});
+        }
+    }
+
+    return DeviceRegistry::getInstance() -> registerDevices(type, devices.data(), devices.size());
+}
+
+size_t HomeTopology::createLights() const
+{
+    return registerDevices(DeviceType::LIGHT, " Light");
+}
+
+size_t HomeTopology::createBlinds() const
+{
+    return registerDevices(DeviceType::BLIND, " Blinds");
+}
+
+std::string_view HomeTopology::getRoomName(const HomeRoom& room) const
+{
+    return std::string_view(names.data() + room.nameOffset, room.nameLength);
+}
+
+const float* HomeTopology::getOccupancy(int roomId) const
+{
+    static const float vacant[24] = {};
+
+    auto found = std::lower_bound(rooms.begin(), rooms.end(), roomId,
+                                  [](const HomeRoom& room, int id) { return room.roomId < id; });
+    if (found == rooms.end() || found -> roomId != roomId)
+    {
+        return vacant;
+    }
+    return profiles[found -> profile].hourly;
+}
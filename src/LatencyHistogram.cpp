@@ -0,0 +1,62 @@
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+
+uint64_t LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return static_cast<uint64_t>(index);
+    }
+
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t subBucket = static_cast<uint64_t>(index % SUB_BUCKETS);
+    uint64_t lower = (uint64_t{SUB_BUCKETS} | subBucket) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const
+{
+    uint64_t total = 0;
+    for (const auto& bucket : buckets)
+    {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return std::min(bucketUpperBound(i), maxValue.load(std::memory_order_relaxed));
+        }
+    }
+
+    return maxValue.load(std::memory_order_relaxed);
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const
+{
+    Summary summary;
+    summary.count = count.load(std::memory_order_relaxed);
+    summary.p50 = percentile(0.50);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    summary.max = maxValue.load(std::memory_order_relaxed);
+    summary.mean = summary.count > 0
+        ? static_cast<double>(sum.load(std::memory_order_relaxed)) / static_cast<double>(summary.count)
+        : 0.0;
+    return summary;
+}
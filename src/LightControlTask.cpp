@@ -1,236 +1,154 @@
 #include "LightControlTask.hpp"
+#include "EventBus.hpp"
+#include "HomeTopology.hpp"
 #include "Logger.hpp"
-#include <random>
-#include <ctime>
-#include <sstream>
+#include "RuleEngine.hpp"
+#include "SimulationClock.hpp"
+#include "SimulationTrace.hpp"
+#include <algorithm>
+#include <cstdio>
 
 LightControlTask::LightControlTask(const std::string& taskName, int taskPriority)
-    : name(taskName), priority(taskPriority)
+    : lights(DeviceRegistry::getInstance() -> getLights()), name(taskName), priority(taskPriority),
+      rng(RandomService::getInstance() -> createStream("lights.motion")),
+      hourInput(RuleEngine::getInstance() -> getInput("hour"))
 {
-    lastExecuted = std::chrono::steady_clock::now();
-
-    controllers.push_back(std::make_unique<LightController>("Living Room Light", 1));
-    controllers.push_back(std::make_unique<LightController>("Bedroom Light", 2));
-    controllers.push_back(std::make_unique<LightController>("Kitchen Light", 3));
-    controllers.push_back(std::make_unique<LightController>("Bathroom Light", 4));
-    
-    Logger::getInstance() -> log("Light control system initialized with 4 controllers", true);
+    exclusionGroup = HOME_STATE_GROUP;
+    size_t created = HomeTopology::getInstance() -> createLights();
+
+    LOG_INFO(LIGHTS, "Light control system initialized with %u controllers", created);
 }
 
 void LightControlTask::execute()
 {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastExecuted).count();
+    lights.refreshIdleStamps(SimulationClock::getInstance() -> now());
+    updateMotionInputs();
 
-    if (elapsed >= 10)
-    {
-        applyTimeBasedRules();
-        applyMotionBasedRules();
-
-        std::stringstream ss;
-        ss << "Light control status updated";
-        Logger::getInstance() -> log(ss.str(), false);
-        
-        lastExecuted = now;
-    }
+    // The late-night, evening, motion and inactivity rules live in the rule file
+    RuleEngine* rules = RuleEngine::getInstance();
+    rules -> setInput(hourInput, static_cast<float>(SimulationClock::getInstance() -> localHour()));
+    rules -> evaluate();
+
+    LOG_DEBUG(LIGHTS, "Light control status updated");
 }
 
-float LightControlTask::simulateMotion(int roomId) const
+void LightControlTask::updateMotionInputs()
 {
-    time_t now = time(0);
-    struct tm timeInfo;
-    
-#ifdef _WIN32
-    localtime_s(&timeInfo, &now);
-#else
-    localtime_r(&now, &timeInfo);
-#endif
-    
-    int hour = timeInfo.tm_hour;
-
-    float baseChance = 0.0f;
-
-    if (roomId == 1) 
+    int hour = SimulationClock::getInstance() -> localHour();
+    RuleEngine* rules = RuleEngine::getInstance();
+
     {
-        if ((hour >= 7 && hour < 9) || (hour >= 18 && hour < 23)) 
-        {
-            baseChance = 70.0f;
-        } 
-        else if (hour >= 9 && hour < 18) 
-        {
-            baseChance = 30.0f;
-        } 
-        else 
-        {
-            baseChance = 5.0f; // Night
-        }
+        std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+        roomIds.assign(lights.deviceIdData(), lights.deviceIdData() + lights.size());
     }
-    // Bedroom (id=2): Active morning and night
-    else if (roomId == 2) 
+    DeviceHandle count = static_cast<DeviceHandle>(roomIds.size());
+
+    motionNoise.resize(count);
+    motionLevels.resize(count);
+    inactivityDraws.resize(count);
+    rng.fillUniform(motionNoise.data(), count, -20.0f, 20.0f);
+    rng.fillUniform(inactivityDraws.data(), count, 0.0f, 1.0f);
+
+    // Input IDs and profiles are cached per handle and refreshed when a
+    // swap-remove moved another room into the slot
+    inputRooms.resize(count, -1);
+    roomInputs.resize(2 * count);
+    roomOccupancy.resize(count);
+    inputValues.resize(2 * count);
+
+    for (DeviceHandle light = 0; light < count; light++)
     {
-        if ((hour >= 6 && hour < 8) || (hour >= 22 || hour < 1)) 
-        {
-            baseChance = 80.0f;
-        } 
-        else if (hour >= 1 && hour < 6) 
-        {
-            baseChance = 20.0f;
-        } 
-        else 
+        int roomId = roomIds[light];
+        if (inputRooms[light] != roomId)
         {
-            baseChance = 10.0f;
+            inputRooms[light] = roomId;
+            roomInputs[2 * light] = rules -> getInput("motion." + std::to_string(roomId));
+            roomInputs[2 * light + 1] = rules -> getInput("chance." + std::to_string(roomId));
+            roomOccupancy[light] = HomeTopology::getInstance() -> getOccupancy(roomId);
         }
+        motionLevels[light] = std::max(0.0f, std::min(100.0f, roomOccupancy[light][hour] + motionNoise[light]));
     }
 
-    else if (roomId == 3) 
+    SimulationTrace* trace = SimulationTrace::getInstance();
+    trace -> inputs(TraceInput::MOTION, motionLevels.data(), count);
+    trace -> inputs(TraceInput::INACTIVITY, inactivityDraws.data(), count);
+
+    for (DeviceHandle light = 0; light < count; light++)
     {
-        if ((hour >= 7 && hour < 9) || (hour >= 12 && hour < 14) || (hour >= 18 && hour < 20)) 
-        {
-            baseChance = 90.0f;
-        } 
-        else 
+        int roomId = roomIds[light];
+        float motion = motionLevels[light];
+
+        if (motion > 75.0f)
         {
-            baseChance = 20.0f;
+            EventBus::getInstance() -> publish(MotionDetected{roomId, motion});
         }
-    }
 
-    else if (roomId == 4) 
-    {
-        baseChance = 30.0f;
+        inputValues[2 * light] = motion;
+        inputValues[2 * light + 1] = inactivityDraws[light];
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dis(-20.0f, 20.0f);
-    
-    return std::max(0.0f, std::min(100.0f, baseChance + dis(gen)));
+    rules -> setInputs(roomInputs.data(), inputValues.data(), 2 * static_cast<size_t>(count));
 }
 
-void LightControlTask::applyTimeBasedRules()
+const std::string& LightControlTask::getName() const
 {
-    time_t now = time(0);
-    struct tm timeInfo;
-    
-#ifdef _WIN32
-    localtime_s(&timeInfo, &now);
-#else
-    localtime_r(&now, &timeInfo);
-#endif
-    
-    int hour = timeInfo.tm_hour;
-
-    if (hour >= 1 && hour < 6)
-    {
-        for (auto& controller : controllers)
-        {
-            if (controller -> getRoomId() != 2 && controller -> getState() == LightState::ON)
-            {
-                controller -> turnOff();
-                std::stringstream ss;
-                ss << "Late night rule: Turning off light in room " << controller->getRoomId();
-                Logger::getInstance() -> log(ss.str(), true);
-            }
-        }
-    }
-    
-    if (hour >= 18 && hour < 20)
-    {
-        for (auto& controller : controllers)
-        {
-            if (controller -> getRoomId() == 1 && controller -> getState() == LightState::OFF)
-            {
-                controller -> turnOn();
-                std::stringstream ss;
-                ss << "Evening rule: Turning on living room light";
-                Logger::getInstance() -> log(ss.str(), true);
-            }
-        }
-    }
+    return name;
 }
 
-void LightControlTask::applyMotionBasedRules()
+int LightControlTask::getPriority() const
 {
-    for (auto& controller : controllers)
-    {
-        int roomId = controller -> getRoomId();
-        float motion = simulateMotion(roomId);
-        
-        if (motion > 75.0f && controller -> getState() == LightState::OFF)
-        {
-            controller -> turnOn();
-            std::stringstream ss;
-            ss << "Motion rule: Detected activity (" << motion 
-               << "%) in room " << roomId << ", turning light on";
-            Logger::getInstance() -> log(ss.str(), true);
-        }
-        else if (motion < 10.0f && controller->getState() == LightState::ON)
-        {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<> dis(1, 100);
-            
-            if (dis(gen) <= 10)
-            {
-                controller -> turnOff();
-                std::stringstream ss;
-                ss << "Inactivity rule: No motion (" << motion 
-                   << "%) in room " << roomId << ", turning light off";
-                Logger::getInstance() -> log(ss.str(), true);
-            }
-        }
-    }
+    return priority;
 }
 
-const std::string& LightControlTask::getName() const
+std::chrono::milliseconds LightControlTask::getPeriod() const
 {
-    return name;
+    return std::chrono::seconds(10);
 }
 
-int LightControlTask::getPriority() const
+std::chrono::milliseconds LightControlTask::getWcetBudget() const
 {
-    return priority;
+    return std::chrono::milliseconds(50);
 }
 
 bool LightControlTask::setLight(int roomId, bool on)
 {
-    for (auto& controller : controllers)
+    auto now = SimulationClock::getInstance() -> now();
+
+    std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+    DeviceHandle light = DeviceRegistry::getInstance() -> findDevice(DeviceType::LIGHT, roomId);
+
+    if (light == INVALID_DEVICE_HANDLE)
     {
-        if (controller -> getRoomId() == roomId)
-        {
-            return on ? controller -> turnOn() : controller -> turnOff();
-        }
+        return false;
     }
-    
-    return false;
+
+    return on ? LightController::turnOnLocked(lights, light, now) : LightController::turnOffLocked(lights, light, now);
 }
 
 bool LightControlTask::setBrightness(int roomId, LightBrightness level)
 {
-    for (auto& controller : controllers)
+    auto now = SimulationClock::getInstance() -> now();
+
+    std::shared_lock<std::shared_mutex> lock(lights.getMutex());
+    DeviceHandle light = DeviceRegistry::getInstance() -> findDevice(DeviceType::LIGHT, roomId);
+
+    if (light == INVALID_DEVICE_HANDLE)
     {
-        if (controller -> getRoomId() == roomId)
-        {
-            return controller -> setBrightness(level);
-        }
+        return false;
     }
-    
-    return false;
+
+    return LightController::setBrightnessLocked(lights, light, level, now);
 }
 
-std::vector<std::pair<int, std::string>> LightControlTask::getStatusReport() const
+bool LightControlTask::getStatusSnapshot(DeviceSnapshot& snapshot) const
 {
-    std::vector<std::pair<int, std::string>> report;
-    
-    for (const auto& controller : controllers)
-    {
-        std::stringstream ss;
-        ss << "Room " << controller -> getRoomId() << ": " 
-           << (controller -> getState() == LightState::ON ? "ON" : "OFF")
-           << " (" << controller -> getBrightnessName() << ", " 
-           << static_cast<int>(controller -> getBrightness()) << "%)";
-        
-        report.push_back({controller -> getRoomId(), ss.str()});
-    }
-    
-    return report;
+    return snapshot.refresh(lights);
+}
+
+int LightControlTask::formatStatus(const DeviceStatus& status, char* buffer, size_t size)
+{
+    LightBrightness brightness = static_cast<LightBrightness>(status.state.level);
+    return std::snprintf(buffer, size, "Room %d: %s (%s, %d%%)", status.deviceId,
+                         status.state.state == static_cast<uint8_t>(LightState::ON) ? "ON" : "OFF",
+                         LightController::getBrightnessName(brightness), static_cast<int>(brightness));
 }
\ No newline at end of file
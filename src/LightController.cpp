@@ -1,78 +1,182 @@
 #include "LightController.hpp"
+#include "EventBus.hpp"
 #include "Logger.hpp"
-#include <sstream>
+#include "SimulationClock.hpp"
 
-std::vector<LightController*> LightController::allLights;
+LightController::LightController(DeviceTable& lights, DeviceHandle lightHandle)
+    : table(&lights), handle(lightHandle)
+{
+}
 
-LightController::LightController(const std::string& controllerName, int id)
-    : Sensor(controllerName), 
-      state(LightState::OFF),
-      brightness(LightBrightness::OFF),
-      roomId(id)
+LightController LightController::create(const std::string& controllerName, int id)
 {
-    allLights.push_back(this);
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    return LightController(registry -> getLights(), registry -> registerDevice(DeviceType::LIGHT, id, controllerName));
 }
 
-float LightController::readValue()
+float LightController::readValue() const
 {
-    std::lock_guard<std::mutex> lock(valueMutex);
-    return static_cast<float>(static_cast<int>(brightness));
+    return static_cast<float>(table -> getLevel(handle));
 }
 
-bool LightController::turnOn()
+void LightController::publishStateChange(const DeviceTable& lights, DeviceHandle handle)
 {
-    std::lock_guard<std::mutex> lock(valueMutex);
+    DeviceState state = lights.load(handle);
+    EventBus::getInstance() -> publish(DeviceStateChanged{DeviceType::LIGHT, lights.getDeviceId(handle), state.state, state.level});
+}
+
+void LightController::publishGroupChange(const GroupResult& result, LightState state, LightBrightness level)
+{
+    EventBus* bus = EventBus::getInstance();
+    if (!bus -> hasSubscribers(EventTopic::DEVICE_STATE_CHANGE))
+    {
+        return;
+    }
+
+    for (int roomId : result.changed)
+    {
+        bus -> publish(DeviceStateChanged{DeviceType::LIGHT, roomId, static_cast<uint8_t>(state), static_cast<uint8_t>(level)});
+    }
+}
 
-    if (state == LightState::OFF)
+bool LightController::turnOnLocked(DeviceTable& lights, DeviceHandle handle, std::chrono::steady_clock::time_point now)
+{
+    uint32_t nowMillis = lights.toMillis(now);
+    bool changed = lights.transition(handle, [nowMillis](DeviceState& light)
     {
-        state = LightState::ON;
-        brightness = LightBrightness::MEDIUM;
-        std::stringstream ss;
-        ss << "Light in room " << roomId << " turned ON at " 
-           << static_cast<int>(brightness) << "% brightness";
-        Logger::getInstance() -> log(ss.str(), true);
+        if (light.state != static_cast<uint8_t>(LightState::OFF))
+        {
+            return false;
+        }
+
+        light.state = static_cast<uint8_t>(LightState::ON);
+        light.level = static_cast<uint8_t>(LightBrightness::MEDIUM);
+        light.lastChangeMillis = nowMillis;
         return true;
+    });
+
+    if (changed)
+    {
+        LOG_INFO(LIGHTS, "Light in room %d turned ON at %d%% brightness",
+                 lights.getDeviceId(handle), static_cast<int>(LightBrightness::MEDIUM));
+        publishStateChange(lights, handle);
     }
 
-    return false;
+    return changed;
 }
 
-bool LightController::turnOff()
+bool LightController::turnOffLocked(DeviceTable& lights, DeviceHandle handle, std::chrono::steady_clock::time_point now)
 {
-    std::lock_guard<std::mutex> lock(valueMutex);
+    uint32_t nowMillis = lights.toMillis(now);
+    bool changed = lights.transition(handle, [nowMillis](DeviceState& light)
+    {
+        if (light.state != static_cast<uint8_t>(LightState::ON))
+        {
+            return false;
+        }
+
+        light.state = static_cast<uint8_t>(LightState::OFF);
+        light.level = static_cast<uint8_t>(LightBrightness::OFF);
+        light.lastChangeMillis = nowMillis;
+        return true;
+    });
 
-    if (state == LightState::ON)
+    if (changed)
     {
-        state = LightState::OFF;
-        brightness = LightBrightness::OFF;
+        LOG_INFO(LIGHTS, "Light in room %d turned OFF", lights.getDeviceId(handle));
+        publishStateChange(lights, handle);
+    }
+
+    return changed;
+}
 
-        std::stringstream ss;
-        ss << "Light in room " << roomId << " turned OFF";
-        Logger::getInstance() -> log(ss.str(), true);
+bool LightController::setBrightnessLocked(DeviceTable& lights, DeviceHandle handle, LightBrightness level,
+                                          std::chrono::steady_clock::time_point now)
+{
+    if (level == LightBrightness::OFF)
+    {
+        return turnOffLocked(lights, handle, now);
+    }
+
+    uint32_t nowMillis = lights.toMillis(now);
+    bool levelChanged = false;
+    lights.transition(handle, [nowMillis, level, &levelChanged](DeviceState& light)
+    {
+        levelChanged = light.level != static_cast<uint8_t>(level);
+        if (light.state == static_cast<uint8_t>(LightState::ON) && !levelChanged)
+        {
+            return false;
+        }
+
+        light.state = static_cast<uint8_t>(LightState::ON);
+        if (levelChanged)
+        {
+            light.level = static_cast<uint8_t>(level);
+            light.lastChangeMillis = nowMillis;
+        }
         return true;
+    });
+
+    if (levelChanged)
+    {
+        LOG_INFO(LIGHTS, "Light in room %d brightness set to %d%%", lights.getDeviceId(handle), static_cast<int>(level));
+        publishStateChange(lights, handle);
     }
 
-    return false;
+    return levelChanged;
+}
+
+bool LightController::turnOn()
+{
+    std::shared_lock<std::shared_mutex> lock(table -> getMutex());
+    return turnOnLocked(*table, handle, SimulationClock::getInstance() -> now());
+}
+
+bool LightController::turnOff()
+{
+    std::shared_lock<std::shared_mutex> lock(table -> getMutex());
+    return turnOffLocked(*table, handle, SimulationClock::getInstance() -> now());
+}
+
+bool LightController::setBrightness(LightBrightness level)
+{
+    std::shared_lock<std::shared_mutex> lock(table -> getMutex());
+    return setBrightnessLocked(*table, handle, level, SimulationClock::getInstance() -> now());
 }
 
 LightState LightController::getState() const
 {
-    return state;
+    return static_cast<LightState>(table -> getState(handle));
 }
 
 LightBrightness LightController::getBrightness() const
 {
-    return brightness;
+    return static_cast<LightBrightness>(table -> getLevel(handle));
 }
 
 int LightController::getRoomId() const
 {
-    return roomId;
+    return table -> getDeviceId(handle);
+}
+
+DeviceHandle LightController::getHandle() const
+{
+    return handle;
+}
+
+const char* LightController::getName() const
+{
+    return DeviceRegistry::getInstance() -> getName(DeviceType::LIGHT, handle);
 }
 
 std::string LightController::getBrightnessName() const
 {
-    switch (brightness)
+    return getBrightnessName(getBrightness());
+}
+
+const char* LightController::getBrightnessName(LightBrightness level)
+{
+    switch (level)
     {
         case LightBrightness::OFF:
             return "Off";
@@ -89,50 +193,62 @@ std::string LightController::getBrightnessName() const
     }
 }
 
-void LightController::turnOnAllLights()
+GroupResult LightController::turnOnGroup(const DeviceGroup& group)
 {
-    for (auto light : allLights)
+    GroupResult result = group.apply([](DeviceState& light, uint32_t nowMillis)
     {
-        light->turnOn();
-    }
-    
-    Logger::getInstance() -> log("Command: Turning ON all lights", true);
+        if (light.state == static_cast<uint8_t>(LightState::ON))
+        {
+            return GroupOutcome::UNCHANGED;
+        }
+
+        light.state = static_cast<uint8_t>(LightState::ON);
+        light.level = static_cast<uint8_t>(LightBrightness::MEDIUM);
+        light.lastChangeMillis = nowMillis;
+        return GroupOutcome::CHANGED;
+    });
+
+    LOG_INFO(LIGHTS, "Group %s: turned ON %u lights (%u already on, %u unknown)",
+             group.getName(), result.changed.size(), result.unchanged, result.missing);
+    publishGroupChange(result, LightState::ON, LightBrightness::MEDIUM);
+    return result;
 }
 
-void LightController::turnOffAllLights()
+GroupResult LightController::turnOffGroup(const DeviceGroup& group)
 {
-    for (auto light : allLights)
-    {
-        light->turnOff();
-    }
-    
-    Logger::getInstance() -> log("Command: Turning OFF all lights", true);
+    return setGroupBrightness(group, LightBrightness::OFF);
 }
 
-bool LightController::setBrightness(LightBrightness level)
+GroupResult LightController::setGroupBrightness(const DeviceGroup& group, LightBrightness level)
 {
-    std::lock_guard<std::mutex> lock(valueMutex);
-    
-    if (level == LightBrightness::OFF)
-    {
-        return turnOff();
-    }
-    
-    if (state == LightState::OFF && level != LightBrightness::OFF)
-    {
-        state = LightState::ON;
-    }
-    
-    if (brightness != level)
+    uint8_t targetState = static_cast<uint8_t>(level == LightBrightness::OFF ? LightState::OFF : LightState::ON);
+    uint8_t targetLevel = static_cast<uint8_t>(level);
+
+    GroupResult result = group.apply([targetState, targetLevel](DeviceState& light, uint32_t nowMillis)
     {
-        brightness = level;
-        
-        std::stringstream ss;
-        ss << "Light in room " << roomId << " brightness set to " 
-           << static_cast<int>(brightness) << "%";
-        Logger::getInstance() -> log(ss.str(), true);
-        return true;
-    }
-    
-    return false;
-}
\ No newline at end of file
+        if (light.state == targetState && light.level == targetLevel)
+        {
+            return GroupOutcome::UNCHANGED;
+        }
+
+        light.state = targetState;
+        light.level = targetLevel;
+        light.lastChangeMillis = nowMillis;
+        return GroupOutcome::CHANGED;
+    });
+
+    LOG_INFO(LIGHTS, "Group %s: set %u lights to %d%% (%u already there, %u unknown)",
+             group.getName(), result.changed.size(), static_cast<int>(level), result.unchanged, result.missing);
+    publishGroupChange(result, static_cast<LightState>(targetState), level);
+    return result;
+}
+
+GroupResult LightController::turnOnAllLights()
+{
+    return turnOnGroup(DeviceGroup::all("all lights", DeviceType::LIGHT));
+}
+
+GroupResult LightController::turnOffAllLights()
+{
+    return turnOffGroup(DeviceGroup::all("all lights", DeviceType::LIGHT));
+}
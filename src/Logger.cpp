@@ -1,22 +1,43 @@
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "SimulationClock.hpp"
+#include "Timeline.hpp"
 #include <iostream>
 #include <ctime>
 #include <iomanip>
 #include <chrono>
+#include <vector>
 
 Logger* Logger::instance = nullptr;
 
-Logger::Logger() : consoleOutput(false)
+std::atomic<uint8_t> Logger::categoryLevels[static_cast<size_t>(LogCategory::COUNT)] = {
+    static_cast<uint8_t>(LogLevel::DEBUG),
+    static_cast<uint8_t>(LogLevel::DEBUG),
+    static_cast<uint8_t>(LogLevel::DEBUG),
+    static_cast<uint8_t>(LogLevel::DEBUG),
+    static_cast<uint8_t>(LogLevel::DEBUG)
+};
+
+namespace
+{
+const char* const levelNames[] = {"trace", "debug", "info", "warn", "error", "off"};
+const char* const categoryNames[] = {"system", "scheduler", "sensors", "blinds", "lights"};
+}
+
+Logger::Logger() : consoleOutput(false), plainMessageFormat(BinaryLog::registerFormat("%s"))
 {
     logFile.open("system.log", std::ios::app);
 }
 
 Logger::~Logger()
 {
+    shutdown();
+
     if (logFile.is_open())
     {
         logFile.close();
     }
+    segments.close();
 }
 
 Logger* Logger::getInstance()
@@ -29,38 +50,381 @@ Logger* Logger::getInstance()
     return instance;
 }
 
-void Logger::log(const std::string& message, bool toConsole)
+const char* Logger::formatTimestamp(std::chrono::system_clock::time_point timestamp)
 {
-    std::lock_guard<std::mutex> lock(logMutex);
+    auto timeT = std::chrono::system_clock::to_time_t(timestamp);
+
+    if (timeT != cachedSecond)
+    {
+        struct tm timeInfo;
 
-    auto now = std::chrono::system_clock::now();
-    auto timeT = std::chrono::system_clock::to_time_t(now);
-    struct tm timeInfo;
-    
 #ifdef _WIN32
-    localtime_s(&timeInfo, &timeT);
+        localtime_s(&timeInfo, &timeT);
 #else
-    localtime_r(&timeT, &timeInfo);
+        localtime_r(&timeT, &timeInfo);
 #endif
-    
-    char timeBuffer[25];
-    strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", &timeInfo);
-    
-    std::string logEntry = "[" + std::string(timeBuffer) + "] " + message;
-    
+
+        cachedTimestamp[0] = '[';
+        size_t length = strftime(cachedTimestamp + 1, sizeof(cachedTimestamp) - 3, "%Y-%m-%d %H:%M:%S", &timeInfo);
+        cachedTimestamp[length + 1] = ']';
+        cachedTimestamp[length + 2] = ' ';
+        cachedTimestamp[length + 3] = '\0';
+        cachedSecond = timeT;
+    }
+
+    return cachedTimestamp;
+}
+
+void Logger::writeEntry(std::chrono::system_clock::time_point timestamp, const std::string& message, bool toConsole)
+{
+    const char* prefix = formatTimestamp(timestamp);
+
+    if (segments.isOpen())
+    {
+        segments.append(timestamp, {prefix, message, "\n"});
+    }
+    else if (logFile.is_open())
+    {
+        logFile << prefix << message << '\n';
+    }
+
+    if (toConsole || consoleOutput)
+    {
+        std::cout << prefix << message << '\n';
+    }
+}
+
+void Logger::log(const std::string& message, bool toConsole)
+{
+    if (binaryOutput.load(std::memory_order_acquire))
+    {
+        LogArg arg(message);
+        logEventPacked(plainMessageFormat, toConsole, "%s", &arg, 1);
+        return;
+    }
+    Metrics::getInstance() -> logRecords.add();
+
+    auto timestamp = SimulationClock::getInstance() -> wallNow();
+
+    if (asyncEnabled.load(std::memory_order_acquire))
+    {
+        LogRecord record{timestamp, toConsole, message};
+
+        while (!asyncQueue -> tryPush(std::move(record)))
+        {
+            if (overflowPolicy != OverflowPolicy::BLOCK)
+            {
+                Metrics::getInstance() -> logRecordsDropped.add();
+                if (overflowPolicy == OverflowPolicy::COUNT_DROPS)
+                {
+                    droppedCount.fetch_add(1, std::memory_order_relaxed);
+                }
+                return;
+            }
+
+            wakeWriter();
+            std::this_thread::yield();
+        }
+
+        enqueuedCount.fetch_add(1, std::memory_order_release);
+
+        // The writer also wakes on its own every few milliseconds, so producers
+        // only pay for a notification once a sizeable backlog has built up.
+        if (writerWaiting.load(std::memory_order_acquire) &&
+            asyncQueue -> sizeApprox() >= asyncQueue -> capacity() / 8)
+        {
+            wakeWriter();
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    writeEntry(timestamp, message, toConsole);
+
     if (logFile.is_open())
     {
-        logFile << logEntry << std::endl;
         logFile.flush();
     }
-    
+}
+
+void Logger::logEventPacked(uint16_t formatId, bool toConsole, const char* format, const LogArg* args, size_t argCount)
+{
+    // Named after the format, so the timeline shows which statement it was
+    TimelineSpan span("log", format);
+
+    if (!binaryOutput.load(std::memory_order_acquire))
+    {
+        log(formatLogMessage(format, args, argCount), toConsole);
+        return;
+    }
+
+    BinaryLog::getInstance() -> writeEvent(formatId, args, argCount);
+    Metrics::getInstance() -> logRecords.add();
+
     if (toConsole || consoleOutput)
     {
-        std::cout << logEntry << std::endl;
+        std::string message = formatLogMessage(format, args, argCount);
+        auto timestamp = SimulationClock::getInstance() -> wallNow();
+
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cout << formatTimestamp(timestamp) << message << '\n';
+    }
+}
+
+bool Logger::enableSegmentedOutput(const SegmentOptions& options)
+{
+    std::lock_guard<std::mutex> lock(logMutex);
+
+    if (!segments.open(options, SimulationClock::getInstance() -> wallNow()))
+    {
+        std::cerr << "Failed to open log segment " << segments.getSegmentPath() << "\n";
+        return false;
+    }
+
+    if (logFile.is_open())
+    {
+        logFile.close();
+    }
+    return true;
+}
+
+bool Logger::enableBinaryOutput(const std::string& path)
+{
+    if (!BinaryLog::getInstance() -> open(path))
+    {
+        log("Failed to open binary log " + path, true);
+        return false;
+    }
+
+    binaryOutput.store(true, std::memory_order_release);
+    return true;
+}
+
+void Logger::setLevel(LogLevel level)
+{
+    for (auto& categoryLevel : categoryLevels)
+    {
+        categoryLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+    }
+}
+
+void Logger::setLevel(LogCategory category, LogLevel level)
+{
+    categoryLevels[static_cast<size_t>(category)].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel(LogCategory category)
+{
+    return static_cast<LogLevel>(categoryLevels[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+}
+
+const char* Logger::getLevelName(LogLevel level)
+{
+    return levelNames[static_cast<size_t>(level)];
+}
+
+const char* Logger::getCategoryName(LogCategory category)
+{
+    return categoryNames[static_cast<size_t>(category)];
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level)
+{
+    for (size_t i = 0; i <= static_cast<size_t>(LogLevel::OFF); i++)
+    {
+        if (name == levelNames[i])
+        {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
     }
+    return false;
+}
+
+bool Logger::parseCategory(const std::string& name, LogCategory& category)
+{
+    for (size_t i = 0; i < static_cast<size_t>(LogCategory::COUNT); i++)
+    {
+        if (name == categoryNames[i])
+        {
+            category = static_cast<LogCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::setConsoleLevel(LogLevel level)
+{
+    consoleLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
 }
 
 void Logger::setConsoleOutput(bool enabled)
 {
     consoleOutput = enabled;
-}
\ No newline at end of file
+}
+
+void Logger::enableAsync(size_t capacity, OverflowPolicy policy)
+{
+    if (asyncEnabled)
+    {
+        return;
+    }
+
+    asyncQueue = std::make_unique<BoundedMpscQueue<LogRecord>>(capacity);
+    overflowPolicy = policy;
+    writerRunning = true;
+    writerThread = std::thread(&Logger::writerLoop, this);
+    asyncEnabled.store(true, std::memory_order_release);
+}
+
+void Logger::wakeWriter()
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writerCV.notify_one();
+}
+
+void Logger::writerLoop()
+{
+    std::vector<LogRecord> batch;
+    LogRecord record;
+    Timeline::getInstance() -> nameThread("log writer");
+
+    while (true)
+    {
+        batch.clear();
+        while (batch.size() < 1024 && asyncQueue -> tryPop(record))
+        {
+            batch.push_back(std::move(record));
+        }
+
+        if (batch.empty())
+        {
+            std::unique_lock<std::mutex> lock(writerMutex);
+            flushedCV.notify_all();
+
+            if (!writerRunning && asyncQueue -> sizeApprox() == 0)
+            {
+                break;
+            }
+
+            writerWaiting.store(true, std::memory_order_release);
+            writerCV.wait_for(lock, std::chrono::milliseconds(10));
+            writerWaiting.store(false, std::memory_order_release);
+            continue;
+        }
+
+        {
+            TimelineSpan span("log", "write batch");
+            span.setArg(0, "records", static_cast<int64_t>(batch.size()));
+            std::lock_guard<std::mutex> lock(logMutex);
+
+            uint64_t drops = droppedCount.load(std::memory_order_relaxed);
+            if (drops != reportedDrops)
+            {
+                writeEntry(batch.front().timestamp,
+                           "Logger dropped " + std::to_string(drops - reportedDrops) + " records (queue full)", false);
+                reportedDrops = drops;
+            }
+
+            for (const auto& entry : batch)
+            {
+                writeEntry(entry.timestamp, entry.message, entry.toConsole);
+            }
+
+            if (logFile.is_open())
+            {
+                logFile.flush();
+            }
+            std::cout.flush();
+        }
+
+        writtenCount.fetch_add(batch.size(), std::memory_order_release);
+    }
+}
+
+void Logger::flush()
+{
+    if (binaryOutput.load(std::memory_order_acquire))
+    {
+        BinaryLog::getInstance() -> flush();
+    }
+
+    if (!asyncEnabled)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        if (logFile.is_open())
+        {
+            logFile.flush();
+        }
+        segments.flush();
+        return;
+    }
+
+    uint64_t target = enqueuedCount.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(writerMutex);
+    writerCV.notify_one();
+    flushedCV.wait(lock, [this, target]()
+    {
+        return writtenCount.load(std::memory_order_acquire) >= target;
+    });
+    lock.unlock();
+
+    std::lock_guard<std::mutex> logLock(logMutex);
+    segments.flush();
+}
+
+void Logger::shutdown()
+{
+    if (binaryOutput.exchange(false))
+    {
+        BinaryLog::getInstance() -> close();
+    }
+
+    if (!asyncEnabled)
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        segments.close();
+        return;
+    }
+
+    flush();
+    asyncEnabled.store(false, std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writerRunning = false;
+        writerCV.notify_one();
+    }
+
+    if (writerThread.joinable())
+    {
+        writerThread.join();
+    }
+
+    // Producers that raced with the switch back to synchronous mode
+    std::lock_guard<std::mutex> lock(logMutex);
+    LogRecord record;
+    while (asyncQueue -> tryPop(record))
+    {
+        writeEntry(record.timestamp, record.message, record.toConsole);
+    }
+
+    // Closed last: the queued records above still go to the segments
+    segments.close();
+
+    if (logFile.is_open())
+    {
+        logFile.flush();
+    }
+}
+
+bool Logger::isAsync() const
+{
+    return asyncEnabled.load(std::memory_order_acquire);
+}
+
+uint64_t Logger::getDroppedCount() const
+{
+    return droppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,182 @@
+#include "Metrics.hpp"
+#include "DeviceRegistry.hpp"
+#include "TaskManager.hpp"
+#include <algorithm>
+#include <cstdio>
+
+Metrics* Metrics::instance = nullptr;
+std::atomic<size_t> ShardedCounter::nextShard{0};
+
+namespace
+{
+
+// Appends printf-style; every metric line fits the buffer
+template <typename... Args>
+void appendf(std::string& out, const char* format, Args... args)
+{
+    char line[256];
+    int length = std::snprintf(line, sizeof(line), format, args...);
+    if (length > 0)
+    {
+        out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+    }
+}
+
+void appendHeader(std::string& out, const char* name, const char* type, const char* help)
+{
+    appendf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void appendLabel(std::string& out, const char* label, const std::string& value)
+{
+    out.append(label).append("=\"");
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if (c == '\n')
+        {
+            out.append("\\n");
+        }
+        else
+        {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+void appendSample(std::string& out, const char* name, const char* label, const std::string& value, uint64_t sample)
+{
+    out.append(name).push_back('{');
+    appendLabel(out, label, value);
+    appendf(out, "} %llu\n", static_cast<unsigned long long>(sample));
+}
+
+// Latency histograms are exposed as summaries in seconds
+void appendSummary(std::string& out, const char* name, const std::string& task,
+                   const LatencyHistogram::Summary& summary)
+{
+    const std::pair<const char*, uint64_t> quantiles[] = {{"0.5", summary.p50}, {"0.99", summary.p99},
+                                                          {"0.999", summary.p999}};
+    for (const auto& [quantile, nanos] : quantiles)
+    {
+        out.append(name).push_back('{');
+        appendLabel(out, "task", task);
+        appendf(out, ",quantile=\"%s\"} %.9g\n", quantile, nanos / 1e9);
+    }
+
+    out.append(name).append("_sum{");
+    appendLabel(out, "task", task);
+    appendf(out, "} %.9g\n", summary.mean * summary.count / 1e9);
+    out.append(name).append("_count{");
+    appendLabel(out, "task", task);
+    appendf(out, "} %llu\n", static_cast<unsigned long long>(summary.count));
+}
+
+}
+
+uint64_t ShardedCounter::load() const
+{
+    uint64_t sum = 0;
+    for (const Shard& shard : shards)
+    {
+        sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+Metrics* Metrics::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new Metrics();
+    }
+
+    return instance;
+}
+
+void Metrics::registerTask(const Task* task)
+{
+    std::lock_guard<std::mutex> lock(sourcesMutex);
+    tasks.push_back(task);
+}
+
+void Metrics::registerDeviceTable(const std::string& type, const DeviceTable* table)
+{
+    std::lock_guard<std::mutex> lock(sourcesMutex);
+    deviceTables.emplace_back(type, table);
+}
+
+void Metrics::render(std::string& out) const
+{
+    out.clear();
+    std::lock_guard<std::mutex> lock(sourcesMutex);
+
+    appendHeader(out, "smart_home_tasks", "gauge", "Tasks registered with the scheduler.");
+    appendf(out, "smart_home_tasks %zu\n", tasks.size());
+
+    appendHeader(out, "smart_home_scheduler_wakeups_total", "counter", "Times the scheduler thread woke up.");
+    appendf(out, "smart_home_scheduler_wakeups_total %llu\n",
+            static_cast<unsigned long long>(TaskManager::getInstance() -> getWakeupCount()));
+
+    appendHeader(out, "smart_home_task_executions_total", "counter", "Completed executions per task.");
+    for (const Task* task : tasks)
+    {
+        appendSample(out, "smart_home_task_executions_total", "task", task -> getName(),
+                     task -> metrics.executions.load(std::memory_order_relaxed));
+    }
+
+    appendHeader(out, "smart_home_task_exceptions_total", "counter", "Executions per task that threw.");
+    for (const Task* task : tasks)
+    {
+        appendSample(out, "smart_home_task_exceptions_total", "task", task -> getName(),
+                     task -> metrics.exceptions.load(std::memory_order_relaxed));
+    }
+
+    appendHeader(out, "smart_home_task_deadline_misses_total", "counter",
+                 "Releases per task that missed their deadline.");
+    for (const Task* task : tasks)
+    {
+        appendSample(out, "smart_home_task_deadline_misses_total", "task", task -> getName(),
+                     task -> deadlineCounters.deadlineMisses.load(std::memory_order_relaxed));
+    }
+
+    appendHeader(out, "smart_home_task_dispatch_latency_seconds", "summary",
+                 "Time from a task's release to the start of its execution.");
+    for (const Task* task : tasks)
+    {
+        appendSummary(out, "smart_home_task_dispatch_latency_seconds", task -> getName(),
+                      task -> metrics.dispatchLatency.summarize());
+    }
+
+    appendHeader(out, "smart_home_task_execution_seconds", "summary", "Execution time per task.");
+    for (const Task* task : tasks)
+    {
+        appendSummary(out, "smart_home_task_execution_seconds", task -> getName(),
+                      task -> metrics.executionTime.summarize());
+    }
+
+    appendHeader(out, "smart_home_device_state_changes_total", "counter", "Device state changes per device type.");
+    for (const auto& [type, table] : deviceTables)
+    {
+        appendSample(out, "smart_home_device_state_changes_total", "type", type, table -> getStateChangeCount());
+    }
+
+    appendHeader(out, "smart_home_blinds_cooldown_rejections_total", "counter",
+                 "Blind moves refused because the blind moved too recently.");
+    appendf(out, "smart_home_blinds_cooldown_rejections_total %llu\n",
+            static_cast<unsigned long long>(blindsCooldownRejections.load()));
+
+    appendHeader(out, "smart_home_log_records_total", "counter",
+                 "Log records produced, including dropped ones; rate() gives lines per second.");
+    appendf(out, "smart_home_log_records_total %llu\n", static_cast<unsigned long long>(logRecords.load()));
+
+    appendHeader(out, "smart_home_log_dropped_records_total", "counter",
+                 "Log records discarded because the asynchronous queue was full.");
+    appendf(out, "smart_home_log_dropped_records_total %llu\n",
+            static_cast<unsigned long long>(logRecordsDropped.load()));
+}
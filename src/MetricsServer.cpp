@@ -0,0 +1,237 @@
+#include "MetricsServer.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Timeline.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+MetricsServer* MetricsServer::instance = nullptr;
+
+namespace
+{
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const SocketHandle NO_SOCKET = INVALID_SOCKET;
+const int SEND_FLAGS = 0;
+
+void closeSocket(SocketHandle socket)
+{
+    closesocket(socket);
+}
+
+std::string socketError()
+{
+    return "error " + std::to_string(WSAGetLastError());
+}
+#else
+using SocketHandle = int;
+const SocketHandle NO_SOCKET = -1;
+// A scraper that hangs up early must not kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+void closeSocket(SocketHandle socket)
+{
+    close(socket);
+}
+
+std::string socketError()
+{
+    return std::strerror(errno);
+}
+#endif
+
+bool sendAll(SocketHandle socket, const std::string& data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        int chunk = static_cast<int>(std::min<size_t>(data.size() - sent, 1 << 20));
+        int written = static_cast<int>(send(socket, data.data() + sent, chunk, SEND_FLAGS));
+        if (written <= 0)
+        {
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+}
+
+MetricsServer* MetricsServer::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new MetricsServer();
+    }
+
+    return instance;
+}
+
+bool MetricsServer::start(uint16_t listenPort, std::string& error)
+{
+    if (isRunning())
+    {
+        error = "metrics server already running on port " + std::to_string(port);
+        return false;
+    }
+
+#ifdef _WIN32
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+    {
+        error = "cannot initialize Winsock";
+        return false;
+    }
+#endif
+
+    SocketHandle socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket == NO_SOCKET)
+    {
+        error = "cannot create socket: " + socketError();
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(listenPort);
+    socklen_t length = sizeof(address);
+
+    if (bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(socket, 8) != 0 ||
+        getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        error = "cannot listen on 127.0.0.1:" + std::to_string(listenPort) + ": " + socketError();
+        closeSocket(socket);
+        return false;
+    }
+
+    listener = static_cast<intptr_t>(socket);
+    port = ntohs(address.sin_port);
+    stopping = false;
+    server = std::thread(&MetricsServer::run, this);
+    LOG_INFO(SYSTEM, "Serving metrics at http://127.0.0.1:%u/metrics", port);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    stopping = true;
+    server.join();
+    closeSocket(static_cast<SocketHandle>(listener));
+    listener = -1;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void MetricsServer::run()
+{
+    Timeline::getInstance() -> nameThread("metrics");
+    SocketHandle socket = static_cast<SocketHandle>(listener);
+    // Reused across scrapes
+    std::string body;
+    std::string response;
+
+    while (!stopping.load())
+    {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(socket, &readable);
+        timeval timeout{0, POLL_MILLIS * 1000};
+
+        if (select(static_cast<int>(socket) + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+        {
+            continue;
+        }
+
+        SocketHandle connection = accept(socket, nullptr, nullptr);
+        if (connection == NO_SOCKET)
+        {
+            continue;
+        }
+        serve(static_cast<intptr_t>(connection), body, response);
+        closeSocket(connection);
+    }
+}
+
+void MetricsServer::serve(intptr_t connection, std::string& body, std::string& response)
+{
+    SocketHandle socket = static_cast<SocketHandle>(connection);
+
+#ifdef _WIN32
+    DWORD timeout = RECEIVE_TIMEOUT_MILLIS;
+#else
+    timeval timeout{RECEIVE_TIMEOUT_MILLIS / 1000, RECEIVE_TIMEOUT_MILLIS % 1000 * 1000};
+#endif
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+
+    // Only the request line matters; the rest of the header is read and
+    // ignored so that the client sees an orderly close
+    char request[4096];
+    size_t received = 0;
+    while (received < sizeof(request) - 1)
+    {
+        int space = static_cast<int>(sizeof(request) - 1 - received);
+        int read = static_cast<int>(recv(socket, request + received, space, 0));
+        if (read <= 0)
+        {
+            return;
+        }
+        received += static_cast<size_t>(read);
+        request[received] = '\0';
+        if (std::strstr(request, "\r\n\r\n") != nullptr || std::strstr(request, "\n\n") != nullptr)
+        {
+            break;
+        }
+    }
+
+    const char* status = "200 OK";
+    if (std::strncmp(request, "GET /metrics ", 13) == 0 || std::strncmp(request, "GET / ", 6) == 0)
+    {
+        Metrics::getInstance() -> render(body);
+        scrapes.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (std::strncmp(request, "GET ", 4) == 0)
+    {
+        status = "404 Not Found";
+        body = "Metrics are served at /metrics\n";
+    }
+    else
+    {
+        status = "405 Method Not Allowed";
+        body = "Only GET is supported\n";
+    }
+
+    response = std::string("HTTP/1.1 ") + status +
+               "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+    response += body;
+    sendAll(socket, response);
+}
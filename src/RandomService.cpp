@@ -0,0 +1,121 @@
+#include "RandomService.hpp"
+#include <cmath>
+#include <random>
+
+RandomService* RandomService::instance = nullptr;
+
+Xoshiro256pp::Xoshiro256pp(uint64_t seed)
+{
+    // Expanding the seed with SplitMix64 never yields the all-zero state
+    for (auto& word : state)
+    {
+        word = RandomService::splitMix64(seed);
+    }
+}
+
+int Xoshiro256pp::uniformInt(int low, int high)
+{
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(high) - low) + 1;
+    // Multiply-shift range reduction on the top 32 bits; the bias is
+    // negligible for the small ranges the simulation uses
+    uint64_t scaled = (((*this)() >> 32) * range) >> 32;
+    return static_cast<int>(low + static_cast<int64_t>(scaled));
+}
+
+float Xoshiro256pp::normal(float mean, float stddev)
+{
+    if (hasSpareNormal)
+    {
+        hasSpareNormal = false;
+        return mean + stddev * spareNormal;
+    }
+
+    float value;
+    fillNormal(&value, 1, 0.0f, 1.0f);
+    return mean + stddev * value;
+}
+
+void Xoshiro256pp::fillUniform(float* out, size_t count, float low, float high)
+{
+    float scale = (high - low) * (1.0f / 16777216.0f);
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = low + static_cast<float>((*this)() >> 40) * scale;
+    }
+}
+
+void Xoshiro256pp::fillNormal(float* out, size_t count, float mean, float stddev)
+{
+    // Box-Muller, two variates per pair of uniforms; one 64-bit output
+    // supplies both uniforms
+    const float twoPi = 6.28318530718f;
+    size_t i = 0;
+
+    while (i < count)
+    {
+        uint64_t bits = (*this)();
+        float u1 = (static_cast<float>(bits >> 40) + 1.0f) * (1.0f / 16777217.0f);
+        float u2 = static_cast<float>((bits >> 16) & 0xFFFFFF) * (1.0f / 16777216.0f);
+        float radius = std::sqrt(-2.0f * std::log(u1));
+
+        out[i++] = mean + stddev * radius * std::cos(twoPi * u2);
+        float other = radius * std::sin(twoPi * u2);
+
+        if (i < count)
+        {
+            out[i++] = mean + stddev * other;
+        }
+        else
+        {
+            spareNormal = other;
+            hasSpareNormal = true;
+        }
+    }
+}
+
+RandomService::RandomService()
+{
+    std::random_device rd;
+    masterSeed = (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+RandomService* RandomService::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new RandomService();
+    }
+
+    return instance;
+}
+
+void RandomService::setMasterSeed(uint64_t seed)
+{
+    masterSeed = seed;
+}
+
+uint64_t RandomService::getMasterSeed() const
+{
+    return masterSeed;
+}
+
+Xoshiro256pp RandomService::createStream(const std::string& streamName) const
+{
+    // FNV-1a of the name, mixed with the master seed
+    uint64_t streamHash = 14695981039346656037ull;
+    for (char c : streamName)
+    {
+        streamHash = (streamHash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+
+    uint64_t mix = masterSeed ^ streamHash;
+    return Xoshiro256pp(splitMix64(mix));
+}
+
+uint64_t RandomService::splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
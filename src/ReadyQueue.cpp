@@ -0,0 +1,128 @@
+#include "ReadyQueue.hpp"
+#include "TaskManager.hpp"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+int ReadyQueue::clampPriority(int priority)
+{
+    return std::max(0, std::min(PRIORITY_LEVELS - 1, priority));
+}
+
+int ReadyQueue::highestSetBit(uint64_t bitmap)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, bitmap);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(bitmap);
+#endif
+}
+
+void ReadyQueue::push(Task* task)
+{
+    if (task -> inReadyQueue)
+    {
+        return;
+    }
+
+    Level& level = levels[task -> schedulingPriority];
+
+    task -> readyNext = nullptr;
+    task -> readyPrev = level.tail;
+
+    if (level.tail != nullptr)
+    {
+        level.tail -> readyNext = task;
+    }
+    else
+    {
+        level.head = task;
+        readyBitmap |= (uint64_t{1} << task -> schedulingPriority);
+    }
+
+    level.tail = task;
+    task -> inReadyQueue = true;
+    count++;
+}
+
+void ReadyQueue::remove(Task* task)
+{
+    if (!task -> inReadyQueue)
+    {
+        return;
+    }
+
+    Level& level = levels[task -> schedulingPriority];
+
+    if (task -> readyPrev != nullptr)
+    {
+        task -> readyPrev -> readyNext = task -> readyNext;
+    }
+    else
+    {
+        level.head = task -> readyNext;
+    }
+
+    if (task -> readyNext != nullptr)
+    {
+        task -> readyNext -> readyPrev = task -> readyPrev;
+    }
+    else
+    {
+        level.tail = task -> readyPrev;
+    }
+
+    if (level.head == nullptr)
+    {
+        readyBitmap &= ~(uint64_t{1} << task -> schedulingPriority);
+    }
+
+    task -> readyNext = nullptr;
+    task -> readyPrev = nullptr;
+    task -> inReadyQueue = false;
+    count--;
+}
+
+Task* ReadyQueue::peekHighest() const
+{
+    if (readyBitmap == 0)
+    {
+        return nullptr;
+    }
+
+    return levels[highestSetBit(readyBitmap)].head;
+}
+
+Task* ReadyQueue::popHighest()
+{
+    Task* task = peekHighest();
+
+    if (task != nullptr)
+    {
+        remove(task);
+    }
+
+    return task;
+}
+
+bool ReadyQueue::empty() const
+{
+    return readyBitmap == 0;
+}
+
+size_t ReadyQueue::size() const
+{
+    return count;
+}
+
+void ReadyQueue::clear()
+{
+    while (Task* task = popHighest())
+    {
+        (void)task;
+    }
+}
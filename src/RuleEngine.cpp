@@ -0,0 +1,673 @@
+#include "RuleEngine.hpp"
+#include "EventBus.hpp"
+#include "LightController.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Timeline.hpp"
+#include "WindowBlindController.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+RuleEngine* RuleEngine::instance = nullptr;
+
+namespace
+{
+
+std::vector<std::string> splitWords(const std::string& text)
+{
+    std::istringstream stream(text);
+    std::vector<std::string> words;
+    std::string word;
+    while (stream >> word)
+    {
+        words.push_back(word);
+    }
+    return words;
+}
+
+std::string trim(const std::string& text)
+{
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+    {
+        return "";
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+bool parseCompareOp(const std::string& token, CompareOp& op)
+{
+    if (token == "<")
+    {
+        op = CompareOp::LESS;
+    }
+    else if (token == "<=")
+    {
+        op = CompareOp::LESS_EQUAL;
+    }
+    else if (token == ">")
+    {
+        op = CompareOp::GREATER;
+    }
+    else if (token == ">=")
+    {
+        op = CompareOp::GREATER_EQUAL;
+    }
+    else if (token == "==")
+    {
+        op = CompareOp::EQUAL;
+    }
+    else if (token == "!=")
+    {
+        op = CompareOp::NOT_EQUAL;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool parseNumber(const std::string& token, float& value)
+{
+    char* end = nullptr;
+    value = std::strtof(token.c_str(), &end);
+    return !token.empty() && *end == '\0';
+}
+
+bool parseIdList(const std::string& token, std::vector<int>& ids)
+{
+    std::istringstream stream(token);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        char* end = nullptr;
+        long id = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0')
+        {
+            return false;
+        }
+        ids.push_back(static_cast<int>(id));
+    }
+    return !ids.empty();
+}
+
+bool parseLightState(const std::string& token, uint8_t& state)
+{
+    if (token == "on")
+    {
+        state = static_cast<uint8_t>(LightState::ON);
+    }
+    else if (token == "off")
+    {
+        state = static_cast<uint8_t>(LightState::OFF);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool parseBlindPosition(const std::string& token, uint8_t& level)
+{
+    if (token == "closed")
+    {
+        level = static_cast<uint8_t>(BlindsPosition::CLOSED);
+    }
+    else if (token == "quarter_open")
+    {
+        level = static_cast<uint8_t>(BlindsPosition::QUARTER_OPEN);
+    }
+    else if (token == "half_open")
+    {
+        level = static_cast<uint8_t>(BlindsPosition::HALF_OPEN);
+    }
+    else if (token == "three_quarters_open")
+    {
+        level = static_cast<uint8_t>(BlindsPosition::THREE_QUARTERS_OPEN);
+    }
+    else if (token == "open")
+    {
+        level = static_cast<uint8_t>(BlindsPosition::OPEN);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// The inputs documented in config/rules.conf; anything else is a typo that
+// would leave the rule waiting on an input nobody sets
+bool isKnownInput(const std::string& name)
+{
+    if (name == "hour" || name == "outdoor_light" || name == "temperature")
+    {
+        return true;
+    }
+
+    size_t dot = name.find('.');
+    if (dot == std::string::npos || dot + 1 == name.size())
+    {
+        return false;
+    }
+    std::string kind = name.substr(0, dot);
+    return (kind == "motion" || kind == "chance") &&
+           name.find_first_not_of("0123456789", dot + 1) == std::string::npos;
+}
+
+bool compare(float value, CompareOp op, float threshold)
+{
+    switch (op)
+    {
+        case CompareOp::LESS: return value < threshold;
+        case CompareOp::LESS_EQUAL: return value <= threshold;
+        case CompareOp::GREATER: return value > threshold;
+        case CompareOp::GREATER_EQUAL: return value >= threshold;
+        case CompareOp::EQUAL: return value == threshold;
+        case CompareOp::NOT_EQUAL: return value != threshold;
+    }
+    return false;
+}
+
+}
+
+RuleEngine::RuleEngine() : ruleSet(std::make_shared<RuleSet>())
+{
+}
+
+RuleEngine* RuleEngine::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new RuleEngine();
+    }
+
+    return instance;
+}
+
+RuleInputId RuleEngine::getInput(const std::string& inputName)
+{
+    std::lock_guard<std::mutex> lock(engineMutex);
+
+    auto found = inputIds.find(inputName);
+    if (found != inputIds.end())
+    {
+        return found -> second;
+    }
+
+    RuleInputId input = static_cast<RuleInputId>(inputNames.size());
+    inputIds.emplace(inputName, input);
+    inputNames.push_back(inputName);
+    inputValues.push_back(0.0f);
+    inputKnown.push_back(0);
+    return input;
+}
+
+void RuleEngine::markPendingLocked(uint32_t rule)
+{
+    if (!pending[rule])
+    {
+        pending[rule] = 1;
+        pendingRules.push_back(rule);
+    }
+}
+
+void RuleEngine::setInputLocked(RuleInputId input, float value)
+{
+    if (input >= inputValues.size() || (inputKnown[input] && inputValues[input] == value))
+    {
+        return;
+    }
+
+    inputValues[input] = value;
+    inputKnown[input] = 1;
+    inputChanges++;
+
+    if (input < ruleSet -> dependents.size())
+    {
+        for (uint32_t rule : ruleSet -> dependents[input])
+        {
+            markPendingLocked(rule);
+        }
+    }
+}
+
+void RuleEngine::setInput(RuleInputId input, float value)
+{
+    std::lock_guard<std::mutex> lock(engineMutex);
+    setInputLocked(input, value);
+}
+
+void RuleEngine::setInputs(const RuleInputId* inputs, const float* values, size_t count)
+{
+    std::lock_guard<std::mutex> lock(engineMutex);
+    for (size_t i = 0; i < count; i++)
+    {
+        setInputLocked(inputs[i], values[i]);
+    }
+}
+
+void RuleEngine::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(engineMutex);
+    for (uint32_t rule = 0; rule < ruleSet -> rules.size(); rule++)
+    {
+        markPendingLocked(rule);
+    }
+}
+
+bool RuleEngine::conditionHolds(const Rule& rule) const
+{
+    for (const auto& clause : rule.clauses)
+    {
+        bool holds = true;
+        for (const RuleComparison& comparison : clause)
+        {
+            if (!inputKnown[comparison.input] ||
+                !compare(inputValues[comparison.input], comparison.op, comparison.threshold))
+            {
+                holds = false;
+                break;
+            }
+        }
+
+        if (holds)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool RuleEngine::fire(const Rule& rule)
+{
+    const RuleAction action = rule.action;
+    EventBus* bus = EventBus::getInstance();
+
+    if (action.command == RuleCommand::BLIND_POSITION)
+    {
+        GroupResult result = rule.targets.apply([action](DeviceState& blind, uint32_t nowMillis)
+        {
+            if ((action.guarded && blind.level != action.guardValue) || blind.level == action.level)
+            {
+                return GroupOutcome::UNCHANGED;
+            }
+            if (blind.millisSinceChange(nowMillis) < static_cast<uint32_t>(WindowBlindController::MOVE_COOLDOWN_MS))
+            {
+                return GroupOutcome::HELD_BY_COOLDOWN;
+            }
+
+            blind.level = action.level;
+            blind.lastChangeMillis = nowMillis;
+            return GroupOutcome::CHANGED;
+        });
+
+        if (result.changed.size() == 1)
+        {
+            LOG_INFO(BLINDS, "Rule %s: window %d blinds moving to %d%%", rule.name, result.changed.front(),
+                     static_cast<int>(action.level));
+        }
+        else if (!result.changed.empty() || !result.heldByCooldown.empty())
+        {
+            LOG_INFO(BLINDS, "Rule %s: moving %u blinds to %d%% (%u held by cooldown)", rule.name,
+                     result.changed.size(), static_cast<int>(action.level), result.heldByCooldown.size());
+        }
+        Metrics::getInstance() -> blindsCooldownRejections.add(result.heldByCooldown.size());
+        WindowBlindController::publishGroupChange(result, action.level);
+        return !result.heldByCooldown.empty();
+    }
+
+    // Turning on leaves a light that is already on at its brightness
+    const bool turnOn = action.command == RuleCommand::LIGHT_ON;
+    const uint8_t targetState = static_cast<uint8_t>(turnOn ? LightState::ON : LightState::OFF);
+    const uint8_t targetLevel = static_cast<uint8_t>(turnOn ? LightBrightness::MEDIUM : LightBrightness::OFF);
+
+    GroupResult result = rule.targets.apply([action, targetState, targetLevel](DeviceState& light, uint32_t nowMillis)
+    {
+        if ((action.guarded && light.state != action.guardValue) || light.state == targetState)
+        {
+            return GroupOutcome::UNCHANGED;
+        }
+
+        light.state = targetState;
+        light.level = targetLevel;
+        light.lastChangeMillis = nowMillis;
+        return GroupOutcome::CHANGED;
+    });
+
+    if (result.changed.size() == 1)
+    {
+        LOG_INFO(LIGHTS, "Rule %s: light in room %d turned %s", rule.name, result.changed.front(),
+                 turnOn ? "ON" : "OFF");
+    }
+    else if (!result.changed.empty())
+    {
+        LOG_INFO(LIGHTS, "Rule %s: turned %s %u lights", rule.name, turnOn ? "ON" : "OFF", result.changed.size());
+    }
+
+    if (bus -> hasSubscribers(EventTopic::DEVICE_STATE_CHANGE))
+    {
+        for (int roomId : result.changed)
+        {
+            bus -> publish(DeviceStateChanged{DeviceType::LIGHT, roomId, targetState, targetLevel});
+        }
+    }
+    return false;
+}
+
+size_t RuleEngine::evaluate()
+{
+    TimelineSpan span("rules", "rule pass");
+    std::lock_guard<std::mutex> lock(engineMutex);
+
+    if (pendingRules.empty())
+    {
+        return 0;
+    }
+
+    // File order, so that a later rule can override an earlier one
+    evaluationBatch.swap(pendingRules);
+    pendingRules.clear();
+    std::sort(evaluationBatch.begin(), evaluationBatch.end());
+
+    for (uint32_t rule : evaluationBatch)
+    {
+        pending[rule] = 0;
+    }
+
+    std::vector<uint32_t> held;
+    for (uint32_t rule : evaluationBatch)
+    {
+        ruleEvaluations[rule]++;
+        const Rule& compiled = ruleSet -> rules[rule];
+
+        if (conditionHolds(compiled))
+        {
+            ruleFirings[rule]++;
+            firings++;
+            if (fire(compiled))
+            {
+                held.push_back(rule);
+            }
+        }
+    }
+
+    for (uint32_t rule : held)
+    {
+        markPendingLocked(rule);
+    }
+
+    size_t evaluated = evaluationBatch.size();
+    evaluations += evaluated;
+    span.setArg(0, "evaluated", static_cast<int64_t>(evaluated));
+    span.setArg(1, "held", static_cast<int64_t>(held.size()));
+    return evaluated;
+}
+
+bool RuleEngine::compile(const std::string& text, const std::string& source, RuleSet& compiled, std::string& error)
+{
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+    std::unordered_set<std::string> names;
+
+    auto fail = [&](const std::string& message)
+    {
+        error = source + ":" + std::to_string(lineNumber) + ": " + message;
+        return false;
+    };
+
+    compiled.source = source;
+
+    while (std::getline(lines, line))
+    {
+        lineNumber++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+        {
+            continue;
+        }
+
+        size_t colon = line.find(':');
+        size_t arrow = line.find("->");
+        if (line.compare(0, 5, "rule ") != 0 || colon == std::string::npos || arrow == std::string::npos || arrow < colon)
+        {
+            return fail("expected 'rule <name>: <condition> -> <action>'");
+        }
+
+        std::string name = trim(line.substr(5, colon - 5));
+        if (name.empty() || name.find(' ') != std::string::npos)
+        {
+            return fail("rule name must be a single word");
+        }
+        if (!names.insert(name).second)
+        {
+            return fail("duplicate rule '" + name + "'");
+        }
+
+        // Condition: <input> <op> <number>, joined by "and" / "or"
+        std::vector<std::string> condition = splitWords(line.substr(colon + 1, arrow - colon - 1));
+        std::vector<std::vector<RuleComparison>> clauses(1);
+        for (size_t i = 0; i < condition.size(); i += 4)
+        {
+            RuleComparison comparison{};
+            float threshold = 0.0f;
+            if (i + 2 >= condition.size() || !parseCompareOp(condition[i + 1], comparison.op) ||
+                !parseNumber(condition[i + 2], threshold))
+            {
+                return fail("expected '<input> <op> <number>' in condition");
+            }
+            if (!isKnownInput(condition[i]))
+            {
+                return fail("unknown input '" + condition[i] + "'");
+            }
+            comparison.input = getInput(condition[i]);
+            comparison.threshold = threshold;
+            clauses.back().push_back(comparison);
+
+            if (i + 3 < condition.size())
+            {
+                if (condition[i + 3] == "or")
+                {
+                    clauses.emplace_back();
+                }
+                else if (condition[i + 3] != "and")
+                {
+                    return fail("expected 'and' or 'or', got '" + condition[i + 3] + "'");
+                }
+                if (i + 4 >= condition.size())
+                {
+                    return fail("expected a comparison after '" + condition[i + 3] + "'");
+                }
+            }
+        }
+        if (clauses.back().empty())
+        {
+            return fail("empty condition");
+        }
+
+        // Action: <lights|blinds> <all|all-except ids|ids> <command> [when <state>]
+        std::vector<std::string> words = splitWords(line.substr(arrow + 2));
+        if (words.size() < 3)
+        {
+            return fail("expected '<lights|blinds> <targets> <command>'");
+        }
+
+        DeviceType type;
+        if (words[0] == "lights")
+        {
+            type = DeviceType::LIGHT;
+        }
+        else if (words[0] == "blinds")
+        {
+            type = DeviceType::BLIND;
+        }
+        else
+        {
+            return fail("unknown device type '" + words[0] + "'");
+        }
+
+        size_t next = 1;
+        std::vector<int> ids;
+        bool every = words[next] == "all";
+        if (words[next] == "all-except")
+        {
+            every = true;
+            next++;
+            if (next >= words.size() || !parseIdList(words[next], ids))
+            {
+                return fail("expected a comma-separated ID list after 'all-except'");
+            }
+        }
+        else if (!every && !parseIdList(words[next], ids))
+        {
+            return fail("expected 'all', 'all-except <ids>' or a comma-separated ID list");
+        }
+        next++;
+
+        RuleAction action;
+        auto parseState = [type](const std::string& token, uint8_t& value)
+        {
+            return type == DeviceType::LIGHT ? parseLightState(token, value) : parseBlindPosition(token, value);
+        };
+
+        uint8_t value = 0;
+        if (next >= words.size() || !parseState(words[next], value))
+        {
+            return fail(type == DeviceType::LIGHT ? "expected 'on' or 'off'" : "expected a blind position");
+        }
+        if (type == DeviceType::LIGHT)
+        {
+            action.command = value == static_cast<uint8_t>(LightState::ON) ? RuleCommand::LIGHT_ON : RuleCommand::LIGHT_OFF;
+        }
+        else
+        {
+            action.command = RuleCommand::BLIND_POSITION;
+            action.level = value;
+        }
+        next++;
+
+        if (next < words.size())
+        {
+            if (words[next] != "when" || next + 2 != words.size() || !parseState(words[next + 1], action.guardValue))
+            {
+                return fail("expected 'when <state>' at the end of the action");
+            }
+            action.guarded = true;
+        }
+
+        DeviceGroup targets = !every ? DeviceGroup(name, type, std::move(ids))
+                                     : DeviceGroup::allExcept(name, type, std::move(ids));
+        compiled.rules.push_back(Rule{name, std::move(clauses), std::move(targets), action, lineNumber});
+    }
+
+    // Dependency index: each rule is listed once under every input it reads
+    for (uint32_t rule = 0; rule < compiled.rules.size(); rule++)
+    {
+        for (const auto& clause : compiled.rules[rule].clauses)
+        {
+            for (const RuleComparison& comparison : clause)
+            {
+                if (comparison.input >= compiled.dependents.size())
+                {
+                    compiled.dependents.resize(comparison.input + 1);
+                }
+
+                auto& list = compiled.dependents[comparison.input];
+                if (list.empty() || list.back() != rule)
+                {
+                    list.push_back(rule);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool RuleEngine::loadText(const std::string& text, const std::string& source, std::string& error)
+{
+    auto compiled = std::make_shared<RuleSet>();
+    if (!compile(text, source, *compiled, error))
+    {
+        LOG_ERROR(SYSTEM, "Rules not loaded, keeping the current set: %s", error);
+        return false;
+    }
+
+    size_t ruleCount = compiled -> rules.size();
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        ruleSet = std::move(compiled);
+        pending.assign(ruleCount, 0);
+        pendingRules.clear();
+        ruleEvaluations.assign(ruleCount, 0);
+        ruleFirings.assign(ruleCount, 0);
+        reloads++;
+
+        // The new rules see the current inputs on the next evaluate()
+        for (uint32_t rule = 0; rule < ruleCount; rule++)
+        {
+            markPendingLocked(rule);
+        }
+    }
+
+    LOG_INFO(SYSTEM, "Loaded %u rules from %s", ruleCount, source);
+    return true;
+}
+
+bool RuleEngine::loadFile(const std::string& path, std::string& error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "cannot open " + path;
+        LOG_ERROR(SYSTEM, "Rules not loaded, keeping the current set: %s", error);
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    return loadText(text.str(), path, error);
+}
+
+bool RuleEngine::reload(std::string& error)
+{
+    std::string source;
+    {
+        std::lock_guard<std::mutex> lock(engineMutex);
+        source = ruleSet -> source;
+    }
+
+    if (source.empty())
+    {
+        error = "no rule file loaded";
+        return false;
+    }
+    return loadFile(source, error);
+}
+
+size_t RuleEngine::getRuleCount() const
+{
+    std::lock_guard<std::mutex> lock(engineMutex);
+    return ruleSet -> rules.size();
+}
+
+RuleEngine::Statistics RuleEngine::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(engineMutex);
+
+    Statistics statistics{ruleSet -> source, inputNames.size(), inputChanges, evaluations, firings, reloads, {}};
+    for (size_t rule = 0; rule < ruleSet -> rules.size(); rule++)
+    {
+        statistics.rules.push_back({ruleSet -> rules[rule].name, ruleEvaluations[rule], ruleFirings[rule]});
+    }
+
+    return statistics;
+}
@@ -0,0 +1,235 @@
+#include "SegmentedLogWriter.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+SegmentedLogWriter::~SegmentedLogWriter()
+{
+    close();
+}
+
+std::string SegmentedLogWriter::segmentPath(uint64_t index) const
+{
+    char number[24];
+    std::snprintf(number, sizeof(number), ".%06llu", static_cast<unsigned long long>(index));
+    return options.baseName + number + options.extension;
+}
+
+uint64_t SegmentedLogWriter::findLastSegmentIndex() const
+{
+    namespace fs = std::filesystem;
+
+    fs::path base(options.baseName);
+    fs::path directory = base.has_parent_path() ? base.parent_path() : fs::path(".");
+    std::string prefix = base.filename().string() + ".";
+    uint64_t lastIndex = 0;
+    std::error_code error;
+
+    for (const auto& entry : fs::directory_iterator(directory, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.size() <= prefix.size() + options.extension.size() ||
+            name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - options.extension.size(), options.extension.size(), options.extension) != 0)
+        {
+            continue;
+        }
+
+        std::string digits = name.substr(prefix.size(), name.size() - prefix.size() - options.extension.size());
+        if (digits.find_first_not_of("0123456789") == std::string::npos)
+        {
+            lastIndex = std::max<uint64_t>(lastIndex, std::stoull(digits));
+        }
+    }
+
+    return lastIndex;
+}
+
+bool SegmentedLogWriter::open(const SegmentOptions& segmentOptions, std::chrono::system_clock::time_point now)
+{
+    close();
+
+    options = segmentOptions;
+    segmentIndex = findLastSegmentIndex();
+    opened = openSegment(now);
+    return opened;
+}
+
+bool SegmentedLogWriter::openSegment(std::chrono::system_clock::time_point now)
+{
+    segmentIndex++;
+    writeOffset = 0;
+    segmentOpenedAt = now;
+    std::string path = segmentPath(segmentIndex);
+
+#ifdef _WIN32
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Reserve the blocks up front so that page faults never hit ENOSPC
+    // (which would be a SIGBUS on a mapping) in the middle of a segment.
+    bool allocated;
+#ifdef __linux__
+    allocated = ::posix_fallocate(fd, 0, static_cast<off_t>(options.segmentSize)) == 0;
+#else
+    allocated = ::ftruncate(fd, static_cast<off_t>(options.segmentSize)) == 0;
+#endif
+
+    void* address = allocated
+        ? ::mmap(nullptr, options.segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+
+    if (address == MAP_FAILED)
+    {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    mapping = static_cast<char*>(address);
+#endif
+
+    removeExpiredSegments();
+    return true;
+}
+
+void SegmentedLogWriter::closeSegment()
+{
+#ifdef _WIN32
+    if (file != nullptr)
+    {
+        std::fclose(file);
+        file = nullptr;
+    }
+#else
+    if (mapping != nullptr)
+    {
+        ::munmap(mapping, options.segmentSize);
+        mapping = nullptr;
+    }
+
+    if (fd >= 0)
+    {
+        // Drop the unused preallocated tail so the file ends at the last line
+        if (::ftruncate(fd, static_cast<off_t>(writeOffset)) != 0)
+        {
+            std::perror("SegmentedLogWriter: ftruncate");
+        }
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+void SegmentedLogWriter::removeExpiredSegments()
+{
+    if (options.retainedSegments == 0 || segmentIndex <= options.retainedSegments)
+    {
+        return;
+    }
+
+    // Only the segment that just fell out of the window is normally present;
+    // walk back until a gap in case retention was lowered between runs.
+    std::error_code error;
+    for (uint64_t index = segmentIndex - options.retainedSegments; index > 0; index--)
+    {
+        if (!std::filesystem::remove(segmentPath(index), error))
+        {
+            break;
+        }
+    }
+}
+
+void SegmentedLogWriter::close()
+{
+    if (!opened)
+    {
+        return;
+    }
+
+    closeSegment();
+    opened = false;
+}
+
+bool SegmentedLogWriter::isOpen() const
+{
+    return opened;
+}
+
+void SegmentedLogWriter::append(std::chrono::system_clock::time_point now, std::initializer_list<std::string_view> parts)
+{
+    if (!opened)
+    {
+        return;
+    }
+
+    size_t length = 0;
+    for (const auto& part : parts)
+    {
+        length += part.size();
+    }
+
+    bool expired = options.maxSegmentAge.count() > 0 && now - segmentOpenedAt >= options.maxSegmentAge;
+    if ((writeOffset + length > options.segmentSize || expired) && writeOffset > 0)
+    {
+        closeSegment();
+        if (!openSegment(now))
+        {
+            opened = false;
+            return;
+        }
+    }
+
+    for (const auto& part : parts)
+    {
+        size_t count = std::min(part.size(), options.segmentSize - writeOffset);
+
+#ifdef _WIN32
+        std::fwrite(part.data(), 1, count, file);
+#else
+        std::memcpy(mapping + writeOffset, part.data(), count);
+#endif
+        writeOffset += count;
+    }
+}
+
+void SegmentedLogWriter::flush()
+{
+#ifdef _WIN32
+    if (file != nullptr)
+    {
+        std::fflush(file);
+    }
+#else
+    if (mapping != nullptr && writeOffset > 0)
+    {
+        ::msync(mapping, options.segmentSize, MS_ASYNC);
+    }
+#endif
+}
+
+uint64_t SegmentedLogWriter::getSegmentIndex() const
+{
+    return segmentIndex;
+}
+
+std::string SegmentedLogWriter::getSegmentPath() const
+{
+    return segmentPath(segmentIndex);
+}
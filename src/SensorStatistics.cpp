@@ -0,0 +1,239 @@
+#include "SensorStatistics.hpp"
+#include "Logger.hpp"
+#include <cmath>
+
+SensorMonitor* SensorMonitor::instance = nullptr;
+
+StreamingStatistics::StreamingStatistics(const std::string& sensorName,
+                                         std::chrono::steady_clock::duration windowLength,
+                                         std::chrono::steady_clock::duration ewmaTimeConstantLength)
+    : name(sensorName), window(windowLength), ewmaTimeConstant(ewmaTimeConstantLength)
+{
+    summary.name = sensorName;
+}
+
+void StreamingStatistics::setAlertBands(const AlertBands& alertBands)
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    bands = alertBands;
+    alertsEnabled = true;
+}
+
+double StreamingStatistics::secondsSinceOrigin(std::chrono::steady_clock::time_point time) const
+{
+    return std::chrono::duration<double>(time - timeOrigin).count();
+}
+
+void StreamingStatistics::rebaseTime(std::chrono::steady_clock::time_point origin)
+{
+    // Shifting every t by d: sum(t-d) = sumT - nd, sum((t-d)^2) = sumTT -
+    // 2d sumT + nd^2, sum((t-d)v) = sumTV - d sumV
+    double shift = std::chrono::duration<double>(origin - timeOrigin).count();
+    double count = static_cast<double>(samples.size());
+    sumTT += -2.0 * shift * sumT + count * shift * shift;
+    sumTV -= shift * windowSum;
+    sumT -= count * shift;
+    timeOrigin = origin;
+}
+
+void StreamingStatistics::evictBefore(std::chrono::steady_clock::time_point cutoff)
+{
+    while (!samples.empty() && samples.front().time < cutoff)
+    {
+        double t = secondsSinceOrigin(samples.front().time);
+        windowSum -= samples.front().value;
+        sumT -= t;
+        sumTT -= t * t;
+        sumTV -= t * samples.front().value;
+        samples.pop_front();
+    }
+    if (samples.empty())
+    {
+        sumT = sumTT = sumTV = windowSum = 0.0;
+    }
+    else if (samples.front().time - timeOrigin > window)
+    {
+        rebaseTime(samples.front().time);
+    }
+
+    while (!minimums.empty() && minimums.front().time < cutoff)
+    {
+        minimums.pop_front();
+    }
+    while (!maximums.empty() && maximums.front().time < cutoff)
+    {
+        maximums.pop_front();
+    }
+}
+
+void StreamingStatistics::updateAlert()
+{
+    if (!alertsEnabled)
+    {
+        return;
+    }
+
+    SensorAlert next = summary.alert;
+    double value = summary.ewma;
+
+    switch (summary.alert)
+    {
+        case SensorAlert::NORMAL:
+            if (value > bands.highAbove)
+            {
+                next = SensorAlert::HIGH;
+            }
+            else if (value < bands.lowBelow)
+            {
+                next = SensorAlert::LOW;
+            }
+            break;
+        case SensorAlert::HIGH:
+            if (value < bands.highClearBelow)
+            {
+                next = SensorAlert::NORMAL;
+            }
+            break;
+        case SensorAlert::LOW:
+            if (value > bands.lowClearAbove)
+            {
+                next = SensorAlert::NORMAL;
+            }
+            break;
+    }
+
+    if (next != summary.alert)
+    {
+        LOG_INFO(SENSORS, "Sensor %s alert %s -> %s (smoothed %g, latest %g)", name, getAlertName(summary.alert),
+                 getAlertName(next), value, summary.latest);
+        summary.alert = next;
+        summary.alertChanges++;
+    }
+}
+
+SensorAlert StreamingStatistics::update(std::chrono::steady_clock::time_point time, float value)
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+
+    // Time-aware EWMA: irregular sample spacing weighs each sample by the
+    // time it covers
+    if (summary.totalSamples == 0)
+    {
+        summary.ewma = value;
+    }
+    else
+    {
+        double elapsed = std::chrono::duration<double>(time - summary.updatedAt).count();
+        double alpha = 1.0 - std::exp(-elapsed / std::chrono::duration<double>(ewmaTimeConstant).count());
+        summary.ewma += alpha * (value - summary.ewma);
+    }
+
+    if (samples.empty())
+    {
+        timeOrigin = time;
+    }
+    double t = secondsSinceOrigin(time);
+    samples.push_back({time, value});
+    windowSum += value;
+    sumT += t;
+    sumTT += t * t;
+    sumTV += t * value;
+    while (!minimums.empty() && minimums.back().value >= value)
+    {
+        minimums.pop_back();
+    }
+    minimums.push_back({time, value});
+    while (!maximums.empty() && maximums.back().value <= value)
+    {
+        maximums.pop_back();
+    }
+    maximums.push_back({time, value});
+    evictBefore(time - window);
+
+    summary.latest = value;
+    summary.windowSamples = samples.size();
+    summary.windowAverage = windowSum / samples.size();
+    summary.windowMin = minimums.front().value;
+    summary.windowMax = maximums.front().value;
+
+    // slope = (n sumTV - sumT sumV) / (n sumTT - sumT^2)
+    double count = static_cast<double>(samples.size());
+    double denominator = count * sumTT - sumT * sumT;
+    summary.ratePerHour = samples.size() > 1 && denominator > 0.0
+                              ? (count * sumTV - sumT * windowSum) / denominator * 3600.0
+                              : 0.0;
+    summary.totalSamples++;
+    summary.updatedAt = time;
+
+    updateAlert();
+    return summary.alert;
+}
+
+SensorSummary StreamingStatistics::getSummary() const
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    return summary;
+}
+
+void StreamingStatistics::restore(const SensorSummary& saved)
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    summary.latest = saved.latest;
+    summary.ewma = saved.ewma;
+    summary.totalSamples = saved.totalSamples;
+    summary.alert = saved.alert;
+    summary.alertChanges = saved.alertChanges;
+    summary.updatedAt = saved.updatedAt;
+}
+
+const char* StreamingStatistics::getAlertName(SensorAlert alert)
+{
+    switch (alert)
+    {
+        case SensorAlert::HIGH:
+            return "HIGH";
+        case SensorAlert::LOW:
+            return "LOW";
+        default:
+            return "NORMAL";
+    }
+}
+
+SensorMonitor* SensorMonitor::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new SensorMonitor();
+    }
+
+    return instance;
+}
+
+StreamingStatistics& SensorMonitor::getSensor(const std::string& sensorName)
+{
+    std::lock_guard<std::mutex> lock(monitorMutex);
+
+    auto found = sensors.find(sensorName);
+    if (found != sensors.end())
+    {
+        return *found -> second;
+    }
+
+    auto created = std::make_unique<StreamingStatistics>(sensorName, DEFAULT_WINDOW, DEFAULT_EWMA_TIME_CONSTANT);
+    StreamingStatistics* result = created.get();
+    sensors.emplace(sensorName, std::move(created));
+    ordered.push_back(result);
+    return *result;
+}
+
+std::vector<SensorSummary> SensorMonitor::getSummaries() const
+{
+    std::lock_guard<std::mutex> lock(monitorMutex);
+
+    std::vector<SensorSummary> summaries;
+    for (const StreamingStatistics* sensor : ordered)
+    {
+        summaries.push_back(sensor -> getSummary());
+    }
+    return summaries;
+}
@@ -0,0 +1,103 @@
+#include "SimulationClock.hpp"
+
+SimulationClock* SimulationClock::instance = nullptr;
+
+SimulationClock* SimulationClock::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new SimulationClock();
+    }
+
+    return instance;
+}
+
+void SimulationClock::enableVirtualTime(WallTimePoint startWallTime)
+{
+    steadyOrigin = std::chrono::steady_clock::now();
+    wallOrigin = startWallTime;
+    virtualOffsetNanos = 0;
+    virtualMode = true;
+}
+
+void SimulationClock::disableVirtualTime()
+{
+    virtualMode = false;
+}
+
+bool SimulationClock::isVirtual() const
+{
+    return virtualMode.load(std::memory_order_relaxed);
+}
+
+SimulationClock::TimePoint SimulationClock::now() const
+{
+    if (!isVirtual())
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    return steadyOrigin + std::chrono::nanoseconds(virtualOffsetNanos.load(std::memory_order_acquire));
+}
+
+SimulationClock::WallTimePoint SimulationClock::wallNow() const
+{
+    if (!isVirtual())
+    {
+        return std::chrono::system_clock::now();
+    }
+
+    return wallOrigin + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+        std::chrono::nanoseconds(virtualOffsetNanos.load(std::memory_order_acquire)));
+}
+
+std::tm SimulationClock::localTime() const
+{
+    // localtime_r is comparatively expensive and rules ask for the hour once
+    // per device, so the broken-down time is cached per second and thread.
+    thread_local std::time_t cachedSecond = -1;
+    thread_local std::tm cachedTime{};
+
+    std::time_t second = std::chrono::system_clock::to_time_t(wallNow());
+
+    if (second != cachedSecond)
+    {
+#ifdef _WIN32
+        localtime_s(&cachedTime, &second);
+#else
+        localtime_r(&second, &cachedTime);
+#endif
+        cachedSecond = second;
+    }
+
+    return cachedTime;
+}
+
+int SimulationClock::localHour() const
+{
+    return localTime().tm_hour;
+}
+
+void SimulationClock::advanceTo(TimePoint target)
+{
+    if (!isVirtual())
+    {
+        return;
+    }
+
+    int64_t targetOffset = std::chrono::duration_cast<std::chrono::nanoseconds>(target - steadyOrigin).count();
+    int64_t current = virtualOffsetNanos.load(std::memory_order_relaxed);
+
+    while (targetOffset > current &&
+           !virtualOffsetNanos.compare_exchange_weak(current, targetOffset, std::memory_order_release))
+    {
+    }
+}
+
+void SimulationClock::advanceBy(std::chrono::nanoseconds delta)
+{
+    if (isVirtual() && delta.count() > 0)
+    {
+        virtualOffsetNanos.fetch_add(delta.count(), std::memory_order_release);
+    }
+}
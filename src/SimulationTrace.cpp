@@ -0,0 +1,511 @@
+#include "SimulationTrace.hpp"
+#include "BinaryLog.hpp"
+#include "Logger.hpp"
+#include "RandomService.hpp"
+#include "SimulationClock.hpp"
+#include "TaskManager.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+SimulationTrace* SimulationTrace::instance = nullptr;
+
+namespace
+{
+
+constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+void appendBytes(std::vector<uint8_t>& out, const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+class TraceReader
+{
+private:
+    const std::vector<uint8_t>& data;
+    size_t& position;
+
+public:
+    TraceReader(const std::vector<uint8_t>& bytes, size_t& cursor) : data(bytes), position(cursor) {}
+
+    bool atEnd() const { return position >= data.size(); }
+    uint8_t peek() const { return data[position]; }
+
+    bool readBytes(void* out, size_t length)
+    {
+        if (position + length > data.size())
+        {
+            return false;
+        }
+        std::memcpy(out, data.data() + position, length);
+        position += length;
+        return true;
+    }
+
+    bool readByte(uint8_t& out)
+    {
+        return readBytes(&out, 1);
+    }
+
+    bool skip(size_t length)
+    {
+        if (position + length > data.size())
+        {
+            return false;
+        }
+        position += length;
+        return true;
+    }
+
+    bool readVarint(uint64_t& out)
+    {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t byte;
+            if (!readByte(byte))
+            {
+                return false;
+            }
+            out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readSigned(int64_t& out)
+    {
+        uint64_t raw;
+        if (!readVarint(raw))
+        {
+            return false;
+        }
+        out = BinaryLog::zigzagDecode(raw);
+        return true;
+    }
+};
+
+}
+
+SimulationTrace* SimulationTrace::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new SimulationTrace();
+    }
+
+    return instance;
+}
+
+int64_t SimulationTrace::offsetNanos()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(SimulationClock::getInstance() -> now() - origin).count();
+}
+
+bool SimulationTrace::refreshFingerprint(uint64_t& fingerprint)
+{
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    bool lightsChanged = lightSnapshot.refresh(registry -> getLights());
+    bool blindsChanged = blindSnapshot.refresh(registry -> getBlinds());
+    if (!lightsChanged && !blindsChanged)
+    {
+        return false;
+    }
+
+    // FNV-1a over ID, state, level and version; the change timestamps are
+    // relative to each run's table epoch and left out
+    fingerprint = 0xcbf29ce484222325ull;
+    auto mix = [&fingerprint](uint64_t value)
+    {
+        fingerprint = (fingerprint ^ value) * 0x100000001b3ull;
+    };
+    for (const DeviceSnapshot* snapshot : {&lightSnapshot, &blindSnapshot})
+    {
+        mix(snapshot -> size());
+        for (const DeviceStatus& device : *snapshot)
+        {
+            mix(static_cast<uint32_t>(device.deviceId));
+            mix(static_cast<uint64_t>(device.state.state) | static_cast<uint64_t>(device.state.level) << 8 |
+                static_cast<uint64_t>(device.state.version) << 16);
+        }
+    }
+    return true;
+}
+
+bool SimulationTrace::startRecording(const std::string& path, std::string& error)
+{
+    std::lock_guard<std::mutex> lock(stepMutex);
+
+    if (mode.load() != Mode::OFF)
+    {
+        error = "a trace is already being recorded or replayed";
+        return false;
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    auto clock = SimulationClock::getInstance();
+    origin = clock -> now();
+    lastOffsetNanos = 0;
+    taskIds.clear();
+
+    buffer.clear();
+    buffer.reserve(FLUSH_THRESHOLD + 1024);
+    appendBytes(buffer, "SHTR", 4);
+    uint16_t version = FORMAT_VERSION;
+    appendBytes(buffer, &version, sizeof(version));
+    uint64_t seed = RandomService::getInstance() -> getMasterSeed();
+    appendBytes(buffer, &seed, sizeof(seed));
+    int64_t wallNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(clock -> wallNow().time_since_epoch()).count();
+    appendBytes(buffer, &wallNanos, sizeof(wallNanos));
+
+    // The first step that changes nothing records no state, so start from
+    // the current devices
+    uint64_t fingerprint;
+    lightSnapshot = DeviceSnapshot();
+    blindSnapshot = DeviceSnapshot();
+    refreshFingerprint(fingerprint);
+
+    mode = Mode::RECORDING;
+    LOG_INFO(SYSTEM, "Recording trace to %s", path);
+    return true;
+}
+
+void SimulationTrace::stopRecording()
+{
+    std::lock_guard<std::mutex> lock(stepMutex);
+
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    mode = Mode::OFF;
+    flushLocked();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void SimulationTrace::flushLocked()
+{
+    if (file != nullptr && !buffer.empty())
+    {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        std::fflush(file);
+    }
+    buffer.clear();
+}
+
+bool SimulationTrace::beginStep(const Task& task)
+{
+    if (!isRecording())
+    {
+        return false;
+    }
+
+    stepMutex.lock();
+    if (file == nullptr)
+    {
+        stepMutex.unlock();
+        return false;
+    }
+
+    auto [found, added] = taskIds.try_emplace(&task, static_cast<uint32_t>(taskIds.size()));
+    if (added)
+    {
+        const std::string& name = task.getName();
+        buffer.push_back(RECORD_TASK);
+        BinaryLog::appendVarint(buffer, found -> second);
+        BinaryLog::appendVarint(buffer, name.size());
+        appendBytes(buffer, name.data(), name.size());
+    }
+
+    // Timed under the lock so that step times never go backwards
+    int64_t offset = offsetNanos();
+    buffer.push_back(RECORD_STEP);
+    BinaryLog::appendVarint(buffer, found -> second);
+    BinaryLog::appendVarint(buffer, BinaryLog::zigzagEncode(offset - lastOffsetNanos));
+    lastOffsetNanos = offset;
+    return true;
+}
+
+bool SimulationTrace::beginCommand(TraceCommand command, int target, int value)
+{
+    if (!isRecording())
+    {
+        return false;
+    }
+
+    stepMutex.lock();
+    if (file == nullptr)
+    {
+        stepMutex.unlock();
+        return false;
+    }
+
+    int64_t offset = offsetNanos();
+    buffer.push_back(RECORD_COMMAND);
+    buffer.push_back(static_cast<uint8_t>(command));
+    BinaryLog::appendVarint(buffer, BinaryLog::zigzagEncode(offset - lastOffsetNanos));
+    BinaryLog::appendVarint(buffer, BinaryLog::zigzagEncode(target));
+    BinaryLog::appendVarint(buffer, BinaryLog::zigzagEncode(value));
+    lastOffsetNanos = offset;
+    return true;
+}
+
+void SimulationTrace::endStep()
+{
+    uint64_t fingerprint;
+    if (refreshFingerprint(fingerprint))
+    {
+        buffer.push_back(RECORD_STATE);
+        appendBytes(buffer, &fingerprint, sizeof(fingerprint));
+    }
+
+    if (buffer.size() >= FLUSH_THRESHOLD)
+    {
+        flushLocked();
+    }
+    stepMutex.unlock();
+}
+
+float SimulationTrace::input(TraceInput channel, float value)
+{
+    inputs(channel, &value, 1);
+    return value;
+}
+
+void SimulationTrace::inputs(TraceInput channel, float* values, size_t count)
+{
+    Mode current = mode.load(std::memory_order_relaxed);
+
+    if (current == Mode::RECORDING && file != nullptr)
+    {
+        buffer.push_back(RECORD_INPUT);
+        buffer.push_back(static_cast<uint8_t>(channel));
+        BinaryLog::appendVarint(buffer, count);
+        appendBytes(buffer, values, count * sizeof(float));
+    }
+    else if (current == Mode::REPLAYING && !readInput(channel, values, count))
+    {
+        // Keep the live values; the step will most likely fail its check
+        inputMismatches++;
+    }
+}
+
+bool SimulationTrace::readInput(TraceInput channel, float* values, size_t count)
+{
+    size_t position = replayPosition;
+    TraceReader reader(*replayData, position);
+
+    uint8_t type;
+    uint8_t recordedChannel;
+    uint64_t recordedCount;
+    if (!reader.readByte(type) || type != RECORD_INPUT || !reader.readByte(recordedChannel) ||
+        recordedChannel != static_cast<uint8_t>(channel) || !reader.readVarint(recordedCount) ||
+        recordedCount != count || !reader.readBytes(values, count * sizeof(float)))
+    {
+        return false;
+    }
+
+    replayPosition = position;
+    replayInputs += count;
+    return true;
+}
+
+bool SimulationTrace::replay(const std::string& path, const std::vector<Task*>& tasks,
+                             const CommandHandler& onCommand, ReplayResult& result, std::string& error)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    size_t position = 0;
+    TraceReader header(data, position);
+    char magic[4];
+    uint16_t version;
+    uint64_t seed;
+    int64_t wallNanos;
+    if (!header.readBytes(magic, sizeof(magic)) || std::memcmp(magic, "SHTR", 4) != 0 ||
+        !header.readBytes(&version, sizeof(version)) || version != FORMAT_VERSION ||
+        !header.readBytes(&seed, sizeof(seed)) || !header.readBytes(&wallNanos, sizeof(wallNanos)))
+    {
+        error = path + " is not a trace of this version";
+        return false;
+    }
+
+    Mode expected = Mode::OFF;
+    if (!mode.compare_exchange_strong(expected, Mode::REPLAYING))
+    {
+        error = "a trace is already being recorded or replayed";
+        return false;
+    }
+
+    // Inputs come from the trace, so the seed is only informational
+    LOG_INFO(SYSTEM, "Replaying %s, recorded with seed %u", path, seed);
+    auto clock = SimulationClock::getInstance();
+    clock -> enableVirtualTime(std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(wallNanos))));
+    auto replayOrigin = clock -> now();
+
+    replayData = &data;
+    replayPosition = position;
+    replayInputs = 0;
+    inputMismatches = 0;
+    lightSnapshot = DeviceSnapshot();
+    blindSnapshot = DeviceSnapshot();
+    uint64_t fingerprint;
+    refreshFingerprint(fingerprint);
+
+    result = ReplayResult();
+    std::vector<Task*> tasksById;
+    int64_t offset = 0;
+    auto start = std::chrono::steady_clock::now();
+    TraceReader reader(data, replayPosition);
+
+    auto mismatch = [&]()
+    {
+        if (result.mismatches++ == 0)
+        {
+            result.firstMismatchStep = result.steps;
+            result.firstMismatchOffset = std::chrono::nanoseconds(offset);
+        }
+    };
+
+    bool complete = true;
+    while (complete && !reader.atEnd())
+    {
+        uint8_t type = 0;
+        reader.readByte(type);
+
+        switch (type)
+        {
+            case RECORD_TASK:
+            {
+                uint64_t id;
+                uint64_t length;
+                complete = reader.readVarint(id) && reader.readVarint(length) && length <= data.size();
+                std::string name(complete ? length : 0, '\0');
+                complete = complete && reader.readBytes(name.data(), name.size());
+                if (!complete)
+                {
+                    break;
+                }
+
+                Task* match = nullptr;
+                for (Task* task : tasks)
+                {
+                    if (task -> getName() == name)
+                    {
+                        match = task;
+                        break;
+                    }
+                }
+                if (match == nullptr)
+                {
+                    error = "trace task not found: " + name;
+                    complete = false;
+                    break;
+                }
+                tasksById.resize(std::max<size_t>(tasksById.size(), id + 1), nullptr);
+                tasksById[id] = match;
+                continue;
+            }
+            case RECORD_STEP:
+            case RECORD_COMMAND:
+            {
+                uint64_t id = 0;
+                uint8_t command = 0;
+                int64_t delta = 0;
+                int64_t target = 0;
+                int64_t value = 0;
+                if (type == RECORD_STEP)
+                {
+                    complete = reader.readVarint(id) && reader.readSigned(delta) && id < tasksById.size();
+                }
+                else
+                {
+                    complete = reader.readByte(command) && reader.readSigned(delta) && reader.readSigned(target) &&
+                               reader.readSigned(value);
+                }
+                if (!complete)
+                {
+                    break;
+                }
+
+                offset += delta;
+                clock -> advanceTo(replayOrigin + std::chrono::nanoseconds(offset));
+                if (type == RECORD_STEP)
+                {
+                    tasksById[id] -> execute();
+                }
+                else
+                {
+                    onCommand(static_cast<TraceCommand>(command), static_cast<int>(target), static_cast<int>(value));
+                    result.commands++;
+                }
+                result.steps++;
+
+                // The recorded step wrote a state record exactly when it
+                // changed a device
+                bool recorded = !reader.atEnd() && reader.peek() == RECORD_STATE;
+                uint64_t recordedFingerprint = 0;
+                if (recorded)
+                {
+                    reader.readByte(type);
+                    complete = reader.readBytes(&recordedFingerprint, sizeof(recordedFingerprint));
+                    result.stateChecks++;
+                }
+                if (refreshFingerprint(fingerprint) != recorded || (recorded && fingerprint != recordedFingerprint))
+                {
+                    mismatch();
+                }
+                continue;
+            }
+            case RECORD_INPUT:
+            {
+                // Inputs the replayed step did not ask for
+                uint8_t channel;
+                uint64_t count;
+                complete = reader.readByte(channel) && reader.readVarint(count) && count <= data.size() &&
+                           reader.skip(count * sizeof(float));
+                mismatch();
+                continue;
+            }
+            default:
+                error = "corrupt trace record";
+                complete = false;
+                break;
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.inputs = replayInputs;
+    result.events = result.steps + result.inputs + result.stateChecks;
+    result.traceDuration = std::chrono::nanoseconds(offset);
+    result.mismatches += inputMismatches;
+
+    replayData = nullptr;
+    mode = Mode::OFF;
+
+    if (!complete && error.empty())
+    {
+        error = "trace ends in the middle of a record";
+    }
+    LOG_INFO(SYSTEM, "Replayed %u steps from %s, %u mismatches", result.steps, path, result.mismatches);
+    return complete;
+}
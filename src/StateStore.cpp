@@ -0,0 +1,797 @@
+#include "StateStore.hpp"
+#include "Logger.hpp"
+#include "SensorStatistics.hpp"
+#include "SimulationClock.hpp"
+#include "TemperatureSensorTask.hpp"
+#include "Timeline.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+StateStore* StateStore::instance = nullptr;
+
+namespace
+{
+    constexpr char SNAPSHOT_MAGIC[4] = {'S', 'H', 'S', 'S'};
+    constexpr char JOURNAL_MAGIC[4] = {'S', 'H', 'S', 'J'};
+
+    struct JournalHeader
+    {
+        char magic[4];
+        uint16_t version;
+        uint16_t headerSize;
+        uint32_t reserved;
+        // Snapshot the batches apply on top of
+        uint64_t snapshotSequence;
+    };
+
+    // Followed by count device records and a checksum over both
+    struct JournalBatch
+    {
+        uint32_t count;
+        uint32_t reserved;
+        uint64_t batch;
+        int64_t wallNanos;
+    };
+
+    // Word-at-a-time FNV-1a variant; catches torn and corrupted files, not
+    // tampering
+    uint64_t checksum(const uint8_t* data, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        size_t words = size / sizeof(uint64_t);
+        for (size_t i = 0; i < words; i++)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i * sizeof(uint64_t), sizeof(word));
+            hash = (hash ^ word) * 1099511628211ULL;
+            hash ^= hash >> 29;
+        }
+        for (size_t i = words * sizeof(uint64_t); i < size; i++)
+        {
+            hash = (hash ^ data[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template <typename Record>
+    void appendRecord(std::vector<uint8_t>& out, const Record& record)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+        out.insert(out.end(), bytes, bytes + sizeof(Record));
+    }
+
+    int64_t wallNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   SimulationClock::getInstance() -> wallNow().time_since_epoch()).count();
+    }
+
+    double millisSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Read-only view of a whole file: a memory mapping, or on Windows a copy
+    class MappedFile
+    {
+    private:
+        const uint8_t* data{nullptr};
+        size_t size{0};
+#ifdef _WIN32
+        std::vector<uint8_t> contents;
+#endif
+
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+#ifndef _WIN32
+            if (data != nullptr)
+            {
+                munmap(const_cast<uint8_t*>(data), size);
+            }
+#endif
+        }
+
+        // Sets missing instead of failing silently when there is no file
+        bool open(const std::string& path, bool& missing, std::string& error)
+        {
+            missing = false;
+#ifdef _WIN32
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (file == nullptr)
+            {
+                missing = errno == ENOENT;
+                error = "cannot open " + path;
+                return false;
+            }
+            std::fseek(file, 0, SEEK_END);
+            contents.resize(static_cast<size_t>(std::ftell(file)));
+            std::fseek(file, 0, SEEK_SET);
+            bool complete = std::fread(contents.data(), 1, contents.size(), file) == contents.size();
+            std::fclose(file);
+            if (!complete)
+            {
+                error = "cannot read " + path;
+                return false;
+            }
+            data = contents.data();
+            size = contents.size();
+#else
+            int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0)
+            {
+                missing = errno == ENOENT;
+                error = "cannot open " + path + ": " + std::strerror(errno);
+                return false;
+            }
+            struct stat status;
+            if (fstat(descriptor, &status) != 0)
+            {
+                error = "cannot stat " + path;
+                ::close(descriptor);
+                return false;
+            }
+            size = static_cast<size_t>(status.st_size);
+            if (size > 0)
+            {
+                void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    error = "cannot map " + path;
+                    ::close(descriptor);
+                    size = 0;
+                    return false;
+                }
+                data = static_cast<const uint8_t*>(mapping);
+            }
+            ::close(descriptor);
+#endif
+            return true;
+        }
+
+        const uint8_t* getData() const { return data; }
+        size_t getSize() const { return size; }
+    };
+
+    bool syncFile(std::FILE* file)
+    {
+        if (std::fflush(file) != 0)
+        {
+            return false;
+        }
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+
+    // Atomically replaces target with source; on POSIX the directory entry is
+    // synced too, so that the rename itself survives a crash
+    bool replaceFile(const std::string& source, const std::string& target)
+    {
+#ifdef _WIN32
+        return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        if (std::rename(source.c_str(), target.c_str()) != 0)
+        {
+            return false;
+        }
+        size_t slash = target.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : target.substr(0, slash + 1);
+        int descriptor = ::open(directory.c_str(), O_RDONLY);
+        if (descriptor >= 0)
+        {
+            fsync(descriptor);
+            ::close(descriptor);
+        }
+        return true;
+#endif
+    }
+
+    // The device's state as it should be now, its cooldown clock advanced by
+    // the time the home was down
+    DeviceState restoredState(const DeviceTable& table, std::chrono::steady_clock::time_point now,
+                              const SnapshotDevice& record, int64_t downMillis)
+    {
+        int64_t maxAge = std::chrono::duration_cast<std::chrono::milliseconds>(StateStore::MAX_RESTORED_AGE).count();
+        int64_t age = std::min<int64_t>(record.millisSinceChange + std::max<int64_t>(downMillis, 0), maxAge);
+
+        DeviceState state;
+        state.state = record.state;
+        state.level = record.level;
+        state.lastChangeMillis = table.toMillis(now) - static_cast<uint32_t>(age);
+        return state;
+    }
+}
+
+StateStore* StateStore::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new StateStore();
+    }
+
+    return instance;
+}
+
+bool StateStore::open(const std::string& snapshotPath, RestoreResult& result, std::string& error)
+{
+    auto start = std::chrono::steady_clock::now();
+    result = RestoreResult();
+
+    std::lock_guard<std::mutex> lock(fileMutex);
+    path = snapshotPath;
+    journalPath = snapshotPath + ".journal";
+
+    MappedFile file;
+    bool missing;
+    if (!file.open(path, missing, error))
+    {
+        if (missing)
+        {
+            LOG_INFO(SYSTEM, "No state snapshot at %s, starting from defaults", path);
+            error.clear();
+            return true;
+        }
+        path.clear();
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (file.getSize() < sizeof(header))
+    {
+        error = path + " is too short for a state snapshot";
+        path.clear();
+        return false;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+
+    size_t expected = sizeof(header) + static_cast<size_t>(header.deviceCount) * sizeof(SnapshotDevice) +
+                      static_cast<size_t>(header.sensorCount) * sizeof(SnapshotSensor) + header.nameBytes;
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+    {
+        error = path + " is not a state snapshot";
+    }
+    else if (header.version != FORMAT_VERSION || header.headerSize != sizeof(header))
+    {
+        error = path + " has unsupported snapshot version " + std::to_string(header.version);
+    }
+    else if (file.getSize() != expected)
+    {
+        error = path + " is truncated";
+    }
+    else if (checksum(file.getData() + sizeof(header), file.getSize() - sizeof(header)) != header.checksum)
+    {
+        error = path + " failed its checksum";
+    }
+    else if (header.deviceCount > 0 && (header.nameBytes == 0 || file.getData()[file.getSize() - 1] != '\0'))
+    {
+        error = path + " has unterminated device names";
+    }
+    if (!error.empty())
+    {
+        path.clear();
+        return false;
+    }
+
+    const SnapshotDevice* devices = reinterpret_cast<const SnapshotDevice*>(file.getData() + sizeof(header));
+    const SnapshotSensor* sensors = reinterpret_cast<const SnapshotSensor*>(devices + header.deviceCount);
+    const char* nameBlock = reinterpret_cast<const char*>(sensors + header.sensorCount);
+
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    SimulationClock* clock = SimulationClock::getInstance();
+    auto now = clock -> now();
+    int64_t downMillis = (wallNanos() - header.wallNanos) / 1000000;
+
+    for (uint32_t i = 0; i < header.deviceCount; i++)
+    {
+        const SnapshotDevice& record = devices[i];
+        if (record.type > static_cast<uint8_t>(DeviceType::BLIND) || record.nameOffset >= header.nameBytes)
+        {
+            error = path + ": invalid device record " + std::to_string(i);
+            path.clear();
+            return false;
+        }
+
+        DeviceType type = static_cast<DeviceType>(record.type);
+        DeviceHandle handle = registry -> findDevice(type, record.deviceId);
+        if (handle == INVALID_DEVICE_HANDLE)
+        {
+            handle = registry -> registerDevice(type, record.deviceId, nameBlock + record.nameOffset);
+            if (handle == INVALID_DEVICE_HANDLE)
+            {
+                error = path + ": no room to restore device " + std::to_string(record.deviceId);
+                path.clear();
+                return false;
+            }
+            result.registered++;
+        }
+
+        DeviceTable& table = registry -> getTable(type);
+        table.restore(handle, restoredState(table, now, record, downMillis));
+    }
+
+    for (uint32_t i = 0; i < header.sensorCount; i++)
+    {
+        const SnapshotSensor& record = sensors[i];
+        SensorSummary saved;
+        saved.latest = record.latest;
+        saved.ewma = record.ewma;
+        saved.totalSamples = record.totalSamples;
+        saved.alert = static_cast<SensorAlert>(record.alert);
+        saved.alertChanges = record.alertChanges;
+        saved.updatedAt = now;
+        std::string name(record.name, std::find(record.name, record.name + sizeof(record.name), '\0'));
+        SensorMonitor::getInstance() -> getSensor(name).restore(saved);
+    }
+    TemperatureSensor::setReading(header.temperature);
+
+    sequence = header.sequence;
+    result.restored = true;
+    result.sequence = header.sequence;
+    result.devices = header.deviceCount;
+    result.sensors = header.sensorCount;
+    result.snapshotAge = std::chrono::milliseconds(std::max<int64_t>(downMillis, 0));
+
+    if (!restoreJournal(header, result, error))
+    {
+        path.clear();
+        return false;
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO(SYSTEM, "Restored state snapshot %u: %u devices (%u new), %u sensors, %u journal records in %g ms",
+             result.sequence, result.devices, result.registered, result.sensors, result.journalRecords,
+             result.seconds * 1000.0);
+    return true;
+}
+
+bool StateStore::restoreJournal(const SnapshotHeader& snapshot, RestoreResult& result, std::string& error)
+{
+    MappedFile file;
+    bool missing;
+    if (!file.open(journalPath, missing, error))
+    {
+        if (missing)
+        {
+            error.clear();
+            return true;
+        }
+        return false;
+    }
+
+    // A journal left over from an older snapshot is already contained in
+    // this one
+    JournalHeader header;
+    if (file.getSize() < sizeof(header))
+    {
+        return true;
+    }
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+        header.headerSize != sizeof(header) || header.snapshotSequence != snapshot.sequence)
+    {
+        return true;
+    }
+
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    auto now = SimulationClock::getInstance() -> now();
+    int64_t restoreNanos = wallNanos();
+    size_t position = sizeof(header);
+
+    // Stops at the first incomplete or corrupted batch: the tail of a write
+    // that a crash interrupted
+    while (file.getSize() - position >= sizeof(JournalBatch))
+    {
+        JournalBatch batch;
+        std::memcpy(&batch, file.getData() + position, sizeof(batch));
+        size_t bytes = sizeof(batch) + static_cast<size_t>(batch.count) * sizeof(SnapshotDevice);
+        if (file.getSize() - position < bytes + sizeof(uint64_t))
+        {
+            break;
+        }
+        uint64_t stored;
+        std::memcpy(&stored, file.getData() + position + bytes, sizeof(stored));
+        if (checksum(file.getData() + position, bytes) != stored)
+        {
+            break;
+        }
+
+        const SnapshotDevice* records =
+            reinterpret_cast<const SnapshotDevice*>(file.getData() + position + sizeof(batch));
+        int64_t downMillis = (restoreNanos - batch.wallNanos) / 1000000;
+        for (uint32_t i = 0; i < batch.count; i++)
+        {
+            if (records[i].type > static_cast<uint8_t>(DeviceType::BLIND))
+            {
+                continue;
+            }
+            DeviceType type = static_cast<DeviceType>(records[i].type);
+            DeviceHandle handle = registry -> findDevice(type, records[i].deviceId);
+            if (handle != INVALID_DEVICE_HANDLE)
+            {
+                DeviceTable& table = registry -> getTable(type);
+                table.restore(handle, restoredState(table, now, records[i], downMillis));
+            }
+        }
+
+        result.journalBatches++;
+        result.journalRecords += batch.count;
+        position += bytes + sizeof(uint64_t);
+    }
+    return true;
+}
+
+bool StateStore::writeSnapshotLocked(std::string& error)
+{
+    auto captureStart = std::chrono::steady_clock::now();
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    auto now = SimulationClock::getInstance() -> now();
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(header);
+    header.sequence = sequence + 1;
+    header.wallNanos = wallNanos();
+    header.temperature = TemperatureSensor::getLastReading();
+
+    buffer.assign(sizeof(header), 0);
+    names.clear();
+
+    for (DeviceType type : {DeviceType::LIGHT, DeviceType::BLIND})
+    {
+        DeviceTable& table = registry -> getTable(type);
+        TableBaseline& baseline = baselines[static_cast<size_t>(type)];
+
+        // Read before the copy: a change racing with it leaves the count
+        // behind, so the next journal pass looks at the table again
+        baseline.changeCount = table.getChangeCount();
+
+        std::shared_lock<std::shared_mutex> lock(table.getMutex());
+        uint32_t nowMillis = table.toMillis(now);
+        baseline.devices.resize(table.size());
+
+        for (DeviceHandle handle = 0; handle < table.size(); handle++)
+        {
+            DeviceState state = table.load(handle);
+            baseline.devices[handle] = {table.getDeviceId(handle), state};
+
+            SnapshotDevice record{};
+            record.deviceId = table.getDeviceId(handle);
+            record.nameOffset = static_cast<uint32_t>(names.size());
+            record.millisSinceChange = state.millisSinceChange(nowMillis);
+            record.type = static_cast<uint8_t>(type);
+            record.state = state.state;
+            record.level = state.level;
+            appendRecord(buffer, record);
+
+            names += registry -> getName(type, handle);
+            names += '\0';
+        }
+        header.deviceCount += static_cast<uint32_t>(table.size());
+    }
+
+    for (const SensorSummary& summary : SensorMonitor::getInstance() -> getSummaries())
+    {
+        if (summary.name.size() >= sizeof(SnapshotSensor::name))
+        {
+            continue;
+        }
+
+        SnapshotSensor record{};
+        std::memcpy(record.name, summary.name.data(), summary.name.size());
+        record.ewma = summary.ewma;
+        record.totalSamples = summary.totalSamples;
+        record.alertChanges = summary.alertChanges;
+        record.latest = summary.latest;
+        record.alert = static_cast<uint8_t>(summary.alert);
+        appendRecord(buffer, record);
+        header.sensorCount++;
+    }
+
+    buffer.insert(buffer.end(), names.begin(), names.end());
+    header.nameBytes = names.size();
+    header.checksum = checksum(buffer.data() + sizeof(header), buffer.size() - sizeof(header));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    double captureMillis = millisSince(captureStart);
+
+    auto writeStart = std::chrono::steady_clock::now();
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr)
+    {
+        error = "cannot create " + temporary;
+        return false;
+    }
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size() && syncFile(file);
+    std::fclose(file);
+    if (!written || !replaceFile(temporary, path))
+    {
+        error = "cannot write snapshot " + path;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    sequence = header.sequence;
+
+    // The snapshot now holds everything the old journal did
+    if (journal != nullptr)
+    {
+        std::fclose(journal);
+    }
+    journal = std::fopen(journalPath.c_str(), "wb");
+    journalBatch = 0;
+    if (journal == nullptr)
+    {
+        error = "cannot create " + journalPath;
+        return false;
+    }
+    JournalHeader journalHeader{};
+    std::memcpy(journalHeader.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    journalHeader.version = FORMAT_VERSION;
+    journalHeader.headerSize = sizeof(journalHeader);
+    journalHeader.snapshotSequence = sequence;
+    if (std::fwrite(&journalHeader, sizeof(journalHeader), 1, journal) != 1 || !syncFile(journal))
+    {
+        error = "cannot write " + journalPath;
+        return false;
+    }
+
+    double writeMillis = millisSince(writeStart);
+    {
+        std::lock_guard<std::mutex> statisticsLock(statisticsMutex);
+        statistics.snapshots++;
+        statistics.lastSnapshotBytes = buffer.size();
+        statistics.lastCaptureMillis = captureMillis;
+        statistics.lastWriteMillis = writeMillis;
+    }
+    LOG_DEBUG(SYSTEM, "State snapshot %u: %u devices, %u bytes, captured in %g ms, written in %g ms", sequence,
+              header.deviceCount, buffer.size(), captureMillis, writeMillis);
+    return true;
+}
+
+bool StateStore::appendJournalLocked(bool& structural, std::string& error)
+{
+    structural = journal == nullptr;
+    if (structural)
+    {
+        return true;
+    }
+
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    if (registry -> getLights().getChangeCount() == baselines[static_cast<size_t>(DeviceType::LIGHT)].changeCount &&
+        registry -> getBlinds().getChangeCount() == baselines[static_cast<size_t>(DeviceType::BLIND)].changeCount)
+    {
+        return true;
+    }
+
+    auto now = SimulationClock::getInstance() -> now();
+
+    JournalBatch batch{};
+    batch.batch = journalBatch + 1;
+    batch.wallNanos = wallNanos();
+    buffer.assign(sizeof(batch), 0);
+
+    for (DeviceType type : {DeviceType::LIGHT, DeviceType::BLIND})
+    {
+        DeviceTable& table = registry -> getTable(type);
+        TableBaseline& baseline = baselines[static_cast<size_t>(type)];
+
+        uint64_t changeCount = table.getChangeCount();
+        if (changeCount == baseline.changeCount)
+        {
+            continue;
+        }
+
+        if (current.size() < table.getCapacity())
+        {
+            current.resize(table.getCapacity());
+        }
+        size_t count = table.copyStatus(current.data(), current.size());
+        if (count != baseline.devices.size())
+        {
+            structural = true;
+            return true;
+        }
+
+        uint32_t nowMillis = table.toMillis(now);
+        for (size_t i = 0; i < count; i++)
+        {
+            const DeviceStatus& before = baseline.devices[i];
+            const DeviceStatus& after = current[i];
+            if (after.deviceId != before.deviceId)
+            {
+                structural = true;
+                return true;
+            }
+            if (after.state.version == before.state.version)
+            {
+                continue;
+            }
+
+            SnapshotDevice record{};
+            record.deviceId = after.deviceId;
+            record.millisSinceChange = after.state.millisSinceChange(nowMillis);
+            record.type = static_cast<uint8_t>(type);
+            record.state = after.state.state;
+            record.level = after.state.level;
+            appendRecord(buffer, record);
+            batch.count++;
+        }
+
+        // The copy becomes the baseline; a failed append below forces a
+        // snapshot, so the baseline never gets ahead of the files
+        current.resize(count);
+        std::swap(current, baseline.devices);
+        baseline.changeCount = changeCount;
+    }
+
+    if (batch.count == 0)
+    {
+        return true;
+    }
+
+    std::memcpy(buffer.data(), &batch, sizeof(batch));
+    uint64_t sum = checksum(buffer.data(), buffer.size());
+    appendRecord(buffer, sum);
+    if (std::fwrite(buffer.data(), 1, buffer.size(), journal) != buffer.size() || !syncFile(journal))
+    {
+        // Whatever reached the file fails its checksum; the next pass
+        // starts over with a snapshot
+        std::fclose(journal);
+        journal = nullptr;
+        error = "cannot append to " + journalPath;
+        return false;
+    }
+    journalBatch = batch.batch;
+
+    std::lock_guard<std::mutex> statisticsLock(statisticsMutex);
+    statistics.journalBatches++;
+    statistics.journalRecords += batch.count;
+    return true;
+}
+
+bool StateStore::snapshotNow(std::string& error)
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (path.empty())
+    {
+        error = "no state file open";
+        return false;
+    }
+    return writeSnapshotLocked(error);
+}
+
+bool StateStore::journalNow(std::string& error)
+{
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (path.empty())
+    {
+        error = "no state file open";
+        return false;
+    }
+
+    bool structural;
+    if (!appendJournalLocked(structural, error))
+    {
+        return false;
+    }
+    return !structural || writeSnapshotLocked(error);
+}
+
+void StateStore::run()
+{
+    auto nextSnapshot = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(writerMutex);
+    Timeline::getInstance() -> nameThread("state store");
+
+    while (true)
+    {
+        wake.wait_for(lock, JOURNAL_INTERVAL, [this] { return stopping || snapshotRequested; });
+        if (stopping)
+        {
+            break;
+        }
+        bool snapshotDue = snapshotRequested || std::chrono::steady_clock::now() >= nextSnapshot;
+        snapshotRequested = false;
+        lock.unlock();
+
+        std::string error;
+        bool written;
+        {
+            TimelineSpan span("state", snapshotDue ? "snapshot" : "journal");
+            written = snapshotDue ? snapshotNow(error) : journalNow(error);
+        }
+        if (snapshotDue)
+        {
+            nextSnapshot = std::chrono::steady_clock::now() + snapshotInterval;
+        }
+        if (!written)
+        {
+            recordFailure(error);
+        }
+
+        lock.lock();
+    }
+}
+
+void StateStore::start(std::chrono::steady_clock::duration interval)
+{
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (writer.joinable() || path.empty())
+    {
+        return;
+    }
+
+    snapshotInterval = interval;
+    stopping = false;
+    snapshotRequested = true;
+    writer = std::thread(&StateStore::run, this);
+}
+
+void StateStore::requestSnapshot()
+{
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        snapshotRequested = true;
+    }
+    wake.notify_one();
+}
+
+void StateStore::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+
+    if (!path.empty())
+    {
+        std::string error;
+        if (!snapshotNow(error))
+        {
+            recordFailure(error);
+        }
+
+        std::lock_guard<std::mutex> lock(fileMutex);
+        if (journal != nullptr)
+        {
+            std::fclose(journal);
+            journal = nullptr;
+        }
+    }
+}
+
+void StateStore::recordFailure(const std::string& error)
+{
+    LOG_WARN(SYSTEM, "State persistence failed: %s", error);
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    statistics.failures++;
+}
+
+StateStoreStatistics StateStore::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    return statistics;
+}
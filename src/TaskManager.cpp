@@ -1,8 +1,60 @@
 #include "TaskManager.hpp"
 #include "Logger.hpp"
+#include "Metrics.hpp"
+#include "SimulationClock.hpp"
+#include "SimulationTrace.hpp"
+#include "Timeline.hpp"
+#include <cmath>
 
 TaskManager* TaskManager::instance = nullptr;
 
+namespace
+{
+
+void updateMax(std::atomic<int64_t>& target, int64_t value)
+{
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+void updateMin(std::atomic<int64_t>& target, int64_t value)
+{
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+}
+
+std::chrono::steady_clock::time_point Task::getNextDueTime() const
+{
+    if (getPeriod().count() > 0)
+    {
+        return nextReleaseTime;
+    }
+
+    return lastExecutionTime + timeSlice;
+}
+
+std::chrono::milliseconds Task::getPeriod() const
+{
+    return std::chrono::milliseconds(0);
+}
+
+std::chrono::milliseconds Task::getRelativeDeadline() const
+{
+    return getPeriod();
+}
+
+std::chrono::milliseconds Task::getWcetBudget() const
+{
+    return std::chrono::milliseconds(0);
+}
+
+bool Task::isEventDriven() const
+{
+    return false;
+}
+
 TaskManager* TaskManager::getInstance()
 {
     if (instance == nullptr)
@@ -13,10 +65,190 @@ TaskManager* TaskManager::getInstance()
     return instance;
 }
 
-void TaskManager::addTask(std::unique_ptr<Task> task)
+bool TaskManager::addTask(std::unique_ptr<Task> task)
+{
+    // Tasks are never removed, so the pointer stays valid for scrapes
+    const Task* added = task.get();
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+
+        if (!admits(task.get()))
+        {
+            LOG_WARN(SCHEDULER, "Admission test failed, rejecting task: %s", task -> getName());
+            return false;
+        }
+
+        if (task -> getPeriod().count() > 0)
+        {
+            task -> nextReleaseTime = SimulationClock::getInstance() -> now() + task -> getPeriod();
+        }
+
+        tasks.push_back(std::move(task));
+        assignPriorities();
+        rearmTask(tasks.back().get());
+    }
+
+    Metrics::getInstance() -> registerTask(added);
+    scheduleCV.notify_all();
+    return true;
+}
+
+void TaskManager::setSchedulingPolicy(SchedulingPolicy newPolicy)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        policy = newPolicy;
+        rebuildTimerQueue();
+    }
+
+    scheduleCV.notify_all();
+}
+
+SchedulingPolicy TaskManager::getSchedulingPolicy() const
 {
     std::lock_guard<std::mutex> lock(taskMutex);
-    tasks.push_back(std::move(task));
+    return policy;
+}
+
+const char* TaskManager::getPolicyName(SchedulingPolicy schedulingPolicy)
+{
+    switch (schedulingPolicy)
+    {
+        case SchedulingPolicy::FIXED_PRIORITY:
+            return "Fixed priority";
+        case SchedulingPolicy::RATE_MONOTONIC:
+            return "Rate monotonic";
+        case SchedulingPolicy::EARLIEST_DEADLINE_FIRST:
+            return "Earliest deadline first";
+        default:
+            return "Unknown";
+    }
+}
+
+void TaskManager::assignPriorities()
+{
+    // Rate monotonic: periodic tasks take levels from the top of the ready
+    // queue, shortest period first; aperiodic tasks keep their own priority
+    // in the lower half.
+    std::vector<long long> periods;
+    for (const auto& task : tasks)
+    {
+        if (task -> getPeriod().count() > 0)
+        {
+            periods.push_back(task -> getPeriod().count());
+        }
+    }
+    std::sort(periods.begin(), periods.end());
+    periods.erase(std::unique(periods.begin(), periods.end()), periods.end());
+
+    const int half = ReadyQueue::PRIORITY_LEVELS / 2;
+
+    for (const auto& task : tasks)
+    {
+        int priority = ReadyQueue::clampPriority(task -> getPriority());
+
+        if (policy == SchedulingPolicy::RATE_MONOTONIC)
+        {
+            long long period = task -> getPeriod().count();
+
+            if (period > 0)
+            {
+                int rank = static_cast<int>(std::lower_bound(periods.begin(), periods.end(), period) - periods.begin());
+                priority = std::max(half, ReadyQueue::PRIORITY_LEVELS - 1 - rank);
+            }
+            else
+            {
+                priority = std::min(priority, half - 1);
+            }
+        }
+
+        if (priority != task -> schedulingPriority)
+        {
+            bool queued = task -> inReadyQueue && policy != SchedulingPolicy::EARLIEST_DEADLINE_FIRST;
+            if (queued)
+            {
+                readyQueue.remove(task.get());
+            }
+
+            task -> schedulingPriority = priority;
+
+            if (queued)
+            {
+                readyQueue.push(task.get());
+            }
+        }
+    }
+}
+
+bool TaskManager::admits(const Task* candidate) const
+{
+    struct Demand
+    {
+        double key;
+        double wcet;
+        double period;
+        double deadline;
+    };
+
+    std::vector<Demand> demands;
+    auto addDemand = [&](const Task* task)
+    {
+        double period = static_cast<double>(task -> getPeriod().count());
+        double wcet = static_cast<double>(task -> getWcetBudget().count());
+
+        if (period > 0 && wcet > 0)
+        {
+            double deadline = static_cast<double>(task -> getRelativeDeadline().count());
+            double key = policy == SchedulingPolicy::RATE_MONOTONIC ? -period : task -> getPriority();
+            demands.push_back({key, wcet, period, deadline > 0 ? deadline : period});
+        }
+    };
+
+    for (const auto& task : tasks)
+    {
+        addDemand(task.get());
+    }
+    addDemand(candidate);
+
+    if (policy == SchedulingPolicy::EARLIEST_DEADLINE_FIRST)
+    {
+        // Density test, exact for implicit deadlines (U <= 1)
+        double density = 0.0;
+        for (const auto& demand : demands)
+        {
+            density += demand.wcet / std::min(demand.deadline, demand.period);
+        }
+        return density <= 1.0;
+    }
+
+    // Response-time analysis for fixed priorities: every task must finish
+    // within its deadline under interference from equal or higher priorities.
+    for (size_t i = 0; i < demands.size(); i++)
+    {
+        double response = demands[i].wcet;
+        double previous = 0.0;
+
+        while (response != previous && response <= demands[i].deadline)
+        {
+            previous = response;
+            response = demands[i].wcet;
+
+            for (size_t j = 0; j < demands.size(); j++)
+            {
+                if (j != i && demands[j].key >= demands[i].key)
+                {
+                    response += std::ceil(previous / demands[j].period) * demands[j].wcet;
+                }
+            }
+        }
+
+        if (response > demands[i].deadline)
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 void TaskManager::startScheduler()
@@ -24,8 +256,29 @@ void TaskManager::startScheduler()
     if (!isRunning)
     {
         isRunning = true;
+
+        // The mode is fixed for this run: a pool exactly when workers were
+        // requested at start, whatever setWorkerCount() is called with later
+        size_t workers;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            schedulerStartTime = std::chrono::steady_clock::now();
+            wakeupsAtStart = wakeupCount.load(std::memory_order_relaxed);
+            workers = workerCount;
+            if (workers > 0)
+            {
+                workerPool = std::make_unique<WorkerPool>(workers,
+                    [this](Task* task) { return executeTask(task); },
+                    [this](Task* task, bool succeeded) { onTaskCompleted(task, succeeded); });
+            }
+        }
+        if (workerPool)
+        {
+            workerPool -> start();
+        }
+
         schedulerThread = std::thread(&TaskManager::schedulerLoop, this);
-        Logger::getInstance() -> log("Scheduler started", true);
+        LOG_INFO(SCHEDULER, "Scheduler started with %u workers", workers);
     }
 }
 
@@ -33,65 +286,313 @@ void TaskManager::stopScheduler()
 {
     if (isRunning)
     {
-        isRunning = false;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            isRunning = false;
+        }
         scheduleCV.notify_all();
         if (schedulerThread.joinable())
         {
             schedulerThread.join();
         }
 
-        Logger::getInstance() -> log("Scheduler stopped", true);
+        if (workerPool)
+        {
+            auto unstarted = workerPool -> stop();
+            std::lock_guard<std::mutex> lock(taskMutex);
+
+            for (Task* task : unstarted)
+            {
+                task -> inFlight = false;
+                inFlightTasks--;
+                rearmTask(task);
+            }
+
+            for (auto& parked : parkedTasks)
+            {
+                for (Task* waiting : parked.second)
+                {
+                    makeReady(waiting);
+                }
+            }
+            parkedTasks.clear();
+            busyGroups.clear();
+
+            // A restart after setWorkerCount(0) runs tasks inline again
+            workerPool.reset();
+        }
+
+        LOG_INFO(SCHEDULER, "Scheduler stopped");
     }
 }
 
+void TaskManager::wakeScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        rescheduleRequested = true;
+    }
+
+    scheduleCV.notify_all();
+}
+
+void TaskManager::wakeTask(Task* task)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+
+        if (task -> inFlight)
+        {
+            task -> wakePending = true;
+            return;
+        }
+        if (task -> wakeQueued || !task -> isReady)
+        {
+            return;
+        }
+
+        task -> wakeQueued = true;
+        timerQueue.push({SimulationClock::getInstance() -> now(), task});
+    }
+
+    scheduleCV.notify_all();
+}
+
+void TaskManager::setWorkerCount(size_t count)
+{
+    std::lock_guard<std::mutex> lock(taskMutex);
+    workerCount = count;
+}
+
 TaskManager::~TaskManager()
 {
     stopScheduler();
     delete instance;
 }
 
-bool TaskManager::hasReadyTasks() const
+void TaskManager::rebuildTimerQueue()
 {
-    return std::any_of(tasks.begin(), tasks.end(), [](const auto& task) 
-    { return task -> isReady; });
+    timerQueue = {};
+    readyQueue.clear();
+    parkedTasks.clear();
+
+    while (!deadlineQueue.empty())
+    {
+        deadlineQueue.top().task -> inReadyQueue = false;
+        deadlineQueue.pop();
+    }
+
+    assignPriorities();
+
+    for (const auto& task : tasks)
+    {
+        if (!task -> inFlight)
+        {
+            rearmTask(task.get());
+        }
+    }
+}
+
+void TaskManager::rearmTask(Task* task)
+{
+    if (!task -> isReady)
+    {
+        return;
+    }
+
+    if (task -> isEventDriven())
+    {
+        if (task -> wakeQueued || task -> wakePending)
+        {
+            task -> wakeQueued = true;
+            task -> wakePending = false;
+            timerQueue.push({SimulationClock::getInstance() -> now(), task});
+        }
+        return;
+    }
+
+    timerQueue.push({task -> getNextDueTime(), task});
+}
+
+void TaskManager::dispatchReadyTasks()
+{
+    // Ready tasks leave in priority order, and only while a worker is idle:
+    // the rest wait in the ready queue, so a task released later with a
+    // higher priority still starts first instead of queueing behind them on
+    // a busy worker. A task whose exclusion group is busy is parked until
+    // the group frees up, and then competes again by priority with
+    // everything else that is ready.
+    while (inFlightTasks < workerPool -> size())
+    {
+        Task* task = selectNextTask();
+        if (task == nullptr)
+        {
+            break;
+        }
+
+        int group = task -> exclusionGroup;
+        if (group != 0 && busyGroups.count(group) != 0)
+        {
+            parkedTasks[group].push_back(task);
+            continue;
+        }
+        if (group != 0)
+        {
+            busyGroups.insert(group);
+        }
+
+        task -> inFlight = true;
+        task -> wakeQueued = false;
+        inFlightTasks++;
+        workerPool -> submit(task);
+    }
+}
+
+void TaskManager::onTaskCompleted(Task* task, bool succeeded)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        task -> inFlight = false;
+        inFlightTasks--;
+        if (!succeeded)
+        {
+            task -> isReady = false;
+        }
+
+        int group = task -> exclusionGroup;
+        if (group != 0)
+        {
+            busyGroups.erase(group);
+
+            auto parked = parkedTasks.find(group);
+            if (parked != parkedTasks.end())
+            {
+                for (Task* waiting : parked -> second)
+                {
+                    makeReady(waiting);
+                }
+                parkedTasks.erase(parked);
+            }
+        }
+
+        rearmTask(task);
+    }
+
+    scheduleCV.notify_all();
 }
 
-std::unique_ptr<Task>& TaskManager::selectNextTask()
+void TaskManager::collectDueTasks(std::chrono::steady_clock::time_point now)
 {
-    auto highestPriorityTask = std::max_element(tasks.begin(), tasks.end(),
-    [](const auto&a, const auto& b)
+    while (!timerQueue.empty() && timerQueue.top().dueTime <= now)
     {
-        if (!a -> isReady) return true;
-        if (!b -> isReady) return false;
-        return a -> getPriority() < b -> getPriority();
-    });
+        Task* task = timerQueue.top().task;
+        task -> releaseTime = timerQueue.top().dueTime;
+        task -> absoluteDeadline = task -> releaseTime + task -> getRelativeDeadline();
+        timerQueue.pop();
+
+        makeReady(task);
+    }
+}
 
-    if (highestPriorityTask != tasks.end() && (*highestPriorityTask) -> isReady)
+void TaskManager::makeReady(Task* task)
+{
+    if (policy == SchedulingPolicy::EARLIEST_DEADLINE_FIRST)
+    {
+        if (!task -> inReadyQueue)
+        {
+            task -> inReadyQueue = true;
+            deadlineQueue.push({task -> absoluteDeadline, task});
+        }
+    }
+    else
     {
-        return *highestPriorityTask;
+        readyQueue.push(task);
     }
+}
 
-    if (!tasks.empty())
+Task* TaskManager::selectNextTask()
+{
+    if (policy == SchedulingPolicy::EARLIEST_DEADLINE_FIRST)
     {
-        return tasks.front();
+        if (deadlineQueue.empty())
+        {
+            return nullptr;
+        }
+
+        Task* task = deadlineQueue.top().task;
+        deadlineQueue.pop();
+        task -> inReadyQueue = false;
+        return task;
     }
 
-    static std::unique_ptr<Task> dummyTask;
-    return dummyTask;
+    return readyQueue.popHighest();
 }
 
-void TaskManager::executeTask(Task* task)
+void TaskManager::recordRelease(Task* task, std::chrono::steady_clock::time_point start,
+                                std::chrono::steady_clock::time_point finish)
 {
-    auto now = std::chrono::steady_clock::now();
+    auto period = task -> getPeriod();
+    if (period.count() <= 0)
+    {
+        return;
+    }
+
+    DeadlineCounters& counters = task -> deadlineCounters;
+    auto startLatency = std::chrono::duration_cast<std::chrono::nanoseconds>(start - task -> releaseTime).count();
+    auto lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - task -> absoluteDeadline).count();
+
+    counters.releases.fetch_add(1, std::memory_order_relaxed);
+    updateMin(counters.minStartLatencyNs, startLatency);
+    updateMax(counters.maxStartLatencyNs, startLatency);
+    updateMax(counters.maxLatenessNs, lateness);
+
+    if (lateness > 0)
+    {
+        counters.deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto budget = task -> getWcetBudget();
+    if (budget.count() > 0 && finish - start > budget)
+    {
+        counters.budgetOverruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Next release keeps the task's phase. Releases that already lie a whole
+    // period in the past were never run and count as misses.
+    task -> nextReleaseTime += period;
+    if (task -> nextReleaseTime + period <= finish)
+    {
+        auto skipped = (finish - task -> nextReleaseTime) / period;
+        task -> nextReleaseTime += skipped * period;
+        counters.deadlineMisses.fetch_add(static_cast<uint64_t>(skipped), std::memory_order_relaxed);
+    }
+}
+
+bool TaskManager::executeTask(Task* task)
+{
+    bool succeeded = true;
+    auto now = SimulationClock::getInstance() -> now();
     auto timeSinceLastExecution = now - task -> lastExecutionTime;
+    bool periodic = task -> getPeriod().count() > 0;
 
-    if (timeSinceLastExecution >= task -> timeSlice)
+    if (periodic || task -> isEventDriven() || timeSinceLastExecution >= task -> timeSlice)
     {
+        TaskMetrics& metrics = task -> metrics;
+        auto executionStart = std::chrono::steady_clock::now();
+        auto dispatchLatency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - task -> releaseTime).count();
+        metrics.dispatchLatency.record(static_cast<uint64_t>(std::max<int64_t>(0, dispatchLatency)));
+
         try
         {
-            Logger::getInstance() -> log("Executing task: " + task -> getName(), false);
-            task -> execute();
-            task -> lastExecutionTime = std::chrono::steady_clock::now();
+            LOG_TRACE(SCHEDULER, "Executing task: %s", task -> getName());
+            {
+                TimelineSpan span("scheduler", task -> getName().c_str());
+                span.setArg(0, "dispatch_latency_ns", dispatchLatency);
+                TraceStep traceStep(*task);
+                task -> execute();
+            }
+            task -> lastExecutionTime = SimulationClock::getInstance() -> now();
+            recordRelease(task, now, task -> lastExecutionTime);
 
             auto newTimeSlice = std::chrono::milliseconds(100 + (10 * task -> getPriority()));
             newTimeSlice = std::min(maxTimeSlice, std::max(minTimeSlice, newTimeSlice));
@@ -99,58 +600,145 @@ void TaskManager::executeTask(Task* task)
         }
         catch(const std::exception& e)
         {
-            Logger::getInstance() -> log("Error executing task: " + task -> getName() + " - " + e.what(), true);
-            task -> isReady = false;
+            LOG_ERROR(SCHEDULER, "Error executing task: %s - %s", task -> getName(), e.what());
+            succeeded = false;
+            metrics.exceptions.store(metrics.exceptions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
         }
+
+        auto executionTime = std::chrono::steady_clock::now() - executionStart;
+        metrics.executionTime.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(executionTime).count()));
+        metrics.executions.store(metrics.executions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     }
+
+    return succeeded;
+}
+
+void TaskManager::waitForNextEvent(std::unique_lock<std::mutex>& lock)
+{
+    auto clock = SimulationClock::getInstance();
+
+    // Discrete-event mode: with nothing running, jump straight to the next
+    // due time instead of sleeping until it.
+    if (clock -> isVirtual() && inFlightTasks == 0 && !timerQueue.empty())
+    {
+        clock -> advanceTo(timerQueue.top().dueTime);
+        return;
+    }
+
+    if (timerQueue.empty() || clock -> isVirtual())
+    {
+        scheduleCV.wait(lock);
+    }
+    else
+    {
+        scheduleCV.wait_until(lock, timerQueue.top().dueTime);
+    }
+
+    wakeupCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TaskManager::runInline(std::unique_lock<std::mutex>& lock, Task* task)
+{
+    task -> inFlight = true;
+    task -> wakeQueued = false;
+    inFlightTasks++;
+    lock.unlock();
+    bool succeeded = executeTask(task);
+    lock.lock();
+    task -> inFlight = false;
+    inFlightTasks--;
+    if (!succeeded)
+    {
+        task -> isReady = false;
+    }
+
+    rearmTask(task);
 }
 
 void TaskManager::schedulerLoop()
 {
+    Timeline::getInstance() -> nameThread("scheduler");
+    std::unique_lock<std::mutex> lock(taskMutex);
+
     while (isRunning)
     {
-       std::this_thread::sleep_for(std::chrono::milliseconds(100));
-       
-       std::unique_lock<std::mutex> lock(taskMutex);
-
-       if (tasks.empty())
-       {
-           scheduleCV.wait(lock, [this]()
-           {
-               return !isRunning || !tasks.empty();
-           });
-           
-           if (!isRunning) break;
-           continue;
-       }
-
-       bool hasReady = hasReadyTasks();
-       if (!hasReady)
-       {
-           lock.unlock();
-           std::this_thread::sleep_for(std::chrono::milliseconds(500));
-           continue;
-       }
-
-       auto& nextTask = selectNextTask();
-       
-       if (!nextTask)
-       {
-           lock.unlock();
-           std::this_thread::sleep_for(std::chrono::milliseconds(100));
-           continue;
-       }
-       
-       lock.unlock();
-
-       if (nextTask->isReady)
-       {
-           executeTask(nextTask.get());
-           std::this_thread::sleep_for(std::chrono::milliseconds(200));
-       }
+        if (rescheduleRequested)
+        {
+            rescheduleRequested = false;
+            rebuildTimerQueue();
+        }
+
+        collectDueTasks(SimulationClock::getInstance() -> now());
+
+        if (workerPool)
+        {
+            dispatchReadyTasks();
+        }
+
+        Task* nextTask = workerPool ? nullptr : selectNextTask();
+
+        if (nextTask == nullptr)
+        {
+            waitForNextEvent(lock);
+            continue;
+        }
+
+        runInline(lock, nextTask);
     }
 }
 
+void TaskManager::runUntil(std::chrono::steady_clock::time_point endTime)
+{
+    if (isRunning)
+    {
+        LOG_WARN(SCHEDULER, "runUntil ignored: the scheduler thread is running");
+        return;
+    }
+
+    auto clock = SimulationClock::getInstance();
+    std::unique_lock<std::mutex> lock(taskMutex);
+
+    while (true)
+    {
+        collectDueTasks(clock -> now());
+        Task* nextTask = selectNextTask();
+
+        if (nextTask != nullptr)
+        {
+            runInline(lock, nextTask);
+            continue;
+        }
+
+        if (timerQueue.empty() || timerQueue.top().dueTime > endTime)
+        {
+            if (clock -> isVirtual())
+            {
+                clock -> advanceTo(endTime);
+            }
+            else
+            {
+                scheduleCV.wait_until(lock, endTime);
+            }
+            break;
+        }
+
+        if (clock -> isVirtual())
+        {
+            clock -> advanceTo(timerQueue.top().dueTime);
+        }
+        else
+        {
+            scheduleCV.wait_until(lock, timerQueue.top().dueTime);
+        }
+    }
+}
+
+void TaskManager::runFor(std::chrono::steady_clock::duration duration)
+{
+    runUntil(SimulationClock::getInstance() -> now() + duration);
+}
+
 TaskManager::TaskStatistics TaskManager::getStatistics() const
 {
     std::unique_lock<std::mutex> lock(taskMutex);
@@ -168,9 +756,56 @@ TaskManager::TaskStatistics TaskManager::getStatistics() const
         }
 
         stats.taskPriorities.push_back({task -> getName(), task -> getPriority()});
+
+        const TaskMetrics& metrics = task -> metrics;
+        uint64_t executions = metrics.executions.load(std::memory_order_relaxed);
+        stats.completedTaskCount += executions;
+        stats.taskLatencies.push_back({task -> getName(), executions,
+                                       metrics.exceptions.load(std::memory_order_relaxed),
+                                       metrics.executionTime.summarize(),
+                                       metrics.dispatchLatency.summarize()});
     }
 
-    return stats;
-}
+    // Since the start rather than since the last call, so that callers do
+    // not skew each other's rates
+    uint64_t wakeups = wakeupCount.load(std::memory_order_relaxed);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - schedulerStartTime).count();
+
+    stats.schedulerWakeups = wakeups;
+    stats.wakeupsPerSecond = isRunning && elapsed > 0.0 ? (wakeups - wakeupsAtStart) / elapsed : 0.0;
+
+    stats.policy = policy;
+    stats.utilization = 0.0;
+
+    for (const auto& task : tasks)
+    {
+        const DeadlineCounters& counters = task -> deadlineCounters;
+        auto period = task -> getPeriod();
+
+        if (period.count() <= 0)
+        {
+            continue;
+        }
+
+        stats.utilization += static_cast<double>(task -> getWcetBudget().count()) / period.count();
 
+        uint64_t releases = counters.releases.load(std::memory_order_relaxed);
+        int64_t jitter = releases > 0 ? counters.maxStartLatencyNs.load(std::memory_order_relaxed) -
+                                        counters.minStartLatencyNs.load(std::memory_order_relaxed) : 0;
+        int64_t lateness = releases > 0 ? counters.maxLatenessNs.load(std::memory_order_relaxed) : 0;
 
+        stats.taskTimings.push_back({task -> getName(), period, task -> getRelativeDeadline(),
+                                     task -> getWcetBudget(), releases,
+                                     counters.deadlineMisses.load(std::memory_order_relaxed),
+                                     counters.budgetOverruns.load(std::memory_order_relaxed),
+                                     std::chrono::nanoseconds(lateness), std::chrono::nanoseconds(jitter)});
+    }
+
+    stats.workerCount = workerPool ? workerPool -> size() : 0;
+    if (workerPool)
+    {
+        stats.workers = workerPool -> getStatistics();
+    }
+
+    return stats;
+}
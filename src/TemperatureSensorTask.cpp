@@ -1,23 +1,24 @@
 #include "TemperatureSensorTask.hpp"
+#include "EventBus.hpp"
+#include "RuleEngine.hpp"
+#include "TimeSeries.hpp"
+#include "SensorStatistics.hpp"
 #include "Logger.hpp"
-#include <sstream>
-#include <ctime>
+#include "SimulationClock.hpp"
+#include "SimulationTrace.hpp"
 
 float TemperatureSensor::currentTemperature = 22.0f;  // Start with a reasonable default
 std::mutex TemperatureSensor::temperatureMutex;
 
 TemperatureSensor::TemperatureSensor(const std::string& sensorName)
-    : Sensor(sensorName)
+    : Sensor(sensorName), rng(RandomService::getInstance() -> createStream("sensor." + sensorName))
 {
-    std::random_device rd;
-    rng = std::mt19937(rd());
-    tempVariation = std::uniform_real_distribution<float>(-0.5f, 0.5f);
 }
 
 float TemperatureSensor::readValue()
 {
     std::lock_guard<std::mutex> lock(valueMutex);
-    return currentTemperature + tempVariation(rng);
+    return currentTemperature + rng.uniform(-0.5f, 0.5f);
 }
 
 float TemperatureSensor::getLastReading()
@@ -33,47 +34,41 @@ void TemperatureSensor::setReading(float temperature)
 }
 
 TemperatureSensorTask::TemperatureSensorTask(const std::string& taskName, int taskPriority)
-    : name(taskName), priority(taskPriority)
+    : name(taskName), priority(taskPriority), rng(RandomService::getInstance() -> createStream("temperature")),
+      temperatureInput(RuleEngine::getInstance() -> getInput("temperature")),
+      history(TimeSeriesStore::getInstance() -> getSeries("temperature")),
+      statistics(SensorMonitor::getInstance() -> getSensor("temperature"))
 {
+    exclusionGroup = HOME_STATE_GROUP;
+    // Same 25/20 °C limits the control panel used to apply to single
+    // readings, now on the smoothed value with a 1 °C band to clear
+    statistics.setAlertBands({25.0f, 24.0f, 20.0f, 21.0f});
     sensor = std::make_unique<TemperatureSensor>("Main Temperature Sensor");
-    lastExecuted = std::chrono::steady_clock::now();
     
-    Logger::getInstance() -> log("Temperature sensor system initialized", true);
+    LOG_INFO(SENSORS, "Temperature sensor system initialized");
 }
 
 void TemperatureSensorTask::execute()
 {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastExecuted).count();
+    SimulationTrace* trace = SimulationTrace::getInstance();
+    float simulatedTemp = trace -> input(TraceInput::TEMPERATURE, simulateTemperature());
 
-    if (elapsed >= 30)
-    {
-        float simulatedTemp = simulateTemperature();
-
-        TemperatureSensor::setReading(simulatedTemp);
+    TemperatureSensor::setReading(simulatedTemp);
 
-        float reading = sensor->readValue();
-        
-        std::stringstream ss;
-        ss << "Temperature updated: " << reading << "°C";
-        Logger::getInstance() -> log(ss.str(), false);
-        
-        lastExecuted = now;
-    }
+    float reading = trace -> input(TraceInput::TEMPERATURE_READING, sensor->readValue());
+    
+    LOG_DEBUG(SENSORS, "Temperature updated: %g°C", reading);
+    auto now = SimulationClock::getInstance() -> now();
+    history.append(now, reading);
+    statistics.update(now, reading);
+    EventBus::getInstance() -> publish(TemperatureReading{reading});
+    RuleEngine::getInstance() -> setInput(temperatureInput, reading);
+    RuleEngine::getInstance() -> evaluate();
 }
 
-float TemperatureSensorTask::simulateTemperature() const
+float TemperatureSensorTask::simulateTemperature()
 {
-    time_t now = time(0);
-    struct tm timeInfo;
-    
-#ifdef _WIN32
-    localtime_s(&timeInfo, &now);
-#else
-    localtime_r(&now, &timeInfo);
-#endif
-    
-    int hour = timeInfo.tm_hour;
+    int hour = SimulationClock::getInstance() -> localHour();
 
     float baseTemp = 20.0f;
     if (hour >= 0 && hour < 6) 
@@ -93,11 +88,7 @@ float TemperatureSensorTask::simulateTemperature() const
         baseTemp = 25.2f - ((hour - 18) * 1.2f); 
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
-    
-    return baseTemp + dis(gen);
+    return baseTemp + rng.uniform(-1.0f, 1.0f);
 }
 
 const std::string& TemperatureSensorTask::getName() const
@@ -108,4 +99,14 @@ const std::string& TemperatureSensorTask::getName() const
 int TemperatureSensorTask::getPriority() const
 {
     return priority;
+}
+
+std::chrono::milliseconds TemperatureSensorTask::getPeriod() const
+{
+    return std::chrono::seconds(30);
+}
+
+std::chrono::milliseconds TemperatureSensorTask::getWcetBudget() const
+{
+    return std::chrono::milliseconds(20);
 }
\ No newline at end of file
@@ -0,0 +1,368 @@
+#include "TimeSeries.hpp"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+TimeSeriesStore* TimeSeriesStore::instance = nullptr;
+
+namespace
+{
+
+void writeBits(TimeSeriesBlock& block, uint64_t value, unsigned count)
+{
+    while (count > 0)
+    {
+        unsigned offset = static_cast<unsigned>(block.bitCount & 63);
+        if (offset == 0)
+        {
+            block.words.push_back(0);
+        }
+
+        unsigned available = 64 - offset;
+        unsigned take = count < available ? count : available;
+        uint64_t chunk = (count == 64 ? value : value & ((uint64_t{1} << count) - 1)) >> (count - take);
+        block.words.back() |= chunk << (available - take);
+        block.bitCount += take;
+        count -= take;
+    }
+}
+
+// Both require a non-zero argument
+unsigned leadingZeros(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, value);
+    return 31u - static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_clz(value));
+#endif
+}
+
+unsigned trailingZeros(uint32_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+}
+
+bool fitsSigned(int64_t value, unsigned width)
+{
+    int64_t limit = int64_t{1} << (width - 1);
+    return value >= -limit && value < limit;
+}
+
+void encodeTimestamp(TimeSeriesBlock& block, int64_t millis)
+{
+    int64_t delta = millis - block.lastMillis;
+    int64_t deltaOfDelta = delta - block.previousDelta;
+    block.previousDelta = delta;
+
+    if (deltaOfDelta == 0)
+    {
+        writeBits(block, 0b0, 1);
+    }
+    else if (fitsSigned(deltaOfDelta, 7))
+    {
+        writeBits(block, 0b10, 2);
+        writeBits(block, static_cast<uint64_t>(deltaOfDelta), 7);
+    }
+    else if (fitsSigned(deltaOfDelta, 9))
+    {
+        writeBits(block, 0b110, 3);
+        writeBits(block, static_cast<uint64_t>(deltaOfDelta), 9);
+    }
+    else if (fitsSigned(deltaOfDelta, 12))
+    {
+        writeBits(block, 0b1110, 4);
+        writeBits(block, static_cast<uint64_t>(deltaOfDelta), 12);
+    }
+    else
+    {
+        writeBits(block, 0b1111, 4);
+        writeBits(block, static_cast<uint64_t>(deltaOfDelta), 64);
+    }
+}
+
+void encodeValue(TimeSeriesBlock& block, uint32_t bits)
+{
+    uint32_t xorBits = bits ^ block.previousBits;
+    block.previousBits = bits;
+
+    if (xorBits == 0)
+    {
+        writeBits(block, 0b0, 1);
+        return;
+    }
+
+    uint8_t leading = static_cast<uint8_t>(leadingZeros(xorBits));
+    uint8_t trailing = static_cast<uint8_t>(trailingZeros(xorBits));
+
+    // Reuse the previous window when the meaningful bits fall inside it
+    if (block.previousLeading != 0xFF && leading >= block.previousLeading && trailing >= block.previousTrailing)
+    {
+        unsigned meaningful = 32u - block.previousLeading - block.previousTrailing;
+        writeBits(block, 0b10, 2);
+        writeBits(block, xorBits >> block.previousTrailing, meaningful);
+        return;
+    }
+
+    unsigned meaningful = 32u - leading - trailing;
+    writeBits(block, 0b11, 2);
+    writeBits(block, leading, 5);
+    writeBits(block, meaningful - 1, 5);
+    writeBits(block, xorBits >> trailing, meaningful);
+    block.previousLeading = leading;
+    block.previousTrailing = trailing;
+}
+
+}
+
+TimeSeries::TimeSeries(const std::string& seriesName, std::chrono::milliseconds retentionPeriod)
+    : name(seriesName), retention(retentionPeriod)
+{
+}
+
+int64_t TimeSeries::toMillis(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::steady_clock::time_point TimeSeries::fromMillis(int64_t millis)
+{
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::milliseconds(millis)));
+}
+
+void TimeSeries::seal()
+{
+    TimeSeriesBlock& open = blocks.back();
+    open.words.shrink_to_fit();
+    sealedBytes += open.byteSize();
+    blocks.emplace_back();
+
+    // Drop whole blocks that ended before the retention window
+    int64_t cutoff = open.lastMillis - retention.count();
+    while (blocks.size() > 1 && blocks.front().lastMillis < cutoff)
+    {
+        sampleCount -= blocks.front().count;
+        sealedBytes -= blocks.front().byteSize();
+        blocks.pop_front();
+    }
+}
+
+bool TimeSeries::append(std::chrono::steady_clock::time_point time, float value)
+{
+    int64_t millis = toMillis(time);
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::unique_lock<std::shared_mutex> lock(seriesMutex);
+
+    if (blocks.empty())
+    {
+        blocks.emplace_back();
+    }
+    else if (blocks.back().count > 0 && millis < blocks.back().lastMillis)
+    {
+        return false;
+    }
+
+    TimeSeriesBlock& block = blocks.back();
+    if (block.count == 0)
+    {
+        block.firstMillis = millis;
+        block.previousBits = bits;
+        writeBits(block, bits, 32);
+    }
+    else
+    {
+        encodeTimestamp(block, millis);
+        encodeValue(block, bits);
+    }
+
+    block.lastMillis = millis;
+    block.count++;
+    block.min = std::min(block.min, value);
+    block.max = std::max(block.max, value);
+    block.sum += value;
+    sampleCount++;
+
+    if (block.count == TimeSeriesBlock::SAMPLES_PER_BLOCK)
+    {
+        seal();
+    }
+    return true;
+}
+
+std::vector<TimeSeriesSample> TimeSeries::range(std::chrono::steady_clock::time_point from,
+                                                std::chrono::steady_clock::time_point to) const
+{
+    std::vector<TimeSeriesSample> samples;
+    scan(from, to, [&samples](std::chrono::steady_clock::time_point time, float value)
+    {
+        samples.push_back({time, value});
+    });
+    return samples;
+}
+
+std::vector<TimeSeriesAggregate> TimeSeries::downsample(std::chrono::steady_clock::time_point from,
+                                                        std::chrono::steady_clock::time_point to,
+                                                        std::chrono::milliseconds bucket) const
+{
+    std::vector<TimeSeriesAggregate> aggregates;
+    int64_t startMillis = toMillis(from);
+    int64_t endMillis = toMillis(to);
+    int64_t width = std::max<int64_t>(bucket.count(), 1);
+
+    struct Accumulator
+    {
+        int64_t index{-1};
+        float min{0.0f};
+        float max{0.0f};
+        double sum{0.0};
+        size_t count{0};
+    } current;
+
+    auto flush = [&]()
+    {
+        if (current.count > 0)
+        {
+            aggregates.push_back({fromMillis(startMillis + current.index * width), current.min, current.max,
+                                  current.sum / current.count, current.count});
+        }
+    };
+    auto add = [&](int64_t index, float min, float max, double sum, size_t count)
+    {
+        if (index != current.index)
+        {
+            flush();
+            current = {index, min, max, sum, count};
+            return;
+        }
+        current.min = std::min(current.min, min);
+        current.max = std::max(current.max, max);
+        current.sum += sum;
+        current.count += count;
+    };
+
+    std::shared_lock<std::shared_mutex> lock(seriesMutex);
+    for (const TimeSeriesBlock& block : blocks)
+    {
+        if (block.count == 0 || block.lastMillis < startMillis)
+        {
+            continue;
+        }
+        if (block.firstMillis > endMillis)
+        {
+            break;
+        }
+
+        // A block inside the range and inside one bucket is folded in from
+        // its header without decoding
+        int64_t firstIndex = (block.firstMillis - startMillis) / width;
+        if (block.firstMillis >= startMillis && block.lastMillis <= endMillis &&
+            firstIndex == (block.lastMillis - startMillis) / width)
+        {
+            add(firstIndex, block.min, block.max, block.sum, block.count);
+            continue;
+        }
+
+        TimeSeriesBlockReader reader(block);
+        int64_t millis;
+        float value;
+        while (reader.next(millis, value) && millis <= endMillis)
+        {
+            if (millis >= startMillis)
+            {
+                add((millis - startMillis) / width, value, value, value, 1);
+            }
+        }
+    }
+    flush();
+
+    return aggregates;
+}
+
+const std::string& TimeSeries::getName() const
+{
+    return name;
+}
+
+void TimeSeries::setRetention(std::chrono::milliseconds retentionPeriod)
+{
+    std::unique_lock<std::shared_mutex> lock(seriesMutex);
+    retention = retentionPeriod;
+}
+
+TimeSeries::Statistics TimeSeries::getStatistics() const
+{
+    std::shared_lock<std::shared_mutex> lock(seriesMutex);
+
+    size_t bytes = sealedBytes + (blocks.empty() ? 0 : blocks.back().byteSize());
+    Statistics statistics{name, sampleCount, blocks.size(), bytes,
+                          sampleCount > 0 ? static_cast<double>(bytes) / sampleCount : 0.0, {}, {}};
+    if (sampleCount > 0)
+    {
+        statistics.oldest = fromMillis(blocks.front().firstMillis);
+        statistics.newest = fromMillis(blocks.back().count > 0 ? blocks.back().lastMillis
+                                                               : blocks[blocks.size() - 2].lastMillis);
+    }
+
+    return statistics;
+}
+
+TimeSeriesStore* TimeSeriesStore::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new TimeSeriesStore();
+    }
+
+    return instance;
+}
+
+TimeSeries& TimeSeriesStore::getSeries(const std::string& seriesName)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    auto found = series.find(seriesName);
+    if (found != series.end())
+    {
+        return *found -> second;
+    }
+
+    auto created = std::make_unique<TimeSeries>(seriesName, retention);
+    TimeSeries* result = created.get();
+    series.emplace(seriesName, std::move(created));
+    ordered.push_back(result);
+    return *result;
+}
+
+void TimeSeriesStore::setRetention(std::chrono::milliseconds retentionPeriod)
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+    retention = retentionPeriod;
+    for (TimeSeries* existing : ordered)
+    {
+        existing -> setRetention(retentionPeriod);
+    }
+}
+
+std::vector<TimeSeries::Statistics> TimeSeriesStore::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    std::vector<TimeSeries::Statistics> statistics;
+    for (const TimeSeries* existing : ordered)
+    {
+        statistics.push_back(existing -> getStatistics());
+    }
+    return statistics;
+}
@@ -0,0 +1,240 @@
+#include "Timeline.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+Timeline* Timeline::instance = nullptr;
+std::atomic<bool> Timeline::enabled{false};
+
+namespace
+{
+
+void writeJsonString(std::FILE* file, const char* text)
+{
+    std::fputc('"', file);
+    for (const char* c = text; *c != '\0'; c++)
+    {
+        unsigned char character = static_cast<unsigned char>(*c);
+        if (character == '"' || character == '\\')
+        {
+            std::fputc('\\', file);
+            std::fputc(character, file);
+        }
+        else if (character < 0x20)
+        {
+            std::fprintf(file, "\\u%04x", character);
+        }
+        else
+        {
+            std::fputc(character, file);
+        }
+    }
+    std::fputc('"', file);
+}
+
+}
+
+Timeline* Timeline::getInstance()
+{
+    if (instance == nullptr)
+    {
+        instance = new Timeline();
+    }
+
+    return instance;
+}
+
+Timeline::ThreadBuffer& Timeline::getThreadBuffer()
+{
+    // Buffers are never freed, so one outlives its thread and stays
+    // exportable
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(timelineMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers.back().get();
+        buffer -> threadId = static_cast<uint32_t>(buffers.size());
+    }
+    return *buffer;
+}
+
+void Timeline::append(const TimelineEvent& event)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    uint32_t current = generation.load(std::memory_order_acquire);
+
+    // First event of a new recording on this thread. Exports skip the
+    // buffer until its generation is stored, so it can be reset here.
+    if (buffer.generation.load(std::memory_order_relaxed) != current)
+    {
+        std::lock_guard<std::mutex> lock(timelineMutex);
+        if (buffer.capacity != eventsPerThread)
+        {
+            // Left uninitialized, so that pages are only touched as events
+            // fill them rather than all at once on this thread's first event
+            buffer.events.reset(new TimelineEvent[eventsPerThread]);
+            buffer.capacity = eventsPerThread;
+        }
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.generation.store(current, std::memory_order_release);
+    }
+
+    size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index == buffer.capacity)
+    {
+        buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[index] = event;
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void Timeline::start(size_t maxEventsPerThread)
+{
+    std::lock_guard<std::mutex> lock(timelineMutex);
+    eventsPerThread = std::max<size_t>(maxEventsPerThread, 1);
+    generation.fetch_add(1, std::memory_order_acq_rel);
+    enabled.store(true, std::memory_order_release);
+}
+
+void Timeline::stop()
+{
+    enabled.store(false, std::memory_order_release);
+}
+
+void Timeline::nameThread(const std::string& name)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(timelineMutex);
+    buffer.threadName = name;
+}
+
+void Timeline::recordSpan(const char* category, const char* name, uint64_t startNanos, uint64_t endNanos,
+                          const char* argName0, int64_t arg0, const char* argName1, int64_t arg1)
+{
+    append({name, category, startNanos, endNanos - startNanos, {argName0, argName1}, {arg0, arg1},
+            TimelinePhase::SPAN});
+}
+
+void Timeline::recordInstant(const char* category, const char* name, const char* argName0, int64_t arg0,
+                             const char* argName1, int64_t arg1)
+{
+    append({name, category, nowNanos(), 0, {argName0, argName1}, {arg0, arg1}, TimelinePhase::INSTANT});
+}
+
+bool Timeline::exportJson(const std::string& path, std::string& error) const
+{
+    std::lock_guard<std::mutex> lock(timelineMutex);
+    uint32_t current = generation.load(std::memory_order_acquire);
+
+    // Timestamps are written relative to the first event, in microseconds
+    uint64_t origin = UINT64_MAX;
+    for (const auto& buffer : buffers)
+    {
+        if (buffer -> generation.load(std::memory_order_acquire) == current)
+        {
+            size_t count = buffer -> count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++)
+            {
+                origin = std::min(origin, buffer -> events[i].startNanos);
+            }
+        }
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"smart_home_rtos\"}}", file);
+
+    for (const auto& buffer : buffers)
+    {
+        if (!buffer -> threadName.empty())
+        {
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRIu32
+                               ",\"args\":{\"name\":", buffer -> threadId);
+            writeJsonString(file, buffer -> threadName.c_str());
+            std::fputs("}}", file);
+        }
+        if (buffer -> generation.load(std::memory_order_acquire) != current)
+        {
+            continue;
+        }
+
+        size_t count = buffer -> count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; i++)
+        {
+            const TimelineEvent& event = buffer -> events[i];
+            std::fputs(",\n{\"name\":", file);
+            writeJsonString(file, event.name);
+            std::fputs(",\"cat\":", file);
+            writeJsonString(file, event.category);
+
+            uint64_t start = event.startNanos - origin;
+            std::fprintf(file, ",\"pid\":1,\"tid\":%" PRIu32 ",\"ts\":%" PRIu64 ".%03u", buffer -> threadId,
+                         start / 1000, static_cast<unsigned>(start % 1000));
+            if (event.phase == TimelinePhase::SPAN)
+            {
+                std::fprintf(file, ",\"ph\":\"X\",\"dur\":%" PRIu64 ".%03u", event.durationNanos / 1000,
+                             static_cast<unsigned>(event.durationNanos % 1000));
+            }
+            else
+            {
+                std::fputs(",\"ph\":\"i\",\"s\":\"t\"", file);
+            }
+
+            if (event.argNames[0] != nullptr)
+            {
+                std::fputs(",\"args\":{", file);
+                for (size_t arg = 0; arg < 2 && event.argNames[arg] != nullptr; arg++)
+                {
+                    if (arg > 0)
+                    {
+                        std::fputc(',', file);
+                    }
+                    writeJsonString(file, event.argNames[arg]);
+                    std::fprintf(file, ":%" PRId64, event.args[arg]);
+                }
+                std::fputc('}', file);
+            }
+            std::fputc('}', file);
+        }
+    }
+    std::fputs("\n]}\n", file);
+
+    bool failed = std::ferror(file) != 0;
+    if (std::fclose(file) != 0 || failed)
+    {
+        error = "cannot write " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+TimelineStatistics Timeline::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(timelineMutex);
+    uint32_t current = generation.load(std::memory_order_acquire);
+    TimelineStatistics statistics{isEnabled(), 0, 0, 0};
+
+    for (const auto& buffer : buffers)
+    {
+        if (buffer -> generation.load(std::memory_order_acquire) == current)
+        {
+            statistics.threads++;
+            statistics.events += buffer -> count.load(std::memory_order_acquire);
+            statistics.dropped += buffer -> dropped.load(std::memory_order_relaxed);
+        }
+    }
+    return statistics;
+}
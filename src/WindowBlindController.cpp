@@ -1,67 +1,91 @@
 #include "WindowBlindController.hpp"
+#include "EventBus.hpp"
 #include "Logger.hpp"
-#include <sstream>
-#include <vector>
+#include "Metrics.hpp"
+#include "SimulationClock.hpp"
 
-static std::vector<WindowBlindController*> allBlinds;
+WindowBlindController::WindowBlindController(DeviceTable& blinds, DeviceHandle blindHandle)
+    : table(&blinds), handle(blindHandle)
+{
+}
 
-WindowBlindController::WindowBlindController(const std::string& controllerName, int id)
-    : Sensor(controllerName), 
-      currentPosition(BlindsPosition::CLOSED),
-      windowId(id),
-      lastMoveTime(std::chrono::steady_clock::now())
+WindowBlindController WindowBlindController::create(const std::string& controllerName, int id)
 {
-    allBlinds.push_back(this);
+    DeviceRegistry* registry = DeviceRegistry::getInstance();
+    return WindowBlindController(registry -> getBlinds(), registry -> registerDevice(DeviceType::BLIND, id, controllerName));
 }
 
-float WindowBlindController::readValue()
+float WindowBlindController::readValue() const
 {
-    std::lock_guard<std::mutex> lock(valueMutex);
-    return static_cast<float>(static_cast<int>(currentPosition));
+    return static_cast<float>(table -> getLevel(handle));
 }
 
-bool WindowBlindController::setPosition(BlindsPosition position)
+bool WindowBlindController::setPositionLocked(DeviceTable& blinds, DeviceHandle handle, BlindsPosition position,
+                                              std::chrono::steady_clock::time_point now)
 {
-    std::lock_guard<std::mutex> lock(valueMutex);
+    uint32_t nowMillis = blinds.toMillis(now);
+    DeviceState previous;
+    bool moved = blinds.transition(handle, [nowMillis, position](DeviceState& blind)
+    {
+        if (blind.millisSinceChange(nowMillis) < static_cast<uint32_t>(MOVE_COOLDOWN_MS))
+        {
+            return false;
+        }
 
-    auto now = std::chrono::steady_clock::now();
-    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastMoveTime).count();
+        blind.level = static_cast<uint8_t>(position);
+        blind.lastChangeMillis = nowMillis;
+        return true;
+    }, &previous);
 
-    if (elapsedMs < MOVE_COOLDOWN_MS)
+    if (!moved)
     {
-        return false;
+        Metrics::getInstance() -> blindsCooldownRejections.add();
     }
-
-    lastMoveTime = now;
-
-    if (position != currentPosition)
+    if (moved && previous.level != static_cast<uint8_t>(position))
     {
-        std::stringstream logMsg;
-        logMsg << "Window " << windowId << " blinds moving from " 
-               << static_cast<int>(currentPosition) << "% to " 
-               << static_cast<int>(position) << "%";
-               
-        Logger::getInstance() -> log(logMsg.str(), true);
-        
-        currentPosition = position;
+        LOG_INFO(BLINDS, "Window %d blinds moving from %d%% to %d%%",
+                 blinds.getDeviceId(handle), static_cast<int>(previous.level), static_cast<int>(position));
+        EventBus::getInstance() -> publish(DeviceStateChanged{DeviceType::BLIND, blinds.getDeviceId(handle), 0,
+                                                              static_cast<uint8_t>(position)});
     }
 
-    return true;
+    return moved;
+}
+
+bool WindowBlindController::setPosition(BlindsPosition position)
+{
+    std::shared_lock<std::shared_mutex> lock(table -> getMutex());
+    return setPositionLocked(*table, handle, position, SimulationClock::getInstance() -> now());
 }
 
 BlindsPosition WindowBlindController::getPosition() const
 {
-    return currentPosition;
+    return static_cast<BlindsPosition>(table -> getLevel(handle));
 }
 
 int WindowBlindController::getWindowId() const
 {
-    return windowId;
+    return table -> getDeviceId(handle);
+}
+
+DeviceHandle WindowBlindController::getHandle() const
+{
+    return handle;
+}
+
+const char* WindowBlindController::getName() const
+{
+    return DeviceRegistry::getInstance() -> getName(DeviceType::BLIND, handle);
 }
 
 std::string WindowBlindController::getPositionName() const
 {
-    switch (currentPosition)
+    return getPositionName(getPosition());
+}
+
+const char* WindowBlindController::getPositionName(BlindsPosition position)
+{
+    switch (position)
     {
         case BlindsPosition::CLOSED: 
             return "CLOSED";
@@ -78,22 +102,53 @@ std::string WindowBlindController::getPositionName() const
     }
 }
 
-void WindowBlindController::openAllBlinds()
+GroupResult WindowBlindController::setGroupPosition(const DeviceGroup& group, BlindsPosition position)
 {
-    for (auto& blind : allBlinds)
-    {
-        blind -> setPosition(BlindsPosition::OPEN);
-    }
+    uint8_t target = static_cast<uint8_t>(position);
 
-    Logger::getInstance() -> log("Command: Opening all blinds", true);
+    GroupResult result = group.apply([target](DeviceState& blind, uint32_t nowMillis)
+    {
+        if (blind.level == target)
+        {
+            return GroupOutcome::UNCHANGED;
+        }
+        if (blind.millisSinceChange(nowMillis) < static_cast<uint32_t>(MOVE_COOLDOWN_MS))
+        {
+            return GroupOutcome::HELD_BY_COOLDOWN;
+        }
+
+        blind.level = target;
+        blind.lastChangeMillis = nowMillis;
+        return GroupOutcome::CHANGED;
+    });
+
+    LOG_INFO(BLINDS, "Group %s: moving %u blinds to %d%% (%u held by cooldown, %u already there, %u unknown)",
+             group.getName(), result.changed.size(), static_cast<int>(position), result.heldByCooldown.size(),
+             result.unchanged, result.missing);
+    Metrics::getInstance() -> blindsCooldownRejections.add(result.heldByCooldown.size());
+
+    publishGroupChange(result, target);
+    return result;
 }
 
-void WindowBlindController::closeAllBlinds()
+void WindowBlindController::publishGroupChange(const GroupResult& result, uint8_t level)
 {
-    for (auto& blind : allBlinds)
+    EventBus* bus = EventBus::getInstance();
+    if (bus -> hasSubscribers(EventTopic::DEVICE_STATE_CHANGE))
     {
-        blind -> setPosition(BlindsPosition::CLOSED);
+        for (int windowId : result.changed)
+        {
+            bus -> publish(DeviceStateChanged{DeviceType::BLIND, windowId, 0, level});
+        }
     }
+}
 
-    Logger::getInstance() -> log("Command: Closing all blinds", true);
-}
\ No newline at end of file
+GroupResult WindowBlindController::openAllBlinds()
+{
+    return setGroupPosition(DeviceGroup::all("all blinds", DeviceType::BLIND), BlindsPosition::OPEN);
+}
+
+GroupResult WindowBlindController::closeAllBlinds()
+{
+    return setGroupPosition(DeviceGroup::all("all blinds", DeviceType::BLIND), BlindsPosition::CLOSED);
+}
@@ -1,53 +1,50 @@
 #include "WindowBlindTask.hpp"
+#include "EventBus.hpp"
+#include "HomeTopology.hpp"
 #include "Logger.hpp"
-#include <random>
-#include <ctime>
-#include <sstream>
+#include "RuleEngine.hpp"
+#include "TimeSeries.hpp"
+#include "SensorStatistics.hpp"
+#include "SimulationClock.hpp"
+#include "SimulationTrace.hpp"
+#include <algorithm>
+#include <cstdio>
 
 WindowBlindTask::WindowBlindTask(const std::string& taskName, int taskPriority)
-    : name(taskName), priority(taskPriority)
+    : blinds(DeviceRegistry::getInstance() -> getBlinds()), name(taskName), priority(taskPriority),
+      rng(RandomService::getInstance() -> createStream("blinds.outdoor-light")),
+      hourInput(RuleEngine::getInstance() -> getInput("hour")),
+      outdoorLightInput(RuleEngine::getInstance() -> getInput("outdoor_light")),
+      lightHistory(TimeSeriesStore::getInstance() -> getSeries("outdoor_light")),
+      lightStatistics(SensorMonitor::getInstance() -> getSensor("outdoor_light"))
 {
-    lastExecuted = std::chrono::steady_clock::now();
+    exclusionGroup = HOME_STATE_GROUP;
+    size_t created = HomeTopology::getInstance() -> createBlinds();
 
-    controllers.push_back(std::make_unique<WindowBlindController>("Living Room Blinds", 1));
-    controllers.push_back(std::make_unique<WindowBlindController>("Bedroom Blinds", 2));
-    controllers.push_back(std::make_unique<WindowBlindController>("Kitchen Blinds", 3));
-    
-    Logger::getInstance() -> log("Window blinds system initialized with 3 controllers", true);
+    LOG_INFO(BLINDS, "Window blinds system initialized with %u controllers", created);
 }
 
 void WindowBlindTask::execute()
 {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - lastExecuted).count();
-
-    if (elapsed >= 15)
-    {
-        float lightLevel = simulateOutdoorLight();
-
-        applyTimeBasedRules();
-        applyLightBasedRules(lightLevel);
-
-        std::stringstream ss;
-        ss << "Window blinds status update - Light level: " << lightLevel;
-        Logger::getInstance() -> log(ss.str(), false);
-        
-        lastExecuted = now;
-    }
+    float lightLevel = SimulationTrace::getInstance() -> input(TraceInput::OUTDOOR_LIGHT, simulateOutdoorLight());
+    EventBus::getInstance() -> publish(LightLevelReading{lightLevel});
+    auto now = SimulationClock::getInstance() -> now();
+    lightHistory.append(now, lightLevel);
+    blinds.refreshIdleStamps(now);
+    lightStatistics.update(now, lightLevel);
+
+    // The morning, night and bright-light rules live in the rule file
+    RuleEngine* rules = RuleEngine::getInstance();
+    rules -> setInput(hourInput, static_cast<float>(SimulationClock::getInstance() -> localHour()));
+    rules -> setInput(outdoorLightInput, lightLevel);
+    rules -> evaluate();
+
+    LOG_DEBUG(BLINDS, "Window blinds status update - Light level: %g", lightLevel);
 }
 
-float WindowBlindTask::simulateOutdoorLight() const
+float WindowBlindTask::simulateOutdoorLight()
 {
-    time_t now = time(0);
-    struct tm timeInfo;
-    
-#ifdef _WIN32
-    localtime_s(&timeInfo, &now);
-#else
-    localtime_r(&now, &timeInfo);
-#endif
-    
-    int hour = timeInfo.tm_hour;
+    int hour = SimulationClock::getInstance() -> localHour();
 
     float baseLight = 0.0f;
     
@@ -68,108 +65,52 @@ float WindowBlindTask::simulateOutdoorLight() const
         baseLight = 5.0f;
     }
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<float> dis(-10.0f, 10.0f);
-    
-    return std::max(0.0f, std::min(100.0f, baseLight + dis(gen)));
+    return std::max(0.0f, std::min(100.0f, baseLight + rng.uniform(-10.0f, 10.0f)));
 }
 
-void WindowBlindTask::applyTimeBasedRules()
+const std::string& WindowBlindTask::getName() const
 {
-    time_t now = time(0);
-    struct tm timeInfo;
-    
-#ifdef _WIN32
-    localtime_s(&timeInfo, &now);
-#else
-    localtime_r(&now, &timeInfo);
-#endif
-    
-    int hour = timeInfo.tm_hour;
-
-    if (hour >= 7 && hour <= 9)
-    {
-        for (auto& controller : controllers)
-        {
-            if (controller -> getPosition() == BlindsPosition::CLOSED)
-            {
-                controller -> setPosition(BlindsPosition::HALF_OPEN);
-                std::stringstream ss;
-                ss << "Morning rule: Opening blinds for window " << controller->getWindowId();
-                Logger::getInstance() -> log(ss.str(), true);
-            }
-        }
-    }
-    
-    if (hour >= 21 || hour < 6)
-    {
-        for (auto& controller : controllers)
-        {
-            if (controller -> getPosition() != BlindsPosition::CLOSED)
-            {
-                controller -> setPosition(BlindsPosition::CLOSED);
-                std::stringstream ss;
-                ss << "Night rule: Closing blinds for window " << controller->getWindowId();
-                Logger::getInstance() -> log(ss.str(), true);
-            }
-        }
-    }
+    return name;
 }
 
-void WindowBlindTask::applyLightBasedRules(float lightLevel)
+int WindowBlindTask::getPriority() const
 {
-    if (lightLevel > 90.0f)
-    {
-        for (auto& controller : controllers)
-        {
-            if (controller -> getPosition() == BlindsPosition::OPEN)
-            {
-                controller -> setPosition(BlindsPosition::THREE_QUARTERS_OPEN);
-                std::stringstream ss;
-                ss << "High light rule: Adjusting blinds for window " << controller -> getWindowId() 
-                   << " due to bright light (" << lightLevel << "%)";
-                Logger::getInstance() -> log(ss.str(), true);
-            }
-        }
-    }
+    return priority;
 }
 
-const std::string& WindowBlindTask::getName() const
+std::chrono::milliseconds WindowBlindTask::getPeriod() const
 {
-    return name;
+    return std::chrono::seconds(15);
 }
 
-int WindowBlindTask::getPriority() const
+std::chrono::milliseconds WindowBlindTask::getWcetBudget() const
 {
-    return priority;
+    return std::chrono::milliseconds(50);
 }
 
 bool WindowBlindTask::setBlindsPosition(int windowId, BlindsPosition position)
 {
-    for (auto& controller : controllers)
+    auto now = SimulationClock::getInstance() -> now();
+
+    std::shared_lock<std::shared_mutex> lock(blinds.getMutex());
+    DeviceHandle blind = DeviceRegistry::getInstance() -> findDevice(DeviceType::BLIND, windowId);
+
+    if (blind == INVALID_DEVICE_HANDLE)
     {
-        if (controller -> getWindowId() == windowId)
-        {
-            return controller -> setPosition(position);
-        }
+        return false;
     }
-    return false;
+
+    return WindowBlindController::setPositionLocked(blinds, blind, position, now);
 }
 
-std::vector<std::pair<int, std::string>> WindowBlindTask::getStatusReport() const
+bool WindowBlindTask::getStatusSnapshot(DeviceSnapshot& snapshot) const
 {
-    std::vector<std::pair<int, std::string>> report;
-    
-    for (const auto& controller : controllers)
-    {
-        std::stringstream ss;
-        ss << "Window " << controller->getWindowId() << ": " 
-           << controller->getPositionName() << " (" 
-           << static_cast<int>(controller->getPosition()) << "%)";
-        
-        report.push_back({controller->getWindowId(), ss.str()});
-    }
-    
-    return report;
+    return snapshot.refresh(blinds);
+}
+
+int WindowBlindTask::formatStatus(const DeviceStatus& status, char* buffer, size_t size)
+{
+    BlindsPosition position = static_cast<BlindsPosition>(status.state.level);
+    return std::snprintf(buffer, size, "Window %d: %s (%d%%)", status.deviceId,
+                         WindowBlindController::getPositionName(position), static_cast<int>(position));
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "WorkerPool.hpp"
+#include "Timeline.hpp"
+#include <string>
+
+WorkerPool::WorkerPool(size_t workerCount, TaskRunner runner, CompletionHandler completion)
+    : runTask(std::move(runner)), onComplete(std::move(completion))
+{
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+void WorkerPool::start()
+{
+    stopping = false;
+    startTime = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i] -> thread = std::thread(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+std::vector<Task*> WorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    workCV.notify_all();
+
+    std::vector<Task*> unstarted;
+
+    for (auto& worker : workers)
+    {
+        if (worker -> thread.joinable())
+        {
+            worker -> thread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(worker -> queueMutex);
+        unstarted.insert(unstarted.end(), worker -> queue.begin(), worker -> queue.end());
+        worker -> queue.clear();
+    }
+
+    pendingTasks = 0;
+    return unstarted;
+}
+
+void WorkerPool::submit(Task* task)
+{
+    size_t target = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+    {
+        std::lock_guard<std::mutex> lock(workers[target] -> queueMutex);
+        workers[target] -> queue.push_back(task);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        pendingTasks++;
+    }
+    workCV.notify_one();
+}
+
+Task* WorkerPool::takeOwn(size_t workerId)
+{
+    Worker& worker = *workers[workerId];
+    std::lock_guard<std::mutex> lock(worker.queueMutex);
+
+    if (worker.queue.empty())
+    {
+        return nullptr;
+    }
+
+    Task* task = worker.queue.front();
+    worker.queue.pop_front();
+    return task;
+}
+
+Task* WorkerPool::steal(size_t thiefId)
+{
+    for (size_t offset = 1; offset < workers.size(); offset++)
+    {
+        Worker& victim = *workers[(thiefId + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.queueMutex);
+
+        if (!victim.queue.empty())
+        {
+            Task* task = victim.queue.back();
+            victim.queue.pop_back();
+            workers[thiefId] -> steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+
+    return nullptr;
+}
+
+void WorkerPool::workerLoop(size_t workerId)
+{
+    Worker& worker = *workers[workerId];
+    Timeline::getInstance() -> nameThread("worker " + std::to_string(workerId));
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            workCV.wait(lock, [this]() { return stopping || pendingTasks > 0; });
+
+            if (stopping)
+            {
+                return;
+            }
+        }
+
+        Task* task = takeOwn(workerId);
+        if (task == nullptr)
+        {
+            task = steal(workerId);
+        }
+        if (task == nullptr)
+        {
+            // Another worker got there first
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            pendingTasks--;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        bool succeeded = runTask(task);
+        auto end = std::chrono::steady_clock::now();
+
+        worker.busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(),
+                                   std::memory_order_relaxed);
+        worker.executedTasks.fetch_add(1, std::memory_order_relaxed);
+
+        onComplete(task, succeeded);
+    }
+}
+
+size_t WorkerPool::size() const
+{
+    return workers.size();
+}
+
+std::vector<WorkerPool::WorkerStatistics> WorkerPool::getStatistics() const
+{
+    std::vector<WorkerStatistics> stats;
+    auto elapsedNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        const Worker& worker = *workers[i];
+        double busy = static_cast<double>(worker.busyNanos.load(std::memory_order_relaxed));
+
+        stats.push_back({i,
+                         worker.executedTasks.load(std::memory_order_relaxed),
+                         worker.steals.load(std::memory_order_relaxed),
+                         elapsedNanos > 0 ? busy / elapsedNanos : 0.0});
+    }
+
+    return stats;
+}
@@ -2,13 +2,29 @@
 #include "Logger.hpp"
 #include "TemperatureSensorTask.hpp" 
 #include <iostream>
+#include <algorithm>
 #include <string>
 #include <map>
+#include <vector>
 #include <thread>
 #include <functional>
 #include <atomic>
+#include <cstdlib>
 #include "WindowBlindTask.hpp"
 #include "LightControlTask.hpp"
+#include "ClimateBlindTask.hpp"
+#include "EventBus.hpp"
+#include "HomeTopology.hpp"
+#include "RuleEngine.hpp"
+#include "TimeSeries.hpp"
+#include "SensorStatistics.hpp"
+#include "SimulationTrace.hpp"
+#include "MetricsServer.hpp"
+#include "StateStore.hpp"
+#include "Timeline.hpp"
+#include "SimulationClock.hpp"
+#include "RandomService.hpp"
+#include <ctime>
 
 class ControlPanel
 {
@@ -19,6 +35,40 @@ private:
     std::chrono::steady_clock::time_point startTime;
     WindowBlindTask* blindsTask;
     LightControlTask* lightTask;
+    // Reused across status commands; only refilled after a device changes
+    DeviceSnapshot blindsSnapshot;
+    DeviceSnapshot lightSnapshot;
+
+    template <typename Formatter>
+    void printSnapshot(const DeviceSnapshot& snapshot, Formatter format, const char* indent)
+    {
+        char line[128];
+        for (const DeviceStatus& status : snapshot)
+        {
+            format(status, line, sizeof(line));
+            std::cout << indent << line << "\n";
+        }
+    }
+
+    // The span of device IDs in the snapshot, for prompts; the IDs come from
+    // the home topology
+    static std::string idRange(const DeviceSnapshot& snapshot)
+    {
+        if (snapshot.size() == 0)
+        {
+            return "";
+        }
+
+        int lowest = snapshot[0].deviceId;
+        int highest = lowest;
+        for (const DeviceStatus& status : snapshot)
+        {
+            lowest = std::min(lowest, status.deviceId);
+            highest = std::max(highest, status.deviceId);
+        }
+        return lowest == highest ? " (" + std::to_string(lowest) + ")"
+                                 : " (" + std::to_string(lowest) + "-" + std::to_string(highest) + ")";
+    }
 
 public:
     ControlPanel(TaskManager* tm, WindowBlindTask* bTask, LightControlTask* lTask) 
@@ -32,7 +82,7 @@ public:
             running = false;
             std::cout << "Shutting down the Smart Home RTOS Simulator...\n";
             taskManager -> stopScheduler();
-            Logger::getInstance() -> log("Shutdown command received");
+            LOG_DEBUG(SYSTEM, "Shutdown command received");
             std::cout << "Goodbye!\n";
         };
         commands["stats"] = [this]() { showStats(); };
@@ -40,19 +90,25 @@ public:
         commands["blinds"] = [this]() { showBlindOptions(); };
         commands["lights"] = [this]() { showLightOptions(); };
         commands["status"] = [this]() { showSystemStatus(); };
+        commands["rules"] = [this]() { showRuleOptions(); };
+        commands["history"] = [this]() { showHistory(); };
+        commands["timeline"] = [this]() { showTimelineOptions(); };
     }
 
     void showHelp()
     {
         std::cout << "\n=== Smart Home RTOS Simulator Control Panel ===\n";
         std::cout << "Available commands:\n";
-        std::cout << "  help   - Show this help message\n";
-        std::cout << "  quit   - Exit the application\n";
-        std::cout << "  stats  - Show system statistics\n";
-        std::cout << "  temp   - Show current temperature\n";
-        std::cout << "  blinds - Control window blinds\n";
-        std::cout << "  lights - Control room lights\n";
-        std::cout << "  status - Show complete system status\n";
+        std::cout << "  help     - Show this help message\n";
+        std::cout << "  quit     - Exit the application\n";
+        std::cout << "  stats    - Show system statistics\n";
+        std::cout << "  temp     - Show current temperature\n";
+        std::cout << "  blinds   - Control window blinds\n";
+        std::cout << "  lights   - Control room lights\n";
+        std::cout << "  status   - Show complete system status\n";
+        std::cout << "  rules    - Show or reload automation rules\n";
+        std::cout << "  history  - Show sensor history of the last 24 hours\n";
+        std::cout << "  timeline - Record a timeline of scheduler and device activity\n";
         std::cout << "============================================\n";
     }
 
@@ -63,29 +119,103 @@ public:
         std::cout << "\n=== System Statistics ===\n";
         std::cout << "Total tasks: " << stats.totalTasks << "\n";
         std::cout << "Active tasks: " << stats.activeTasks << "\n";
+        std::cout << "Completed executions: " << stats.completedTaskCount << "\n";
         std::cout << "System uptime: " << getUpTime() << " seconds\n";
+        std::cout << "Scheduler wakeups: " << stats.schedulerWakeups
+                  << " (" << stats.wakeupsPerSecond << "/s)\n";
+
+        if (stats.workerCount > 0)
+        {
+            std::cout << "\n === Workers ===\n";
+            for (const auto& worker : stats.workers)
+            {
+                std::cout << "Worker " << worker.workerId << ": " << worker.executedTasks << " tasks, "
+                          << worker.steals << " steals, " << (worker.utilization * 100.0) << "% busy\n";
+            }
+        }
 
         std::cout << "\n === Task Priorities ===\n";
         for (const auto& [name, priority] : stats.taskPriorities)
         {
             std::cout << "Task: " << name << ", Priority: " << priority << "\n";
         }
+
+        std::cout << "\n === Deadlines (" << TaskManager::getPolicyName(stats.policy)
+                  << ", utilization " << (stats.utilization * 100.0) << "%) ===\n";
+        for (const auto& timing : stats.taskTimings)
+        {
+            std::cout << "Task: " << timing.name << ", Period: " << timing.period.count() << " ms"
+                      << ", Releases: " << timing.releases
+                      << ", Misses: " << timing.deadlineMisses
+                      << ", Overruns: " << timing.budgetOverruns
+                      << ", Max lateness: " << std::chrono::duration<double, std::milli>(timing.maxLateness).count() << " ms"
+                      << ", Jitter: " << std::chrono::duration<double, std::milli>(timing.startJitter).count() << " ms\n";
+        }
+
+        auto micros = [](uint64_t nanos) { return nanos / 1000.0; };
+        std::cout << "\n === Task Latency (us: p50/p99/p999/max) ===\n";
+        for (const auto& latency : stats.taskLatencies)
+        {
+            std::cout << "Task: " << latency.name << ", Executions: " << latency.executions
+                      << ", Exceptions: " << latency.exceptions << "\n"
+                      << "  Execution time: " << micros(latency.executionTime.p50) << "/"
+                      << micros(latency.executionTime.p99) << "/" << micros(latency.executionTime.p999) << "/"
+                      << micros(latency.executionTime.max) << "\n"
+                      << "  Dispatch latency: " << micros(latency.dispatchLatency.p50) << "/"
+                      << micros(latency.dispatchLatency.p99) << "/" << micros(latency.dispatchLatency.p999) << "/"
+                      << micros(latency.dispatchLatency.max) << "\n";
+        }
+
+        std::cout << "\n === Event Bus (" << EventBus::getInstance() -> getPublishedCount() << " published) ===\n";
+        for (const auto& subscriber : EventBus::getInstance() -> getStatistics())
+        {
+            std::cout << "Subscriber: " << subscriber.name << ", Delivered: " << subscriber.delivered
+                      << ", Dropped: " << subscriber.dropped << ", Queued: " << subscriber.queued << "\n";
+        }
+
+        auto rules = RuleEngine::getInstance() -> getStatistics();
+        std::cout << "\n === Rules (" << rules.rules.size() << " loaded) ===\n";
+        std::cout << "Input changes: " << rules.inputChanges << ", Evaluations: " << rules.evaluations
+                  << " (" << (rules.inputChanges > 0 ? static_cast<double>(rules.evaluations) / rules.inputChanges : 0.0)
+                  << " per change), Fired: " << rules.firings << "\n";
+
+        if (StateStore::getInstance() -> isOpen())
+        {
+            auto persistence = StateStore::getInstance() -> getStatistics();
+            std::cout << "\n === State Store ===\n";
+            std::cout << "Snapshots: " << persistence.snapshots << " (last " << persistence.lastSnapshotBytes
+                      << " bytes, captured in " << persistence.lastCaptureMillis << " ms, written in "
+                      << persistence.lastWriteMillis << " ms)\n";
+            std::cout << "Journal: " << persistence.journalBatches << " batches, " << persistence.journalRecords
+                      << " device changes, Failures: " << persistence.failures << "\n";
+        }
+        if (MetricsServer::getInstance() -> isRunning())
+        {
+            std::cout << "\n === Metrics ===\n";
+            std::cout << "Serving: http://127.0.0.1:" << MetricsServer::getInstance() -> getPort()
+                      << "/metrics, Scrapes: " << MetricsServer::getInstance() -> getScrapeCount() << "\n";
+        }
         std::cout << "========================\n";
     }
 
     void showTemperature()
     {
-        float temp = TemperatureSensor::getLastReading();
+        // Kept current by the sensor task; nothing is recomputed here
+        SensorSummary temp = SensorMonitor::getInstance() -> getSensor("temperature").getSummary();
 
         std::cout << "\n=== Current Temperature ===\n";
-        std::cout << "Reading latest temperature...\n";
-        std::cout << "Temperature: " << temp << " C\n";
+        std::cout << "Temperature: " << temp.latest << " C\n";
+        std::cout << "Smoothed (EWMA): " << temp.ewma << " C\n";
+        std::cout << "Last " << SensorMonitor::DEFAULT_WINDOW.count() << " min: avg " << temp.windowAverage
+                  << " C, min " << temp.windowMin << " C, max " << temp.windowMax << " C ("
+                  << temp.windowSamples << " readings)\n";
+        std::cout << "Trend: " << (temp.ratePerHour >= 0.0 ? "+" : "") << temp.ratePerHour << " C/h\n";
 
-        if (temp > 25.0)
+        if (temp.alert == SensorAlert::HIGH)
         {
             std::cout << "Warning: High temperature detected!\n";
         }
-        else if (temp < 20.0)
+        else if (temp.alert == SensorAlert::LOW)
         {
             std::cout << "Warning: Low temperature detected!\n";
         }
@@ -102,11 +232,8 @@ public:
         std::cout << "\n=== Window Blinds Control ===\n";
         std::cout << "Current blinds status:\n";
         
-        auto status = blindsTask->getStatusReport();
-        for (const auto& [id, statusMsg] : status)
-        {
-            std::cout << statusMsg << "\n";
-        }
+        blindsTask -> getStatusSnapshot(blindsSnapshot);
+        printSnapshot(blindsSnapshot, WindowBlindTask::formatStatus, "");
         
         std::cout << "\nOptions:\n";
         std::cout << "1. Set position for specific window\n";
@@ -124,7 +251,7 @@ public:
             int windowId;
             int position;
             
-            std::cout << "Enter window ID (1-3): ";
+            std::cout << "Enter window ID" << idRange(blindsSnapshot) << ": ";
             std::cin >> windowId;
             
             std::cout << "Enter position (0=Closed, 25=Quarter, 50=Half, 75=ThreeQuarters, 100=Open): ";
@@ -144,24 +271,15 @@ public:
                     pos = BlindsPosition::HALF_OPEN;
             }
             
-            if (blindsTask->setBlindsPosition(windowId, pos))
-            {
-                std::cout << "Window " << windowId << " blinds position updated.\n";
-            }
-            else
-            {
-                std::cout << "Failed to update position. Check window ID or wait for cooldown.\n";
-            }
+            runCommand(TraceCommand::SET_BLINDS, windowId, static_cast<int>(pos));
         }
         else if (choice == 2)
         {
-            WindowBlindController::openAllBlinds();
-            std::cout << "Command sent to open all blinds.\n";
+            runCommand(TraceCommand::OPEN_ALL_BLINDS, 0, 0);
         }
         else if (choice == 3)
         {
-            WindowBlindController::closeAllBlinds();
-            std::cout << "Command sent to close all blinds.\n";
+            runCommand(TraceCommand::CLOSE_ALL_BLINDS, 0, 0);
         }
         
         std::cout << "===========================\n";
@@ -172,11 +290,8 @@ public:
         std::cout << "\n=== Light Control ===\n";
         std::cout << "Current light status:\n";
         
-        auto status = lightTask->getStatusReport();
-        for (const auto& [id, statusMsg] : status)
-        {
-            std::cout << statusMsg << "\n";
-        }
+        lightTask -> getStatusSnapshot(lightSnapshot);
+        printSnapshot(lightSnapshot, LightControlTask::formatStatus, "");
         
         std::cout << "\nOptions:\n";
         std::cout << "1. Turn on/off specific room light\n";
@@ -195,28 +310,21 @@ public:
             int roomId;
             int state;
             
-            std::cout << "Enter room ID (1-4): ";
+            std::cout << "Enter room ID" << idRange(lightSnapshot) << ": ";
             std::cin >> roomId;
             
             std::cout << "Set light state (0=Off, 1=On): ";
             std::cin >> state;
             std::cin.ignore();
             
-            if (lightTask->setLight(roomId, state != 0))
-            {
-                std::cout << "Room " << roomId << " light updated.\n";
-            }
-            else
-            {
-                std::cout << "Failed to update light. Check room ID or current state.\n";
-            }
+            runCommand(TraceCommand::SET_LIGHT, roomId, state != 0 ? 1 : 0);
         }
         else if (choice == 2)
         {
             int roomId;
             int brightness;
             
-            std::cout << "Enter room ID (1-4): ";
+            std::cout << "Enter room ID" << idRange(lightSnapshot) << ": ";
             std::cin >> roomId;
             
             std::cout << "Set brightness (0=Off, 25=Low, 50=Medium, 75=High, 100=Full): ";
@@ -236,29 +344,126 @@ public:
                     level = LightBrightness::MEDIUM;
             }
             
-            if (lightTask->setBrightness(roomId, level))
-            {
-                std::cout << "Room " << roomId << " brightness updated.\n";
-            }
-            else
-            {
-                std::cout << "Failed to update brightness. Check room ID.\n";
-            }
+            runCommand(TraceCommand::SET_BRIGHTNESS, roomId, static_cast<int>(level));
         }
         else if (choice == 3)
         {
-            LightController::turnOnAllLights();
-            std::cout << "Command sent to turn on all lights.\n";
+            runCommand(TraceCommand::ALL_LIGHTS_ON, 0, 0);
         }
         else if (choice == 4)
         {
-            LightController::turnOffAllLights();
-            std::cout << "Command sent to turn off all lights.\n";
+            runCommand(TraceCommand::ALL_LIGHTS_OFF, 0, 0);
         }
         
         std::cout << "=====================\n";
     }
 
+    void showHistory()
+    {
+        auto now = SimulationClock::getInstance() -> now();
+        auto since = now - std::chrono::hours(24);
+
+        std::cout << "\n=== Sensor History ===\n";
+        for (const auto& series : TimeSeriesStore::getInstance() -> getStatistics())
+        {
+            std::cout << "Series: " << series.name << ", Samples: " << series.samples
+                      << ", Blocks: " << series.blocks << ", Memory: " << series.bytes << " bytes ("
+                      << series.bytesPerSample << " bytes/sample)\n";
+        }
+
+        std::cout << "\nTemperature, hourly (min/avg/max C):\n";
+        auto hourly = TimeSeriesStore::getInstance() -> getSeries("temperature").downsample(since, now,
+                                                                                           std::chrono::hours(1));
+        for (const auto& bucket : hourly)
+        {
+            auto hoursAgo = std::chrono::duration_cast<std::chrono::hours>(now - bucket.start).count();
+            std::cout << "  -" << hoursAgo << " h: " << bucket.min << " / " << bucket.avg << " / " << bucket.max
+                      << " (" << bucket.count << " samples)\n";
+        }
+        std::cout << "======================\n";
+    }
+
+    void showRuleOptions()
+    {
+        auto stats = RuleEngine::getInstance() -> getStatistics();
+
+        std::cout << "\n=== Automation Rules ===\n";
+        std::cout << "Source: " << (stats.source.empty() ? "(none)" : stats.source) << "\n";
+        for (const auto& rule : stats.rules)
+        {
+            std::cout << "Rule: " << rule.name << ", Evaluations: " << rule.evaluations
+                      << ", Fired: " << rule.firings << "\n";
+        }
+
+        std::cout << "\nOptions:\n";
+        std::cout << "1. Reload rules from file\n";
+        std::cout << "0. Return to main menu\n";
+
+        int choice;
+        std::cout << "Enter choice: ";
+        std::cin >> choice;
+        std::cin.ignore();
+
+        if (choice == 1)
+        {
+            runCommand(TraceCommand::RELOAD_RULES, 0, 0);
+        }
+
+        std::cout << "========================\n";
+    }
+
+    void showTimelineOptions()
+    {
+        TimelineStatistics stats = Timeline::getInstance() -> getStatistics();
+
+        std::cout << "\n=== Timeline ===\n";
+        std::cout << "Recording: " << (stats.recording ? "yes" : "no") << ", Events: " << stats.events
+                  << " from " << stats.threads << " threads, Dropped: " << stats.dropped << "\n";
+
+        std::cout << "\nOptions:\n";
+        std::cout << "1. Start recording\n";
+        std::cout << "2. Stop recording and write Chrome trace JSON\n";
+        std::cout << "0. Return to main menu\n";
+
+        int choice;
+        std::cout << "Enter choice: ";
+        std::cin >> choice;
+        std::cin.ignore();
+
+        if (choice == 1)
+        {
+            Timeline::getInstance() -> start();
+            std::cout << "Recording started.\n";
+        }
+        else if (choice == 2)
+        {
+            std::string path;
+            std::cout << "Enter file name (default timeline.json): ";
+            std::getline(std::cin, path);
+            writeTimeline(path.empty() ? "timeline.json" : path);
+        }
+
+        std::cout << "================\n";
+    }
+
+    void writeTimeline(const std::string& path)
+    {
+        Timeline* timeline = Timeline::getInstance();
+        timeline -> stop();
+
+        std::string error;
+        if (timeline -> exportJson(path, error))
+        {
+            TimelineStatistics stats = timeline -> getStatistics();
+            std::cout << "Wrote " << stats.events << " timeline events to " << path << " (" << stats.dropped
+                      << " dropped); open it in ui.perfetto.dev\n";
+        }
+        else
+        {
+            std::cout << "Timeline not written: " << error << "\n";
+        }
+    }
+
     void showSystemStatus()
     {
         std::cout << "\n=== Smart Home System Status ===\n";
@@ -272,23 +477,97 @@ public:
         
         // Lights status
         std::cout << "\nLights Status:\n";
-        auto lightStatus = lightTask->getStatusReport();
-        for (const auto& [id, statusMsg] : lightStatus)
-        {
-            std::cout << "  " << statusMsg << "\n";
-        }
+        lightTask -> getStatusSnapshot(lightSnapshot);
+        printSnapshot(lightSnapshot, LightControlTask::formatStatus, "  ");
         
         // Blinds status
         std::cout << "\nWindow Blinds Status:\n";
-        auto blindsStatus = blindsTask->getStatusReport();
-        for (const auto& [id, statusMsg] : blindsStatus)
-        {
-            std::cout << "  " << statusMsg << "\n";
-        }
+        blindsTask -> getStatusSnapshot(blindsSnapshot);
+        printSnapshot(blindsSnapshot, WindowBlindTask::formatStatus, "  ");
         
         std::cout << "=============================\n";
     }
 
+    // Every operator command that changes devices or rules goes through
+    // here, so that a trace records it and a replay takes the same path
+    void runCommand(TraceCommand command, int target, int value)
+    {
+        TraceStep traceStep(command, target, value);
+
+        switch (command)
+        {
+            case TraceCommand::SET_LIGHT:
+                if (lightTask -> setLight(target, value != 0))
+                {
+                    std::cout << "Room " << target << " light updated.\n";
+                }
+                else
+                {
+                    std::cout << "Failed to update light. Check room ID or current state.\n";
+                }
+                break;
+            case TraceCommand::SET_BRIGHTNESS:
+                if (lightTask -> setBrightness(target, static_cast<LightBrightness>(value)))
+                {
+                    std::cout << "Room " << target << " brightness updated.\n";
+                }
+                else
+                {
+                    std::cout << "Failed to update brightness. Check room ID.\n";
+                }
+                break;
+            case TraceCommand::SET_BLINDS:
+                if (blindsTask -> setBlindsPosition(target, static_cast<BlindsPosition>(value)))
+                {
+                    std::cout << "Window " << target << " blinds position updated.\n";
+                }
+                else
+                {
+                    std::cout << "Failed to update position. Check window ID or wait for cooldown.\n";
+                }
+                break;
+            case TraceCommand::ALL_LIGHTS_ON:
+                printGroupResult(LightController::turnOnAllLights(), "lights turned on");
+                break;
+            case TraceCommand::ALL_LIGHTS_OFF:
+                printGroupResult(LightController::turnOffAllLights(), "lights turned off");
+                break;
+            case TraceCommand::OPEN_ALL_BLINDS:
+                printGroupResult(WindowBlindController::openAllBlinds(), "blinds opened");
+                break;
+            case TraceCommand::CLOSE_ALL_BLINDS:
+                printGroupResult(WindowBlindController::closeAllBlinds(), "blinds closed");
+                break;
+            case TraceCommand::RELOAD_RULES:
+            {
+                std::string error;
+                if (RuleEngine::getInstance() -> reload(error))
+                {
+                    std::cout << "Loaded " << RuleEngine::getInstance() -> getRuleCount() << " rules.\n";
+                }
+                else
+                {
+                    std::cout << "Reload failed, previous rules kept: " << error << "\n";
+                }
+                break;
+            }
+        }
+    }
+
+    void printGroupResult(const GroupResult& result, const char* action)
+    {
+        std::cout << result.changed.size() << " " << action;
+        if (!result.heldByCooldown.empty())
+        {
+            std::cout << ", held by cooldown:";
+            for (int deviceId : result.heldByCooldown)
+            {
+                std::cout << " " << deviceId;
+            }
+        }
+        std::cout << " (" << result.unchanged << " already in that state).\n";
+    }
+
     int getUpTime()
     {
         auto currentTime = std::chrono::steady_clock::now();
@@ -308,6 +587,7 @@ public:
             if (commands.find(input) != commands.end()) 
             {
                 commands[input]();
+                taskManager -> wakeScheduler();
             } 
             else 
             {
@@ -323,13 +603,244 @@ public:
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    size_t workerCount = 0;
+    SchedulingPolicy policy = SchedulingPolicy::FIXED_PRIORITY;
+    double simulateHours = 0.0;
+    bool asyncLog = false;
+    bool binaryLog = false;
+    size_t logSegmentMiB = 0;
+    bool seedGiven = false;
+    uint64_t seed = 0;
+    std::vector<std::string> logLevels;
+    std::string rulesPath = SMART_HOME_RULES_FILE;
+    std::string homePath = SMART_HOME_TOPOLOGY_FILE;
+    int retentionDays = 30;
+    std::string recordPath;
+    std::string replayPath;
+    std::string statePath;
+    std::string timelinePath;
+    long metricsPort = -1;
+    long snapshotSeconds = StateStore::DEFAULT_SNAPSHOT_INTERVAL.count();
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--workers" && i + 1 < argc)
+        {
+            workerCount = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--async-log")
+        {
+            asyncLog = true;
+        }
+        else if (arg == "--binary-log")
+        {
+            binaryLog = true;
+        }
+        else if (arg == "--log-segments" && i + 1 < argc)
+        {
+            logSegmentMiB = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+            seedGiven = true;
+        }
+        else if (arg == "--log-level" && i + 1 < argc)
+        {
+            logLevels.push_back(argv[++i]);
+        }
+        else if (arg == "--retention-days" && i + 1 < argc)
+        {
+            retentionDays = std::atoi(argv[++i]);
+        }
+        else if (arg == "--rules" && i + 1 < argc)
+        {
+            rulesPath = argv[++i];
+        }
+        else if (arg == "--home" && i + 1 < argc)
+        {
+            homePath = argv[++i];
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--state" && i + 1 < argc)
+        {
+            statePath = argv[++i];
+        }
+        else if (arg == "--timeline" && i + 1 < argc)
+        {
+            timelinePath = argv[++i];
+        }
+        else if (arg == "--metrics-port" && i + 1 < argc)
+        {
+            metricsPort = std::strtol(argv[++i], nullptr, 10);
+            if (metricsPort < 0 || metricsPort > 65535)
+            {
+                std::cerr << "Metrics port must be from 0 to 65535\n";
+                return 1;
+            }
+        }
+        else if (arg == "--snapshot-interval" && i + 1 < argc)
+        {
+            snapshotSeconds = std::strtol(argv[++i], nullptr, 10);
+            if (snapshotSeconds <= 0)
+            {
+                std::cerr << "Snapshot interval must be a positive number of seconds\n";
+                return 1;
+            }
+        }
+        else if (arg == "--simulate-hours" && i + 1 < argc)
+        {
+            simulateHours = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--policy" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+
+            if (name == "fp")
+            {
+                policy = SchedulingPolicy::FIXED_PRIORITY;
+            }
+            else if (name == "rm")
+            {
+                policy = SchedulingPolicy::RATE_MONOTONIC;
+            }
+            else if (name == "edf")
+            {
+                policy = SchedulingPolicy::EARLIEST_DEADLINE_FIRST;
+            }
+            else
+            {
+                std::cerr << "Unknown scheduling policy: " << name << "\n";
+                return 1;
+            }
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--workers N] [--policy fp|rm|edf] [--simulate-hours H] [--async-log] [--binary-log] [--log-segments MiB] [--log-level [category=]level] [--seed N] [--home FILE] [--rules FILE] [--retention-days N] [--record FILE | --replay FILE] [--state FILE] [--snapshot-interval S] [--timeline FILE] [--metrics-port N]\n";
+            return 1;
+        }
+    }
+
+    if (!replayPath.empty() && (!recordPath.empty() || simulateHours > 0.0))
+    {
+        std::cerr << "--replay runs on its own trace clock and cannot be combined with --record or --simulate-hours\n";
+        return 1;
+    }
+
+    if (!statePath.empty() && (!recordPath.empty() || !replayPath.empty()))
+    {
+        std::cerr << "--state starts from a previous run, which a trace cannot reproduce; it cannot be combined with --record or --replay\n";
+        return 1;
+    }
+
+    if (simulateHours > 0.0)
+    {
+        // Simulated runs start at local midnight so that a whole day of
+        // time-based rules is covered.
+        std::time_t today = std::time(nullptr);
+        std::tm midnight{};
+#ifdef _WIN32
+        localtime_s(&midnight, &today);
+#else
+        localtime_r(&today, &midnight);
+#endif
+        midnight.tm_hour = 0;
+        midnight.tm_min = 0;
+        midnight.tm_sec = 0;
+        SimulationClock::getInstance() -> enableVirtualTime(std::chrono::system_clock::from_time_t(std::mktime(&midnight)));
+    }
+
+    for (const auto& setting : logLevels)
+    {
+        // "--log-level debug" sets every category, "--log-level lights=trace" just one
+        size_t separator = setting.find('=');
+        LogLevel level;
+        LogCategory category;
+
+        if (!Logger::parseLevel(setting.substr(separator == std::string::npos ? 0 : separator + 1), level) ||
+            (separator != std::string::npos && !Logger::parseCategory(setting.substr(0, separator), category)))
+        {
+            std::cerr << "Invalid log level: " << setting << "\n";
+            return 1;
+        }
+
+        if (separator == std::string::npos)
+        {
+            Logger::setLevel(level);
+        }
+        else
+        {
+            Logger::setLevel(category, level);
+        }
+    }
+
     auto logger = Logger::getInstance();
 
     logger -> setConsoleOutput(false);
-    logger -> log("Application started", true);
+    if (logSegmentMiB > 0)
+    {
+        SegmentOptions segmentOptions;
+        segmentOptions.segmentSize = logSegmentMiB << 20;
+        logger -> enableSegmentedOutput(segmentOptions);
+    }
+    if (binaryLog)
+    {
+        logger -> enableBinaryOutput("system.log.bin");
+    }
+    if (asyncLog)
+    {
+        logger -> enableAsync(1 << 16, OverflowPolicy::COUNT_DROPS);
+    }
+    // Without --seed a random master seed is drawn; it is logged so that the
+    // run can be reproduced
+    if (seedGiven)
+    {
+        RandomService::getInstance() -> setMasterSeed(seed);
+    }
+    LOG_INFO(SYSTEM, "Application started with seed %u", RandomService::getInstance() -> getMasterSeed());
+
+    Timeline::getInstance() -> nameThread("main");
+    if (!timelinePath.empty())
+    {
+        Timeline::getInstance() -> start();
+    }
+
+    TimeSeriesStore::getInstance() -> setRetention(std::chrono::hours(24) * retentionDays);
+
+    // Before anything touches the registry, so that its tables are sized
+    // to the home
+    std::string homeError;
+    HomeTopology* home = HomeTopology::getInstance();
+    if (!home -> loadFile(homePath, homeError))
+    {
+        std::cerr << "Invalid home topology: " << homeError << "\n";
+        logger -> shutdown();
+        return 1;
+    }
+    DeviceRegistry::configure(std::max(home -> getLightCount(), DeviceRegistry::DEFAULT_CAPACITY),
+                              std::max(home -> getBlindCount(), DeviceRegistry::DEFAULT_CAPACITY));
+
+    std::string rulesError;
+    if (!RuleEngine::getInstance() -> loadFile(rulesPath, rulesError))
+    {
+        std::cerr << "Invalid rules: " << rulesError << "\n";
+        logger -> shutdown();
+        return 1;
+    }
 
     auto taskManager = TaskManager::getInstance();
+    taskManager -> setWorkerCount(workerCount);
+    taskManager -> setSchedulingPolicy(policy);
 
     auto temperatureSensorTask = std::make_unique<TemperatureSensorTask>("Temperature Sensor Task", 1);
     
@@ -338,17 +849,126 @@ int main() {
     
     auto lightControlTaskPtr = std::make_unique<LightControlTask>("Light Control Task", 3);
     LightControlTask* lightControlTaskRawPtr = lightControlTaskPtr.get();
+    auto climateBlindTask = std::make_unique<ClimateBlindTask>("Climate Blind Task", 2);
+
+    // Replay runs the tasks itself, matched to the trace by name
+    std::vector<Task*> traceTasks{temperatureSensorTask.get(), windowBlindTaskRawPtr, lightControlTaskRawPtr,
+                                  climateBlindTask.get()};
 
     taskManager -> addTask(std::move(temperatureSensorTask));
     taskManager -> addTask(std::move(windowBlindTaskPtr));
     taskManager -> addTask(std::move(lightControlTaskPtr));
-
-    taskManager -> startScheduler();
+    taskManager -> addTask(std::move(climateBlindTask));
 
     ControlPanel controlPanel(taskManager, windowBlindTaskRawPtr, lightControlTaskRawPtr);
-    controlPanel.run();
 
-    logger -> log("Application stopped", true);
+    if (metricsPort >= 0)
+    {
+        std::string metricsError;
+        if (!MetricsServer::getInstance() -> start(static_cast<uint16_t>(metricsPort), metricsError))
+        {
+            std::cerr << "Cannot serve metrics: " << metricsError << "\n";
+            logger -> shutdown();
+            return 1;
+        }
+    }
+
+    SimulationTrace* trace = SimulationTrace::getInstance();
+    std::string traceError;
+    if (!recordPath.empty() && !trace -> startRecording(recordPath, traceError))
+    {
+        std::cerr << "Cannot record trace: " << traceError << "\n";
+        logger -> shutdown();
+        return 1;
+    }
+
+    if (!replayPath.empty())
+    {
+        ReplayResult result;
+        bool replayed = trace -> replay(replayPath, traceTasks, [&controlPanel](TraceCommand command, int target, int value)
+        {
+            controlPanel.runCommand(command, target, value);
+        }, result, traceError);
+
+        if (!replayed)
+        {
+            std::cerr << "Replay stopped: " << traceError << "\n";
+        }
+        std::cout << "Replayed " << std::chrono::duration<double, std::ratio<3600>>(result.traceDuration).count()
+                  << " h of trace in " << result.seconds << " s: " << result.steps << " steps ("
+                  << result.commands << " commands), " << result.inputs << " input samples, "
+                  << static_cast<uint64_t>(result.events / std::max(result.seconds, 1e-9)) << " events/s\n";
+        if (result.mismatches == 0)
+        {
+            std::cout << "Device states matched the recording at all " << result.stateChecks << " changes\n";
+        }
+        else
+        {
+            std::cout << result.mismatches << " mismatches; first at step " << result.firstMismatchStep << ", "
+                      << std::chrono::duration<double>(result.firstMismatchOffset).count() << " s into the trace\n";
+        }
+        controlPanel.showSystemStatus();
+        if (!timelinePath.empty())
+        {
+            controlPanel.writeTimeline(timelinePath);
+        }
+        MetricsServer::getInstance() -> stop();
+
+        LOG_INFO(SYSTEM, "Application stopped");
+        logger -> shutdown();
+        return replayed && result.mismatches == 0 ? 0 : 1;
+    }
+
+    StateStore* stateStore = StateStore::getInstance();
+    if (!statePath.empty())
+    {
+        RestoreResult restored;
+        std::string stateError;
+        if (!stateStore -> open(statePath, restored, stateError))
+        {
+            std::cerr << "Cannot restore state: " << stateError << "\n";
+            logger -> shutdown();
+            return 1;
+        }
+        if (restored.restored)
+        {
+            std::cout << "Restored " << restored.devices << " devices and " << restored.sensors
+                      << " sensors from snapshot " << restored.sequence << " and " << restored.journalRecords
+                      << " journaled changes in " << restored.seconds * 1000.0 << " ms\n";
+        }
+        stateStore -> start(std::chrono::seconds(snapshotSeconds));
+    }
+
+    if (simulateHours > 0.0)
+    {
+        auto simulated = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::ratio<3600>>(simulateHours));
+        auto wallStart = std::chrono::steady_clock::now();
+
+        taskManager -> runFor(simulated);
+
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        std::cout << "Simulated " << simulateHours << " h in " << wallSeconds << " s\n";
+        controlPanel.showStats();
+        controlPanel.showSystemStatus();
+        controlPanel.showTemperature();
+        controlPanel.showHistory();
+    }
+    else
+    {
+        taskManager -> startScheduler();
+        controlPanel.run();
+    }
+    stateStore -> stop();
+    trace -> stopRecording();
+    if (!timelinePath.empty())
+    {
+        controlPanel.writeTimeline(timelinePath);
+    }
+    MetricsServer::getInstance() -> stop();
+
+    LOG_INFO(SYSTEM, "Application stopped");
+    logger -> shutdown();
 
     return 0;
 }
\ No newline at end of file
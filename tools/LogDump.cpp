@@ -0,0 +1,222 @@
+#include "BinaryLog.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Decodes a binary structured log (system.log.bin) back into the text lines
+// the synchronous logger would have written.
+
+namespace
+{
+
+class Reader
+{
+private:
+    const std::vector<uint8_t>& data;
+    size_t position{0};
+
+public:
+    explicit Reader(const std::vector<uint8_t>& bytes) : data(bytes) {}
+
+    bool atEnd() const { return position >= data.size(); }
+
+    bool readBytes(void* out, size_t length)
+    {
+        if (position + length > data.size())
+        {
+            return false;
+        }
+        std::memcpy(out, data.data() + position, length);
+        position += length;
+        return true;
+    }
+
+    bool readByte(uint8_t& out)
+    {
+        return readBytes(&out, 1);
+    }
+
+    bool readVarint(uint64_t& out)
+    {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t byte;
+            if (!readByte(byte))
+            {
+                return false;
+            }
+            out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+std::string formatWallTime(int64_t wallNanos)
+{
+    std::time_t seconds = static_cast<std::time_t>(wallNanos / 1'000'000'000);
+    int millis = static_cast<int>((wallNanos / 1'000'000) % 1000);
+    struct tm timeInfo;
+
+#ifdef _WIN32
+    localtime_s(&timeInfo, &seconds);
+#else
+    localtime_r(&seconds, &timeInfo);
+#endif
+
+    char buffer[40];
+    size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeInfo);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%03d", millis);
+    return buffer;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const char* path = argc > 1 ? argv[1] : "system.log.bin";
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return 1;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    Reader reader(data);
+
+    char magic[4];
+    uint16_t version = 0;
+    if (!reader.readBytes(magic, 4) || std::memcmp(magic, "SHLB", 4) != 0 ||
+        !reader.readBytes(&version, sizeof(version)) || version != BinaryLog::FORMAT_VERSION)
+    {
+        std::cerr << path << " is not a binary log (or has an unsupported version)\n";
+        return 1;
+    }
+
+    std::vector<std::string> formats;
+    int64_t anchorSteady = 0;
+    int64_t anchorWall = 0;
+    int64_t timestamp = 0;
+    std::vector<LogArg> args;
+    std::vector<std::string> strings;
+
+    while (!reader.atEnd())
+    {
+        uint8_t recordType;
+        reader.readByte(recordType);
+
+        if (recordType == BinaryLog::RECORD_FORMAT)
+        {
+            uint64_t id;
+            uint64_t length;
+            if (!reader.readVarint(id) || !reader.readVarint(length))
+            {
+                break;
+            }
+
+            std::string format(length, '\0');
+            if (!reader.readBytes(&format[0], length))
+            {
+                break;
+            }
+
+            if (formats.size() <= id)
+            {
+                formats.resize(id + 1);
+            }
+            formats[id] = format;
+        }
+        else if (recordType == BinaryLog::RECORD_ANCHOR)
+        {
+            if (!reader.readBytes(&anchorSteady, sizeof(anchorSteady)) ||
+                !reader.readBytes(&anchorWall, sizeof(anchorWall)))
+            {
+                break;
+            }
+            timestamp = anchorSteady;
+        }
+        else if (recordType == BinaryLog::RECORD_EVENT)
+        {
+            uint64_t id;
+            uint64_t delta;
+            uint8_t argCount;
+            if (!reader.readVarint(id) || !reader.readVarint(delta) || !reader.readByte(argCount))
+            {
+                break;
+            }
+            timestamp += BinaryLog::zigzagDecode(delta);
+
+            args.assign(argCount, LogArg());
+            strings.assign(argCount, std::string());
+            bool complete = true;
+
+            for (uint8_t i = 0; i < argCount && complete; i++)
+            {
+                uint8_t type;
+                complete = reader.readByte(type);
+                args[i].type = static_cast<LogArg::Type>(type);
+
+                switch (args[i].type)
+                {
+                    case LogArg::Type::INT:
+                    {
+                        uint64_t raw;
+                        complete = complete && reader.readVarint(raw);
+                        args[i].intValue = BinaryLog::zigzagDecode(raw);
+                        break;
+                    }
+                    case LogArg::Type::FLOAT:
+                    {
+                        float value = 0.0f;
+                        complete = complete && reader.readBytes(&value, sizeof(value));
+                        args[i].floatValue = value;
+                        break;
+                    }
+                    case LogArg::Type::DOUBLE:
+                        complete = complete && reader.readBytes(&args[i].floatValue, sizeof(double));
+                        break;
+                    case LogArg::Type::STRING:
+                    {
+                        uint64_t length = 0;
+                        complete = complete && reader.readVarint(length);
+                        strings[i].resize(length);
+                        complete = complete && (length == 0 || reader.readBytes(&strings[i][0], length));
+                        args[i].stringValue = strings[i].data();
+                        args[i].stringLength = strings[i].size();
+                        break;
+                    }
+                    default:
+                        complete = false;
+                }
+            }
+
+            if (!complete)
+            {
+                std::cerr << "Truncated event record\n";
+                break;
+            }
+
+            const std::string& format = id < formats.size() ? formats[id] : std::string("<unknown format %d>");
+            std::cout << "[" << formatWallTime(anchorWall + (timestamp - anchorSteady)) << "] "
+                      << formatLogMessage(format.c_str(), args.data(), args.size()) << "\n";
+        }
+        else
+        {
+            std::cerr << "Unknown record type " << static_cast<int>(recordType) << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}